@@ -0,0 +1,117 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#pragma once
+
+#include "block_store.h"
+#include "options.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+inline constexpr std::size_t DEFAULT_AGGREGATE_SHARDS = 64;
+
+// Unique blocks of many runs, deduped by fingerprint. Records are spread over
+// shards by fingerprint, each with its own lock, so runs that end at the same
+// time rarely wait on each other.
+class BlockAggregate {
+public:
+    explicit BlockAggregate(std::size_t shards = DEFAULT_AGGREGATE_SHARDS);
+
+    // Record `i` of a finished run's `store`, whose counts are final; `text`
+    // is the block as text output shows it. Thread-safe.
+    void merge(const BlockStore& store, std::size_t i, std::string_view text);
+
+    [[nodiscard]] std::size_t size() const;
+
+    // Every block in the order it was first merged, as `format` output.
+    void write_report(std::ostream& os, OutputFormat format) const;
+
+private:
+    struct Shard {
+        mutable std::mutex                          mutex;
+        BlockStore                                  store;
+        std::unordered_map<std::uint64_t, std::uint32_t> index; // fingerprint → record in `store`
+        std::vector<std::string>                    texts;
+        std::vector<std::uint64_t>                  order;     // first-merge sequence number
+    };
+    [[nodiscard]] Shard& shard(std::uint64_t fingerprint) const noexcept {
+        return shards_[fingerprint & (shard_count_ - 1)];
+    }
+
+    std::unique_ptr<Shard[]>   shards_;
+    std::size_t                shard_count_;    // a power of two
+    std::atomic<std::uint64_t> next_order_{0};
+};
+
+// `--serve SOCKET`: accepts Valgrind logs over a Unix stream socket and
+// dedupes all of them into one BlockAggregate. Each connection is one run with
+// its own LogProcessor; its blocks are merged when the client closes its end.
+// A connection whose first line is `REPORT [text|ndjson|json|sarif]` gets the
+// aggregate back instead.
+//
+// run() is a poll reactor: it reads every socket without blocking and queues
+// the connection for the worker pool whenever it has unprocessed bytes. A
+// worker processes one chunk and moves on, so any number of clients share the
+// workers and a slow one holds none of them. XML runs are parsed once
+// complete.
+class AggregationServer {
+public:
+    // Binds and listens on `socket_path`; a stale socket left by a previous
+    // server is replaced. `workers` = 0 uses one per hardware thread.
+    AggregationServer(std::string socket_path, const Options& options, std::size_t workers = 0);
+    ~AggregationServer();
+
+    AggregationServer(const AggregationServer&)            = delete;
+    AggregationServer& operator=(const AggregationServer&) = delete;
+
+    // Serves until SIGINT or SIGTERM (or stop()). Connections still open
+    // then end where they are, and what they sent so far is merged.
+    void run();
+    // Makes run() return; callable from any thread.
+    void stop() noexcept;
+
+    [[nodiscard]] const BlockAggregate& aggregate() const noexcept { return aggregate_; }
+
+private:
+    struct Connection;
+
+    void work();
+    void schedule(Connection& c);
+    [[nodiscard]] bool read_from(Connection& c, std::string& buffer);
+    void process(Connection& c, std::string& chunk, bool at_end);
+    void send_report(int fd, std::string_view request) const;
+
+    std::string             path_;
+    Options                 options_;   // per-connection runs: streamed, no side outputs
+    std::size_t             workers_;
+    BlockAggregate          aggregate_;
+    int                     listen_fd_{-1};
+    int                     wake_fd_{-1};   // eventfd written by stop()
+    int                     notify_fd_{-1}; // eventfd: a worker drained or finished a connection
+    std::unordered_map<int, std::unique_ptr<Connection>> connections_; // by socket; reactor thread only
+    std::mutex              queue_mutex_;
+    std::condition_variable queue_ready_;
+    std::deque<Connection*> queue_;       // connections with bytes to process
+    bool                    closing_{false};
+    std::vector<std::thread> threads_;
+};
+
+// `--query SOCKET`: asks a running server for its aggregate in `format` and
+// copies the reply to `os`.
+void query_server(std::string_view socket_path, OutputFormat format, std::ostream& os);
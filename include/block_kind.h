@@ -0,0 +1,60 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Category of a block, taken from the line that starts it.
+enum class BlockKind : std::uint8_t {
+    Other,
+    InvalidRead,
+    InvalidWrite,
+    SyscallParam,
+    Uninitialised,   // "Use of uninitialised value" / "Conditional jump ... uninitialised"
+    DefinitelyLost,
+    IndirectlyLost,
+    PossiblyLost,
+    StillReachable,
+    Fatal,           // "Process terminating with default action of signal"
+    DataRace,        // Helgrind "Possible data race", DRD "Conflicting load/store"
+    LockOrder,       // Helgrind "lock order ... violated"
+    ThreadApi,       // misuse of pthread locks, condition variables, semaphores, ...
+};
+
+inline constexpr std::size_t BLOCK_KIND_COUNT = static_cast<std::size_t>(BlockKind::ThreadApi) + 1;
+
+using BlockKindMask = std::uint32_t;
+
+[[nodiscard]] constexpr BlockKindMask kind_bit(BlockKind k) noexcept {
+    return BlockKindMask{1} << static_cast<unsigned>(k);
+}
+
+// Reports of Helgrind and DRD (and their XML kinds).
+[[nodiscard]] constexpr bool is_thread_kind(BlockKind k) noexcept {
+    return k == BlockKind::DataRace || k == BlockKind::LockOrder || k == BlockKind::ThreadApi;
+}
+
+// Leak records ("N bytes in M blocks are ... lost"), the blocks with bytes lost.
+[[nodiscard]] constexpr bool is_leak_kind(BlockKind k) noexcept {
+    return k == BlockKind::DefinitelyLost || k == BlockKind::IndirectlyLost ||
+           k == BlockKind::PossiblyLost || k == BlockKind::StillReachable;
+}
+
+// `start_line` is a start-pattern line with the ==PID== prefix removed.
+[[nodiscard]] BlockKind classify_block(std::string_view start_line) noexcept;
+
+// `kind` is the <kind> of a Valgrind XML error ("InvalidRead", "Leak_PossiblyLost", ...).
+[[nodiscard]] BlockKind classify_xml_kind(std::string_view kind) noexcept;
+
+[[nodiscard]] std::string_view block_kind_name(BlockKind k) noexcept;
+
+// Parses a comma-separated list of kind names ("definitely-lost,invalid-write");
+// "any" selects every kind except `other`. Throws std::runtime_error on unknown names.
+[[nodiscard]] BlockKindMask parse_block_kinds(std::string_view list);
@@ -0,0 +1,132 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#pragma once
+
+#include "block_kind.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Interned strings: each distinct value is stored once and named by a dense
+// 32-bit ID. ID 0 is reserved for "absent" and reads back as "".
+class StringTable {
+public:
+    [[nodiscard]] std::uint32_t intern(std::string_view s);
+    [[nodiscard]] std::string_view operator[](std::uint32_t id) const noexcept {
+        return id == 0 ? std::string_view{} : std::string_view{strings_[id - 1]};
+    }
+    [[nodiscard]] std::size_t size() const noexcept { return strings_.size(); }
+    void clear() noexcept;
+
+private:
+    std::deque<std::string> strings_; // stable addresses for the map keys
+    std::unordered_map<std::string_view, std::uint32_t> ids_;
+};
+
+// One stack frame, fields as StringTable IDs (0 = absent).
+struct Frame {
+    std::uint32_t function{0};
+    std::uint32_t file{0};
+    std::uint32_t line{0};    // source line number, not an ID
+    std::uint32_t object{0};  // "(in /lib/x.so)" when there is no source location
+};
+
+// Fields of an "at 0x…: fn (file:line)" / "by …" line, as views into it.
+struct FrameText {
+    std::string_view function;
+    std::string_view file;
+    std::string_view object;
+    std::uint32_t    line{0};
+};
+[[nodiscard]] std::optional<FrameText> parse_frame(std::string_view line) noexcept;
+
+// Size figures of a block's first line: the access size of "Invalid read of
+// size 4", or bytes and heap blocks of "1,024 (16 direct, 1,008 indirect)
+// bytes in 3 blocks are definitely lost ...". Zero when the line has none.
+struct HeaderCounts {
+    std::uint64_t bytes{0};
+    std::uint64_t heap_blocks{0};
+};
+[[nodiscard]] HeaderCounts parse_header_counts(std::string_view line) noexcept;
+
+// A run of frames after a block's own stack and the line that starts it:
+// "Address 0x… is 0 bytes inside a block of size 4 free'd", "Block was alloc'd
+// at", "This conflicts with a previous write of size 4 by thread #2".
+struct OtherStack {
+    std::uint32_t message;    // string ID of the line
+    std::uint32_t begin;      // frames [begin, end) in BlockStore order
+    std::uint32_t end;
+};
+
+// The unique blocks of a run, in output order, as a structure of arrays: the
+// columns aggregation scans (kind, counts) stay dense, and frames of all
+// blocks share one array. Duplicates only bump their record's counters.
+class BlockStore {
+public:
+    static constexpr std::uint32_t npos = std::numeric_limits<std::uint32_t>::max();
+
+    // Appends a record; the block's lines then go through add_line(), which
+    // keeps the frames and ignores everything else. `fingerprint` is the hash
+    // of the block's signature, the key duplicates are found by.
+    std::uint32_t add(BlockKind kind, std::uint64_t fingerprint, std::string_view header, HeaderCounts counts);
+    void add_line(std::string_view line);
+    void add_occurrence(std::uint32_t index, HeaderCounts counts) noexcept;
+
+    // Records of another store (--serve merges each run's blocks): append()
+    // copies record `i` of `from`, counts and frames included; add_counts()
+    // adds its counters to record `index`, a block with the same fingerprint.
+    std::uint32_t append(const BlockStore& from, std::size_t i);
+    void add_counts(std::uint32_t index, const BlockStore& from, std::size_t i) noexcept;
+
+    [[nodiscard]] std::size_t size() const noexcept { return kinds_.size(); }
+    [[nodiscard]] bool        empty() const noexcept { return kinds_.empty(); }
+
+    [[nodiscard]] BlockKind        kind(std::size_t i) const noexcept { return kinds_[i]; }
+    [[nodiscard]] std::uint64_t    fingerprint(std::size_t i) const noexcept { return fingerprints_[i]; }
+    [[nodiscard]] std::string_view header(std::size_t i) const noexcept { return strings_[headers_[i]]; }
+    [[nodiscard]] std::uint64_t    bytes(std::size_t i) const noexcept { return bytes_[i]; }       // summed over occurrences
+    [[nodiscard]] std::uint64_t    heap_blocks(std::size_t i) const noexcept { return heap_blocks_[i]; }
+    [[nodiscard]] std::uint32_t    occurrences(std::size_t i) const noexcept { return occurrences_[i]; }
+    [[nodiscard]] std::span<const Frame> frames(std::size_t i) const noexcept;
+    // Frames of the block's own stack: the leading run of frames, before the
+    // first other line ("Address 0x… is … alloc'd", "This conflicts with …").
+    [[nodiscard]] std::span<const Frame> stack(std::size_t i) const noexcept;
+    // The stacks after it, in log order; frames(s) are the frames of one.
+    [[nodiscard]] std::span<const OtherStack> other_stacks(std::size_t i) const noexcept;
+    [[nodiscard]] std::span<const Frame>      frames(const OtherStack& s) const noexcept;
+    [[nodiscard]] const StringTable&     strings() const noexcept { return strings_; }
+
+    void clear() noexcept;
+
+private:
+    [[nodiscard]] std::uint32_t frame_begin(std::size_t i) const noexcept { return i == 0 ? 0 : frame_end_[i - 1]; }
+
+    std::vector<BlockKind>     kinds_;
+    std::vector<std::uint64_t> fingerprints_;
+    std::vector<std::uint32_t> headers_;
+    std::vector<std::uint64_t> bytes_;
+    std::vector<std::uint64_t> heap_blocks_;
+    std::vector<std::uint32_t> occurrences_;
+    std::vector<std::uint32_t> frame_end_;  // frames of block i: [frame_end_[i-1], frame_end_[i])
+    std::vector<std::uint32_t> stack_end_;  // end of block i's first stack, <= frame_end_[i]
+    bool                       stack_open_{false}; // last block's first stack may still grow
+    bool                       after_frame_{false}; // last line added was a frame
+    std::vector<std::uint32_t> other_end_;  // other stacks of block i: [other_end_[i-1], other_end_[i])
+    std::vector<OtherStack>    others_;
+    std::string                message_;    // first line after the last block's latest run of frames
+    std::vector<Frame>         frames_;
+    StringTable                strings_;
+};
@@ -0,0 +1,72 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace canonicalization {
+
+// User-defined normalization rules, applied to signature lines before canon().
+//
+// Rule file format: one rule per line, `PATTERN => REPLACEMENT`. Blank lines and
+// lines starting with '#' are ignored. PATTERN is a small regex-like language:
+//   x        literal character (anything not listed below)
+//   .        any character
+//   [a-z_]   character class; [^...] negates it
+//   \d \w \s digit, word character, whitespace
+//   \c       escaped literal (e.g. \. \[ \\)
+//   * + ?    postfix repetition of the preceding atom
+// There is no alternation or grouping, so ( ) { } # are plain literals.
+//
+// All rules are compiled into one DFA. apply() rewrites a line left to right,
+// at each position taking the longest match (earlier rules win ties). A
+// backward pass over a reverse DFA first marks, for every position, the DFA
+// states that can still reach a match, so the forward scan starts only where a
+// match exists and gives up one byte past its end. Each byte costs at most
+// three DFA steps, whatever the patterns and the number of rules.
+class RuleSet {
+public:
+    RuleSet() = default;
+
+    [[nodiscard]] static RuleSet parse(std::string_view text);
+    [[nodiscard]] static RuleSet load(std::string_view filename);
+
+    [[nodiscard]] bool empty() const noexcept { return replacements.empty(); }
+    [[nodiscard]] std::size_t size() const noexcept { return replacements.size(); }
+    [[nodiscard]] std::size_t state_count() const noexcept { return accept.size(); }
+
+    [[nodiscard]] std::string apply(std::string_view line) const;
+    // Writes the rewritten line into `out` (cleared first), reusing its storage.
+    void apply(std::string_view line, std::string& out) const;
+
+    // Forward DFA transitions taken by apply() so far (the backward pass is one
+    // per byte and not counted).
+    [[nodiscard]] std::size_t forward_steps() const noexcept { return forward_steps_; }
+
+private:
+    static constexpr std::int32_t DEAD = -1;
+
+    [[nodiscard]] bool live_at(std::int32_t reverse_state, std::int32_t state) const noexcept;
+
+    std::vector<std::int32_t>  table;        // state * 256 + byte → next state
+    std::vector<std::int32_t>  accept;       // state → rule index, or DEAD
+    std::vector<std::int32_t>  reverse;      // reverse state * 256 + byte → reverse state before it
+    std::vector<std::uint64_t> live;         // reverse state → bitset of forward states that can match
+    std::size_t                live_words{0};
+    std::int32_t               reverse_end{0}; // reverse state at the end of a line
+    std::vector<std::string>   replacements;
+    mutable std::vector<std::int32_t> ends;  // apply() scratch: reverse state before each byte
+    mutable std::size_t        forward_steps_{0};
+};
+
+} // namespace canonicalization
@@ -37,5 +37,7 @@ namespace {
 [[nodiscard]] std::string rtrim(std::string s);
 [[nodiscard]] std::string canon(std::string s);
 [[nodiscard]] std::string canon(std::string_view s);
+// Same transform as canon(), rewriting `s` without temporaries.
+void canon_in_place(std::string& s);
 
 } // namespace canonicalization
@@ -0,0 +1,72 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#pragma once
+
+#include "options.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 64-bit FNV-1a. Stable across runs and builds, so block fingerprints can be
+// saved in a checkpoint and compared by a later process.
+[[nodiscard]] constexpr std::uint64_t fingerprint(std::string_view data,
+                                                  std::uint64_t hash = 0xcbf29ce484222325ull) noexcept {
+    for (const char c : data) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+// Processing state saved by --state at exit and restored by the next run.
+struct Checkpoint {
+    std::uint64_t settings{0};     // checkpoint_settings(): options that shape signatures and epochs
+    std::uint64_t device{0};       // identity of the input file ...
+    std::uint64_t inode{0};
+    std::uint64_t offset{0};       // ... and the bytes of it already processed
+    bool          marker_found{false};
+    std::uint8_t  tool{0};            // ValgrindTool named by the log's banner
+    std::uint32_t tool_probe_left{0}; // lines still searched for the banner
+    std::vector<std::uint64_t> seen; // fingerprints of the current epoch's blocks
+
+    // A block still open at exit (one per PID); the next run continues it.
+    struct OpenBlock {
+        std::uint32_t pid{0};
+        std::uint8_t  kind{0};
+        std::uint64_t begin{0};
+        std::uint64_t end{0};
+        std::uint64_t sig_lines{0};
+        std::string   head;           // leak record header, which is not in `text`
+        std::string   sig;
+        std::string   text;
+        std::vector<std::uint32_t> line_lengths;
+        std::uint64_t started{0};  // ordering only; blocks are saved oldest first
+    };
+    std::vector<OpenBlock> open_blocks;
+};
+
+// What canonical lines depend on: the canonicalization revision and the
+// contents of the --canon-rules file.
+[[nodiscard]] std::uint64_t signature_settings(const Options& opt);
+// signature_settings() plus what decides which blocks a resumed run reports:
+// the marker, trimming, --depth and the contents of the --suppress files.
+[[nodiscard]] std::uint64_t checkpoint_settings(const Options& opt);
+
+// Returns nullopt when the file does not exist; throws if it is unreadable or corrupt.
+[[nodiscard]] std::optional<Checkpoint> load_checkpoint(std::string_view filename);
+
+// Writes to a temporary file next to `filename` and renames it into place.
+void save_checkpoint(std::string_view filename, const Checkpoint& cp);
+
+// Stream-processes `fname`, resuming from opt.state_file when it matches the
+// file (same inode, not shrunk, same options) and saving the new state after.
+// Returns true when a --fail-on kind was found.
+[[nodiscard]] bool process_file_resumable(std::string_view fname, const Options& opt);
@@ -0,0 +1,43 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Itanium C++ ABI demangling for logs written with valgrind --demangle=no, so
+// "_ZNSt6vectorIiSaIiEE9push_backERKi" keys like the demangled frame and its
+// template arguments collapse. Every distinct symbol is demangled once per run;
+// repeats are a hash lookup.
+class DemangleCache {
+public:
+    // Writes `line` into `out` with each mangled symbol ("_Z…" starting a word)
+    // replaced by its demangled form. Returns false, leaving `out` alone, when
+    // the line has no symbol that demangles.
+    bool demangle_line(std::string_view line, std::string& out);
+
+    // The demangled symbol, or `symbol` itself if it is not a valid mangled name.
+    [[nodiscard]] const std::string& demangle(std::string_view symbol);
+
+    [[nodiscard]] std::size_t size() const noexcept { return cache_.size(); }
+    [[nodiscard]] std::size_t hits() const noexcept { return hits_; }
+
+private:
+    struct Hash {
+        using is_transparent = void;
+        [[nodiscard]] std::size_t operator()(std::string_view s) const noexcept {
+            return std::hash<std::string_view>{}(s);
+        }
+    };
+
+    std::unordered_map<std::string, std::string, Hash, std::equal_to<>> cache_;
+    std::size_t hits_{0};
+};
@@ -0,0 +1,64 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#pragma once
+
+#include "options.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <sys/types.h>
+
+class LogProcessor;
+
+// Feeds a growing log file to a LogProcessor. The file and its directory are
+// watched with inotify, so waiting costs nothing; only bytes appended since
+// the last read are consumed. Truncation restarts at offset 0, and rotation
+// (the path renamed away or replaced) drains the old file and then switches
+// to the new one. The processor, and so its dedupe state, lives throughout.
+class FileFollower {
+public:
+    FileFollower(std::filesystem::path path, LogProcessor& processor);
+    ~FileFollower();
+
+    FileFollower(const FileFollower&)            = delete;
+    FileFollower& operator=(const FileFollower&) = delete;
+
+    // Blocks for up to timeout_ms (-1 = no limit) until the file changes and
+    // processes what changed. Returns false when a stop signal was received.
+    bool wait(int timeout_ms);
+
+    // Waits until SIGINT or SIGTERM (or until the processor stops early),
+    // then flushes the open block.
+    void run();
+
+private:
+    void open_file();
+    void close_file() noexcept;
+    void read_new_data();
+    void handle_events();
+    void switch_to_new_file();
+    [[nodiscard]] bool path_is_current_file() const;
+
+    std::filesystem::path path_;
+    std::string           name_;       // file name within the watched directory
+    LogProcessor&         processor_;
+    int                   inotify_fd_{-1};
+    int                   dir_wd_{-1};
+    int                   file_wd_{-1};
+    int                   fd_{-1};
+    int                   signal_fd_{-1};
+    std::uint64_t         offset_{0};
+    dev_t                 dev_{0};
+    ino_t                 ino_{0};
+};
+
+// Follow-mode wrapper: validates `fname` and runs a FileFollower until signalled
+// or until --max-unique/--fail-on stops it. Returns true when a --fail-on kind was found.
+[[nodiscard]] bool follow_file(std::string_view fname, const Options& opt);
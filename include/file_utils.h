@@ -10,7 +10,10 @@
 #include "options.h"
 
 #include <cstddef>
+#include <cstdint>
+#include <filesystem>
 #include <iosfwd>
+#include <optional>
 #include <span>
 #include <string>
 #include <string_view>
@@ -23,12 +26,36 @@
 
 // Progress helpers
 void report_progress(std::size_t bytes_processed, std::size_t total_bytes, std::string_view filename);
-[[nodiscard]] std::size_t get_memory_usage_mb() noexcept;
+[[nodiscard]] std::size_t get_memory_usage_mb() noexcept;      // current resident set
+[[nodiscard]] std::size_t get_peak_memory_usage_mb() noexcept; // high-water mark
 void report_memory_usage(std::string_view operation, std::string_view filename = {});
 
 // File helpers
 [[nodiscard]] std::vector<std::string> read_file_lines(std::string_view fname);
-[[nodiscard]] bool is_large_file(std::string_view fname);
+[[nodiscard]] std::optional<std::uintmax_t> regular_file_size(std::string_view fname); // nullopt if unusable
+[[nodiscard]] bool starts_like_xml(std::istream& in);  // peeks; true when the first non-blank byte is '<'
+[[nodiscard]] bool is_xml_file(std::string_view fname); // false when unreadable
 
-// Stream processing wrapper
-void process_file_stream(std::string_view fname, const Options& opt);
\ No newline at end of file
+// Read-only private mapping of a whole file, unmapped on destruction.
+class MappedFile {
+public:
+    explicit MappedFile(const std::filesystem::path& path);
+    ~MappedFile();
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    [[nodiscard]] std::string_view view() const noexcept {
+        return size_ > 0 ? std::string_view{static_cast<const char*>(data_), size_} : std::string_view{};
+    }
+
+private:
+    [[noreturn]] static void throw_errno(std::string_view operation, std::string_view target);
+
+    void*       data_{nullptr};
+    std::size_t size_{0};
+};
+
+// Processing wrappers; return true when a --fail-on kind was found
+[[nodiscard]] bool process_file_stream(std::string_view fname, const Options& opt);
+[[nodiscard]] bool process_file_mapped(std::string_view fname, const Options& opt);
+[[nodiscard]] bool process_file_xml(std::string_view fname, const Options& opt);
\ No newline at end of file
@@ -0,0 +1,100 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct FrameCacheStats {
+    std::size_t canon_hits{0};
+    std::size_t canon_misses{0};
+    std::size_t scrub_hits{0};
+    std::size_t scrub_misses{0};
+    std::size_t evictions{0};
+    std::size_t entries{0};
+    std::size_t capacity{0};
+    std::size_t bytes{0};   // approximate heap footprint of the cache
+
+    [[nodiscard]] double hit_rate() const noexcept {
+        const auto lookups = canon_hits + canon_misses + scrub_hits + scrub_misses;
+        return lookups == 0 ? 0.0 : static_cast<double>(canon_hits + scrub_hits) / static_cast<double>(lookups);
+    }
+};
+
+void report_frame_cache_stats(std::ostream& os, const FrameCacheStats& stats);
+
+// Bounded memo of per-line transforms keyed by the (prefix-stripped) line text.
+// Frames such as "at 0x4C2AB80: malloc (vg_replace_malloc.c:299)" recur millions
+// of times in large logs; a hit returns the stored canonical/scrubbed form
+// without re-running the transforms. Eviction uses the CLOCK approximation of
+// LRU. `make(line, out)` writes the transform of `line` into `out`, reusing the
+// slot's storage. Returned references stay valid until the next lookup.
+class FrameCache {
+public:
+    explicit FrameCache(std::size_t capacity);
+
+    template <class Make>
+    [[nodiscard]] const std::string& canonical(std::string_view line, Make&& make) {
+        if (slots.empty()) {
+            make(line, scratch);
+            return scratch;
+        }
+        Slot& s = lookup(line);
+        if (s.has_canon) {
+            ++counters.canon_hits;
+        } else {
+            ++counters.canon_misses;
+            make(line, s.canon);
+            s.has_canon = true;
+        }
+        return s.canon;
+    }
+
+    template <class Make>
+    [[nodiscard]] const std::string& scrubbed(std::string_view line, Make&& make) {
+        if (slots.empty()) {
+            make(line, scratch);
+            return scratch;
+        }
+        Slot& s = lookup(line);
+        if (s.has_scrub) {
+            ++counters.scrub_hits;
+        } else {
+            ++counters.scrub_misses;
+            make(line, s.scrub);
+            s.has_scrub = true;
+        }
+        return s.scrub;
+    }
+
+    [[nodiscard]] FrameCacheStats stats() const;
+
+private:
+    struct Slot {
+        std::string key;
+        std::string canon;
+        std::string scrub;
+        bool        has_canon{false};
+        bool        has_scrub{false};
+        bool        referenced{false};
+    };
+
+    Slot& lookup(std::string_view line);
+
+    std::vector<Slot> slots;
+    std::unordered_map<std::string_view, std::uint32_t> index; // views into Slot::key
+    std::size_t       used{0};
+    std::size_t       hand{0};
+    std::string       scratch;  // result storage when the cache is disabled
+    FrameCacheStats   counters;
+};
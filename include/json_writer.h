@@ -0,0 +1,69 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#pragma once
+
+#include "block_store.h"
+#include "options.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+
+// Appends `s` to `out` as the body of a JSON string (no quotes). Bytes that
+// need no escaping are copied in runs; well-formed UTF-8 passes through
+// unchanged and each ill-formed sequence becomes \ufffd (U+FFFD).
+void append_json_string(std::string& out, std::string_view s);
+
+// Writes unique-block records for --format ndjson (one object per line),
+// --format json (one array) or --format sarif (one SARIF 2.1.0 log). Records
+// are built straight into an output buffer that is handed to the stream in
+// large writes; there is no document tree, so a run with 100k results never
+// holds more than one buffer of output.
+//
+//   {"kind":"definitely-lost","fingerprint":"9f2c…","count":2,"bytes":1536,
+//    "blocks":4,"header":"…","frames":[{"fn":"malloc","obj":"…"},
+//    {"fn":"main","file":"a.cpp","line":10}],"text":"…"}
+//
+// A SARIF result has the kind as its rule, the header as its message, the
+// first frame of its own stack with a source location as its location, and
+// the fingerprint under partialFingerprints. Its stacks are the block's own,
+// under the header, then each later one (alloc'd at, freed at, the other
+// thread's access) under the line that introduced it.
+class JsonRecordWriter {
+public:
+    JsonRecordWriter(std::ostream& os, OutputFormat format);
+    ~JsonRecordWriter();
+
+    JsonRecordWriter(const JsonRecordWriter&)            = delete;
+    JsonRecordWriter& operator=(const JsonRecordWriter&) = delete;
+
+    // Record `index` of `store`; `text` is the block as text output shows it.
+    void write(const BlockStore& store, std::size_t index, std::string_view text);
+
+    // Hands everything buffered to the stream and flushes it (--follow).
+    void flush();
+
+    // Closes the document (json, sarif), then flush(). Records written
+    // afterwards start a new document.
+    void finish();
+
+private:
+    void begin_record();
+    void open_document();
+    void write_record(const BlockStore& store, std::size_t index, std::string_view text);
+    void write_sarif_result(const BlockStore& store, std::size_t index);
+    void drain();
+
+    std::ostream& os_;
+    OutputFormat  format_;
+    std::string   buf_;
+    bool          open_{false};   // json/sarif: document opened, not yet closed
+    std::size_t   records_{0};    // written to the open document
+};
@@ -0,0 +1,174 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#pragma once
+
+#include "block_store.h"
+#include "options.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Sidecar index of a Memcheck text log (`vglog-filter index LOG` writes
+// LOG.vgi): every block as an untrimmed run segments it, each accepted line
+// with its canonical form, and the marker positions. A later run over the same
+// log and settings reads the index instead of parsing the text, rebuilds
+// signatures at any --depth from the canonical IDs and only reads the lines of
+// blocks it outputs. Host byte order, like --state and --result-file files;
+// all offsets are from the start of the file and 8-aligned.
+//
+//   IndexHeader
+//   IndexLine[]     accepted lines, grouped by block
+//   IndexBlock[]    in the order the blocks are flushed
+//   u64[]           markers: log offset just after each marker line
+//   IndexString[]   canonical lines; string ID n is entry n - 1, 0 = empty
+//   blob            the marker text, then the canonical lines back to back
+inline constexpr std::string_view INDEX_MAGIC     = "VGLFINDX";
+inline constexpr std::uint32_t    INDEX_VERSION   = 1;
+inline constexpr std::string_view INDEX_EXTENSION = ".vgi";
+
+struct IndexHeader {
+    char          magic[8];
+    std::uint32_t version;
+    std::uint32_t marker_length;  // at the start of the blob
+    std::uint64_t log_size;       // identity of the indexed log ...
+    std::uint64_t log_mtime;      // ... (nanoseconds)
+    std::uint64_t settings;       // signature_settings() it was built with
+    std::uint64_t lines;
+    std::uint64_t lines_offset;
+    std::uint64_t blocks;
+    std::uint64_t blocks_offset;
+    std::uint64_t markers;
+    std::uint64_t markers_offset;
+    std::uint64_t strings;
+    std::uint64_t strings_offset;
+    std::uint64_t blob_offset;
+    std::uint64_t blob_size;
+};
+
+// A line that scrubbing (--scrub-raw) empties; such lines only count when
+// the output is not scrubbed.
+inline constexpr std::uint32_t INDEX_SCRUBS_BLANK = 1u << 31;
+
+struct IndexLine {
+    std::uint64_t offset;         // in the log, ==PID== prefix stripped
+    std::uint32_t length;         // | INDEX_SCRUBS_BLANK
+    std::uint32_t canonical;      // string ID
+};
+
+// The block was still open at the end of the log; such blocks are flushed
+// last, ordered by their first line.
+inline constexpr std::uint8_t INDEX_AT_END = 1;
+
+struct IndexBlock {
+    std::uint64_t start;          // log offset of the line that opened the block
+    std::uint64_t head_offset;    // "N bytes in M blocks" start line, which is not a line of the block
+    std::uint64_t first_line;     // into IndexLine[]
+    std::uint32_t lines;
+    std::uint32_t pid;
+    std::uint32_t head_length;    // 0 = none
+    std::uint8_t  kind;           // BlockKind
+    std::uint8_t  flags;          // INDEX_AT_END
+    std::uint8_t  reserved[2];
+};
+
+struct IndexString {
+    std::uint64_t offset;         // into the blob
+    std::uint32_t length;
+    std::uint32_t reserved;
+};
+
+static_assert(sizeof(IndexHeader) == 120 && sizeof(IndexLine) == 16 && sizeof(IndexBlock) == 40 &&
+              sizeof(IndexString) == 16);
+
+// Streams lines to a temporary file next to `filename` as blocks arrive, then
+// appends the tables and header and renames it into place.
+class LogIndexWriter {
+public:
+    explicit LogIndexWriter(std::filesystem::path path);
+    ~LogIndexWriter();
+
+    LogIndexWriter(const LogIndexWriter&)            = delete;
+    LogIndexWriter& operator=(const LogIndexWriter&) = delete;
+
+    [[nodiscard]] std::uint32_t intern(std::string_view canonical) { return strings_.intern(canonical); }
+    void add_marker(std::uint64_t offset) { markers_.push_back(offset); }
+    // `block.first_line` and `block.lines` are filled in from `lines`.
+    void add_block(IndexBlock block, std::span<const IndexLine> lines);
+    // `header` supplies the log identity, settings and marker length.
+    void finish(const IndexHeader& header, std::string_view marker);
+
+    [[nodiscard]] std::size_t blocks() const noexcept { return blocks_.size(); }
+
+private:
+    std::filesystem::path   path_;
+    std::filesystem::path   tmp_;
+    std::ofstream           out_;
+    std::vector<IndexBlock> blocks_;
+    std::vector<std::uint64_t> markers_;
+    StringTable             strings_;
+    std::uint64_t           lines_{0};
+    bool                    finished_{false};
+};
+
+// Read-only mapping of an index. The constructor validates the header, the
+// tables and every line and block against the log size it names, and throws
+// std::runtime_error if the file is corrupt.
+class LogIndex {
+public:
+    explicit LogIndex(const std::filesystem::path& path);
+    ~LogIndex();
+
+    LogIndex(const LogIndex&)            = delete;
+    LogIndex& operator=(const LogIndex&) = delete;
+
+    [[nodiscard]] const IndexHeader& header() const noexcept { return header_; }
+    [[nodiscard]] std::string_view marker() const noexcept {
+        return {data_ + header_.blob_offset, header_.marker_length};
+    }
+    [[nodiscard]] std::size_t blocks() const noexcept { return static_cast<std::size_t>(header_.blocks); }
+    [[nodiscard]] IndexBlock  block(std::size_t i) const noexcept { return get<IndexBlock>(header_.blocks_offset, i); }
+    [[nodiscard]] IndexLine   line(std::uint64_t i) const noexcept { return get<IndexLine>(header_.lines_offset, i); }
+    [[nodiscard]] std::size_t markers() const noexcept { return static_cast<std::size_t>(header_.markers); }
+    [[nodiscard]] std::uint64_t marker_offset(std::size_t i) const noexcept {
+        return get<std::uint64_t>(header_.markers_offset, i);
+    }
+    [[nodiscard]] std::string_view string(std::uint32_t id) const noexcept;
+
+private:
+    template <class T>
+    [[nodiscard]] T get(std::uint64_t table, std::uint64_t i) const noexcept {
+        T v{};
+        std::memcpy(&v, data_ + table + i * sizeof(T), sizeof(T));
+        return v;
+    }
+
+    const char*  data_{nullptr};
+    std::size_t  size_{0};
+    IndexHeader  header_{};
+};
+
+[[nodiscard]] std::filesystem::path index_path(std::string_view log_file);
+
+// `vglog-filter index LOG`: writes LOG.vgi with the canonicalization and
+// marker of `opt`. Returns the number of blocks indexed.
+std::size_t build_log_index(std::string_view log_file, const Options& opt);
+
+// Runs `opt` over `log_file` from its index when LOG.vgi exists and still
+// matches the log and the settings; nullopt means the caller has to parse the
+// log (a stale index is reported on stderr). Otherwise returns true when a
+// --fail-on kind was found.
+[[nodiscard]] std::optional<bool> process_file_indexed(std::string_view log_file, const Options& opt);
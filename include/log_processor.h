@@ -7,44 +7,180 @@
 
 #pragma once
 
+#include "block_kind.h"
+#include "block_store.h"
+#include "canon_rules.h"
+#include "checkpoint.h"
+#include "demangle.h"
+#include "frame_cache.h"
+#include "json_writer.h"
 #include "options.h"
+#include "resource_governor.h"
+#include "result_file.h"
+#include "spill_file.h"
+#include "suppressions.h"
+#include "thread_report.h"
 
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <iosfwd>
 #include <memory>
+#include <memory_resource>
+#include <optional>
 #include <span>
 #include <string>
 #include <string_view>
-#include <unordered_set>
+#include <unordered_map>
 #include <vector>
 
+class LogIndex;
+class LogIndexWriter;
+
+// How lines are cut into blocks. Until the banner names the tool (or the
+// probe gives up) this is decided per line; after that it is fixed.
+enum class Segmentation : std::uint8_t {
+    Probing,    // tool not known yet: checked at run time
+    Memcheck,   // start lines open blocks
+    ThreadTool, // Helgrind/DRD line roles (classify_thread_line)
+};
+
+// Compile-time snapshot of the options the per-line path branches on.
+// LogProcessor picks one instantiation from Options before the input loop,
+// and again once the tool probe has settled the segmentation.
+template <bool Trim, bool Stream, bool Scrub, bool UnlimitedDepth, Segmentation Seg>
+struct ProcessingPolicy {
+    static constexpr bool watch_marker    = Trim && Stream; // marker resets the epoch
+    static constexpr bool stream          = Stream;         // buffer blocks until EOF
+    static constexpr bool scrub           = Scrub;          // scrub raw output text
+    static constexpr bool unlimited_depth = UnlimitedDepth; // every line joins the key
+    static constexpr bool probing         = Seg == Segmentation::Probing;
+    static constexpr bool memcheck        = Seg == Segmentation::Memcheck;
+};
+
 class LogProcessor {
 public:
     using Str     = std::string;
     using VecS    = std::vector<Str>;
     using StrSpan = std::span<const Str>;
 
-    explicit LogProcessor(const Options& options);
+    // Receives each unique block instead of std::cout: its record index in
+    // blocks() and its text, the lines as text output prints them without the
+    // blank separator. The view is only valid during the call.
+    using BlockCallback = std::function<void(std::size_t index, std::string_view text)>;
+
+    // `options` must outlive the processor. With `on_block` set, blocks are
+    // delivered as records (see write_record): at the end of input with final
+    // counts, or in feed() mode as soon as each one completes, with the counts
+    // seen so far.
+    explicit LogProcessor(const Options& options, BlockCallback on_block = {});
 
     void process_stream(std::istream& in);
     void process_lines(const VecS& lines);
+    // Whole input already in memory (a mapped file); lines are views into `data`.
+    void process_buffer(std::string_view data);
+    // Valgrind --xml=yes output; each <error> becomes one block of text-log lines.
+    void process_xml(std::istream& in);
+
+    // `index LOG` (see log_index.h): segments all of `data` as an untrimmed,
+    // unscrubbed run would and hands every block to `out`, duplicates included.
+    // Only Memcheck logs can be indexed.
+    void index_buffer(std::string_view data, LogIndexWriter& out);
+    // Same output as process_buffer(data), from an index of `data`: signatures
+    // come from the indexed canonical lines and only the text of unique blocks
+    // is read.
+    void process_indexed(const LogIndex& index, std::string_view data);
+
+    // Incremental input (follow mode, embedders). Complete lines are processed
+    // as they arrive and each unique block is written as soon as the next one
+    // starts; the dedupe state persists across calls. finish() processes a
+    // trailing unterminated line and flushes the open block. Needs
+    // Options::stream_mode, so that a trimmed run waits for the marker.
+    void feed(std::string_view chunk);
+    void finish();
+    // Incremental input of one whole run (--serve connections): the chunks
+    // are processed as they arrive, but output waits for end_of_input() and
+    // is then the same as process_stream() over their concatenation.
+    void feed_run(std::string_view chunk);
+    void end_of_input();
+
+    // --state support. restore() loads a saved state before process_stream()
+    // continues the same file; checkpoint() captures it afterwards. With a
+    // state file set, process_stream() stops at the last complete line and
+    // leaves the open block for the next run. Input identity and settings
+    // are filled in by the caller.
+    void restore(const Checkpoint& cp);
+    [[nodiscard]] Checkpoint checkpoint() const;
+
+    // Early exit (--max-unique / --fail-on): set once the condition is decided;
+    // input after that point is not read.
+    [[nodiscard]] bool stopped() const noexcept { return stop_requested; }
+    [[nodiscard]] std::optional<BlockKind> fail_on_match() const noexcept { return matched_kind; }
+
+    // Structured records of the unique blocks written so far (current marker
+    // epoch), in output order, with occurrence counts of their duplicates.
+    [[nodiscard]] const BlockStore& blocks() const noexcept { return store; }
 
 private:
-    void process_line(std::string_view line);
-    void flush();
+    // Where flush() sends a new unique block. Decided by route_unique_blocks()
+    // when input starts and when the marker is seen, not once per block.
+    enum class Route : std::uint8_t {
+        Print,   // text to std::cout
+        Record,  // write_record() with the counts so far (feed() mode)
+        Pending, // kept until the end of input
+        Range,   // kept as a byte range of the seekable input
+        Drop,    // feed() mode, trimmed, before the first marker
+    };
+
+    template <class Fn> void dispatch(Fn&& fn);
+    template <class Loop> void run_lines(Loop&& loop);
+    void feed_lines(std::string_view chunk);
+    void route_unique_blocks() noexcept;
+    template <class Policy> [[nodiscard]] bool memcheck_segmentation() const noexcept;
+    template <class Policy> void finish_impl();
+    template <class Policy> void end_of_input_impl();
+    template <class Policy> void process_xml_impl(std::istream& in);
+    template <class Policy> void process_indexed_impl(const LogIndex& index, std::string_view data);
+    template <class Policy> void flush_indexed(const LogIndex& index, std::string_view data, std::size_t block,
+                                               std::uint64_t from);
+    template <class Policy> void process_line(std::string_view line);
+    template <class Policy> void add_line(std::string_view processed);
+    template <class Policy> void flush();
+    template <class Policy> void flush_all();
+    template <class Policy> void note_unique_block();
+    void thread_signature();
+    void race_signature();
+    void probe_tool(std::string_view line);
+    [[nodiscard]] bool suppressed();
+    [[nodiscard]] std::uint32_t record_block(std::uint64_t fp);
+    [[nodiscard]] std::string_view block_header() const noexcept;
+    [[nodiscard]] HeaderCounts header_counts() const noexcept;
+    void select_pid(std::uint32_t pid);
     void clear_current_state() noexcept;
+    void clear_all_blocks() noexcept;
     void reset_epoch() noexcept;
     [[nodiscard]] std::size_t find_marker(const VecS& lines) const;
+    [[nodiscard]] std::size_t find_marker(std::string_view data) const;
 
     void initialize_string_patterns();
     [[nodiscard]] std::size_t get_file_size_for_progress() const;
     [[nodiscard]] bool should_report_progress(std::size_t bytes_processed, std::size_t total_bytes) const;
-    void output_pending_blocks() const;
+    template <class Policy> void output_pending_blocks();
+    template <class Policy> void output_pending_records();
+    template <class Policy> void output_top_records();
+    [[nodiscard]] std::vector<std::uint32_t> top_records() const;
+    void write_record(std::size_t index, std::string_view text);
+    void finish_records();
+    void add_pending_block(std::string_view text);
+    void retune_pending_budget();
 
-    [[nodiscard]] std::string process_raw_line(const std::string& processed_line) const;
-    [[nodiscard]] std::string generate_signature_key() const;
+    template <class Policy> [[nodiscard]] bool scrubs_to_blank(std::string_view processed_line) const;
+    template <class Policy> void render_raw_block();
+    void append_block_line(std::string_view processed_line);
+    [[nodiscard]] const std::string& canonical_line(std::string_view processed_line) const;
+    [[nodiscard]] const std::string& scrubbed_line(std::string_view processed_line) const;
+    void report_statistics() const;
 
     // String matching helpers (regex-free)
     [[nodiscard]] bool matches_vg_line(std::string_view line) const noexcept;
@@ -55,18 +191,112 @@ private:
     [[nodiscard]] bool matches_by_pattern(std::string_view line) const noexcept;
     [[nodiscard]] bool matches_q_pattern(std::string_view line) const noexcept;
 
-    [[nodiscard]] std::string replace_prefix(std::string_view line) const;
-    [[nodiscard]] std::string replace_patterns(const std::string& line) const;
+    [[nodiscard]] std::string_view strip_prefix(std::string_view line) const noexcept;
+    void replace_patterns(std::string& line) const;
+
+    // Span of one accepted line inside BlockState::text (prefix stripped, unscrubbed)
+    struct LineSpan {
+        std::uint32_t offset;
+        std::uint32_t length;
+    };
+
+    // Byte range of a unique block in a seekable input, re-read at output time.
+    // Lines of other PIDs inside the range are skipped.
+    struct SourceRange {
+        std::uint64_t offset;
+        std::uint64_t length;
+        std::uint32_t pid;
+    };
+    template <class Policy> void render_source_range(std::string& chunk, std::string& out, const SourceRange& range);
+
+    // Scratch for the block being built. Allocated from its PidBlock's arena,
+    // which clear_current_state() rewinds in one step once the block is done.
+    struct BlockState {
+        explicit BlockState(std::pmr::memory_resource* mr) : text(mr), spans(mr), sig(mr), raw(mr), head(mr) {
+            // Carved from the arena's inline buffer, so this never reaches malloc.
+            text.reserve(4096);
+            spans.reserve(64);
+            sig.reserve(512);
+        }
+        std::pmr::string           text;   // unscrubbed lines of the block
+        std::pmr::vector<LineSpan> spans;
+        std::pmr::string           sig;    // signature key: first `depth` canonical lines
+        std::size_t                sig_lines{0};
+        std::pmr::string           raw;    // output text, rendered only for unique blocks
+        std::uint64_t              source_begin{0}; // input bytes from the first accepted line
+        std::uint64_t              source_end{0};   // ... to the end of the last one
+        BlockKind                  kind{BlockKind::Other};
+        std::pmr::string           head;            // "N bytes in M blocks" start line, which is not output
+        std::uint64_t              started{0};      // order in which open blocks began
+    };
+
+    // Block being built for one ==PID==. Interleaved processes (--trace-children,
+    // a shared log fd) each get their own, so their lines never mix.
+    struct PidBlock {
+        PidBlock();
+        [[nodiscard]] bool idle() const noexcept {
+            return state->spans.empty() && state->kind == BlockKind::Other;
+        }
+        std::uint32_t                       pid{0};
+        std::unique_ptr<std::byte[]>        buffer;
+        std::pmr::monotonic_buffer_resource arena;
+        std::optional<BlockState>           state;
+    };
+
+    // Dedupe set and stream-mode output for the current marker epoch. Allocated
+    // from epoch_pool, which reset_epoch() releases in one shot. These grow for
+    // the whole epoch, so the pool hands the buffers they outgrow back for reuse
+    // (large ones straight to the heap) instead of holding them until then, and
+    // pending_bytes stays close to the memory really in use.
+    struct EpochState {
+        explicit EpochState(std::pmr::memory_resource* mr)
+            : seen(mr), pending_blocks(mr), spill_lengths(mr), pending_ranges(mr) {}
+        std::pmr::unordered_map<std::uint64_t, std::uint32_t> seen; // signature fingerprint → record in `store`
+        std::pmr::vector<std::pmr::string>        pending_blocks;
+        std::pmr::vector<std::size_t>             spill_lengths;  // of the blocks that went to `spill`
+        std::pmr::vector<SourceRange>             pending_ranges; // used instead when `source` is set
+        std::size_t                               pending_bytes{0};
+        std::size_t                               unique_blocks{0}; // counted for --max-unique
+    };
 
     const Options&   opt;
-    std::string      raw;
-    std::string      sig;
-    VecS             sigLines;
-    std::unordered_set<Str> seen;
+    BlockCallback    on_block;
+    std::size_t      depth_limit;
+    bool             defer_output;   // unique blocks go through write_record() with final counts
+    canonicalization::RuleSet canon_rules;
+    SuppressionSet   suppression_set; // --suppressions
+    std::vector<FrameText> stack_scratch; // frames of the block checked against suppression_set
+    mutable FrameCache frame_cache;  // memoizes canonical_line / scrubbed_line
+    mutable DemangleCache demangler; // mangled symbols in signature lines (valgrind --demangle=no)
+    mutable std::string   demangled;
 
-    // stream-mode buffer
-    std::vector<Str> pending_blocks;
+    std::unordered_map<std::uint32_t, std::unique_ptr<PidBlock>> pid_blocks;
+    std::vector<std::unique_ptr<PidBlock>> spare_pid_blocks; // recycled once a PID goes idle
+    PidBlock*        active{nullptr};  // PID of the line being processed ...
+    BlockState*      cur{nullptr};     // ... and its open block
+    std::uint64_t    blocks_started{0};
+    std::pmr::unsynchronized_pool_resource epoch_pool;
+    std::optional<EpochState>              epoch;
+    BlockStore       store;           // records of the epoch's unique blocks
+    std::size_t      pending_budget;  // bytes of pending output kept in memory; the rest spills
+    std::optional<ResourceGovernor> governor; // sizes pending_budget when --max-memory is not given
+    std::size_t      next_budget_check{0};    // pending_bytes at which to re-sample memory
+    SpillFile        spill;           // pending output beyond the budget, in order
+    std::optional<JsonRecordWriter> records; // --format ndjson/json/sarif output, opened on first use
+    std::optional<ResultFileWriter> results; // --result-file, opened on first use
+    std::optional<SuppressionWriter> suppressions; // --gen-suppressions, opened on first use
+    std::istream*    source{nullptr}; // seekable stream input: pending blocks are kept as ranges
+    std::uint64_t    line_begin{0};   // input offsets of the line being processed (stream mode)
+    std::uint64_t    line_end{0};
+    std::uint64_t    consumed{0};     // input offset after the last complete line processed
+    std::string      partial_line;    // unterminated tail of the last feed() chunk
+    bool             live{false};     // feed() mode: write unique blocks immediately
+    Route            route{Route::Print};
+    bool             stop_requested{false};
+    std::optional<BlockKind> matched_kind;
     bool             marker_found{false};
+    ValgrindTool     tool{ValgrindTool::Memcheck}; // from the preamble banner; decides segmentation
+    std::uint32_t    tool_probe_left;              // Valgrind lines still searched for the banner
 
     // pattern placeholders
     std::string vg_pattern;
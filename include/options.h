@@ -7,22 +7,55 @@
 
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <string_view>
+#include <vector>
 #include <iostream>
 
 inline constexpr int   DEFAULT_DEPTH               = 1;
 inline constexpr auto  DEFAULT_MARKER              = std::string_view{"Successfully downloaded debug"};
-inline constexpr size_t LARGE_FILE_THRESHOLD_MB    = 5;
+inline constexpr size_t LARGE_FILE_THRESHOLD_MB    = 5; // larger files are mapped or streamed
+inline constexpr size_t DEFAULT_FRAME_CACHE_ENTRIES = 4096;
+
+// How unique blocks are written: as the log's own text, or as records with
+// kind, fingerprint, frames and counts (--format). Sarif is a SARIF 2.1.0 log
+// with one result per unique block, for code-scanning dashboards.
+enum class OutputFormat : std::uint8_t { Text, Ndjson, Json, Sarif };
+
+// --format names; parse_output_format throws std::runtime_error on others.
+[[nodiscard]] OutputFormat     parse_output_format(std::string_view sv);
+[[nodiscard]] std::string_view output_format_name(OutputFormat format) noexcept;
+
+// What --top ranks unique blocks by: occurrences, or bytes lost (leak records only).
+enum class RankBy : std::uint8_t { Count, Bytes };
 
 struct Options {
     int         depth          = DEFAULT_DEPTH;
     bool        trim           = true;
     bool        scrub_raw      = true;
     bool        stream_mode    = false;
+    bool        map_input      = false;  // non-stream file input is memory-mapped
+    bool        xml_input      = false;  // Valgrind --xml=yes output (--xml, or detected)
     bool        show_progress  = false;
     bool        monitor_memory = false;
+    bool        follow         = false;  // watch the input file and process appended data
+    OutputFormat format        = OutputFormat::Text;
+    std::string result_file;             // --result-file: also write the binary result file here
+    std::string suppressions_file;       // --gen-suppressions: write a Valgrind suppression per unique block
+    std::vector<std::string> suppress_files; // --suppressions: drop blocks these suppression files match
+    std::string state_file;              // --state: resume from / save to this checkpoint
+    std::string serve_socket;            // --serve: aggregate logs sent to this Unix socket
+    std::string query_socket;            // --query: print the aggregate of the server on this socket
+    size_t      max_unique     = 0;      // stop after this many unique blocks (0 = no limit)
+    size_t      top            = 0;      // output only the K highest-ranked blocks (0 = all, in order)
+    RankBy      rank_by        = RankBy::Count;
+    std::uint32_t fail_on      = 0;      // BlockKindMask: stop and fail on the first such block
     std::string marker         = std::string(DEFAULT_MARKER);
+    std::string canon_rules_file;
+    size_t      frame_cache_entries = DEFAULT_FRAME_CACHE_ENTRIES;
+    size_t      max_memory_mb  = 0;  // pending output budget (0 = sized from free memory)
+    std::string system_root    = "/"; // where free memory is read from (/proc, /sys/fs/cgroup)
     std::string filename;
     bool        use_stdin      = false;
 };
@@ -0,0 +1,56 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+
+// How a file input is read: whole into a line vector, memory-mapped and split
+// in place, or streamed line by line with unique blocks held until EOF.
+enum class InputStrategy : std::uint8_t { InMemory, Mapped, Stream };
+
+[[nodiscard]] std::string_view strategy_name(InputStrategy s) noexcept;
+
+// Point-in-time memory figures. Zero means the value could not be read.
+struct MemoryStatus {
+    std::size_t rss_bytes{0};          // current resident set (/proc/self/statm)
+    std::size_t available_bytes{0};    // MemAvailable (/proc/meminfo)
+    std::size_t cgroup_limit_bytes{0}; // memory.max / memory.limit_in_bytes (0 = no limit)
+    std::size_t cgroup_usage_bytes{0};
+
+    // Bytes the process can still allocate: the smaller of system-wide
+    // available memory and what is left under the cgroup limit. nullopt when
+    // neither is known (no /proc).
+    [[nodiscard]] std::optional<std::size_t> headroom() const noexcept;
+};
+
+// Reads current memory usage and limits from procfs and the cgroup (v1 or
+// v2) this process belongs to. `root` replaces "/" so tests can supply a
+// fake tree; the cgroup files are located once, at construction.
+class ResourceGovernor {
+public:
+    explicit ResourceGovernor(std::filesystem::path root = "/");
+
+    [[nodiscard]] MemoryStatus sample() const;
+    [[nodiscard]] std::size_t  rss_bytes() const;
+
+private:
+    void locate_cgroup();
+
+    std::filesystem::path root_;
+    std::filesystem::path cgroup_limit_;
+    std::filesystem::path cgroup_usage_;
+};
+
+// Picks the cheapest strategy that fits: small files are read into memory,
+// larger ones are mapped while half the headroom covers them, and anything
+// else (or any large file when memory cannot be measured) is streamed.
+[[nodiscard]] InputStrategy choose_strategy(std::uintmax_t file_size, const MemoryStatus& status) noexcept;
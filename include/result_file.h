@@ -0,0 +1,114 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#pragma once
+
+#include "block_store.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iosfwd>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Binary result file (--result-file): a run's unique blocks in a form other
+// tools can mmap and query in O(1) without parsing text. Host byte order, like
+// --state files; all offsets are from the start of the file and 8-aligned.
+//
+//   ResultHeader
+//   blob            each record's text, back to back (padded to 8 bytes)
+//   ResultRecord[]  one per unique block, in output order
+//   ResultSlot[]    open-addressing table: fingerprint → record
+//
+// `slots` is a power of two, at least twice `records`. A lookup starts at
+// slot `fingerprint & (slots - 1)` and steps forward until the fingerprint or
+// an empty slot is found.
+inline constexpr std::string_view RESULT_MAGIC   = "VGLFRSLT";
+inline constexpr std::uint32_t    RESULT_VERSION = 1;
+
+struct ResultHeader {
+    char          magic[8];
+    std::uint32_t version;
+    std::uint32_t record_size;   // sizeof(ResultRecord), so readers can skip newer fields
+    std::uint64_t records;
+    std::uint64_t slots;
+    std::uint64_t blob_offset;
+    std::uint64_t blob_size;
+    std::uint64_t records_offset;
+    std::uint64_t slots_offset;
+};
+
+struct ResultRecord {
+    std::uint64_t fingerprint;   // signature hash, the dedupe key
+    std::uint64_t bytes;         // summed over occurrences, as BlockStore::bytes()
+    std::uint64_t heap_blocks;
+    std::uint64_t text_offset;   // into the blob
+    std::uint32_t text_length;   // lines as text output prints them, without the last '\n'
+    std::uint32_t occurrences;
+    std::uint8_t  kind;          // BlockKind
+    std::uint8_t  reserved[7];
+};
+
+struct ResultSlot {
+    std::uint64_t fingerprint;
+    std::uint64_t record;        // index + 1; 0 = empty
+};
+
+static_assert(sizeof(ResultHeader) == 64 && sizeof(ResultRecord) == 48 && sizeof(ResultSlot) == 16);
+
+// Streams the blob to a temporary file next to `filename` as records arrive,
+// then appends the tables and header and renames it into place.
+class ResultFileWriter {
+public:
+    explicit ResultFileWriter(std::string_view filename);
+    ~ResultFileWriter();
+
+    ResultFileWriter(const ResultFileWriter&)            = delete;
+    ResultFileWriter& operator=(const ResultFileWriter&) = delete;
+
+    // Record `index` of `store`; its counts must be final.
+    void add(const BlockStore& store, std::size_t index, std::string_view text);
+    void finish();
+
+private:
+    std::string               name_;
+    std::filesystem::path     path_;
+    std::filesystem::path     tmp_;
+    std::ofstream             out_;
+    std::vector<ResultRecord> records_;
+    std::uint64_t             blob_size_{0};
+    bool                      finished_{false};
+};
+
+// Read-only mapping of a result file. The constructor validates the header
+// and table bounds and throws std::runtime_error if the file is corrupt.
+class ResultFile {
+public:
+    explicit ResultFile(std::string_view filename);
+    ~ResultFile();
+
+    ResultFile(const ResultFile&)            = delete;
+    ResultFile& operator=(const ResultFile&) = delete;
+
+    [[nodiscard]] std::size_t      size() const noexcept { return static_cast<std::size_t>(header_.records); }
+    [[nodiscard]] ResultRecord     record(std::size_t i) const noexcept;
+    [[nodiscard]] std::string_view text(const ResultRecord& r) const; // throws if out of bounds
+    [[nodiscard]] std::optional<std::size_t> find(std::uint64_t fingerprint) const noexcept;
+
+private:
+    const char*  data_{nullptr};
+    std::size_t  size_{0};
+    ResultHeader header_{};
+};
+
+// `vglog-filter show FILE [FINGERPRINT]`: the text output of the run that
+// wrote FILE, or only the block with that (hex) fingerprint.
+void show_result_file(std::string_view filename, std::optional<std::string_view> fingerprint, std::ostream& os);
@@ -0,0 +1,48 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#pragma once
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+
+// Append-only overflow storage for stream-mode output. The backing file is
+// created on first use in $TMPDIR (or /tmp) and unlinked immediately, so it
+// never outlives the process. Writes are buffered and strictly sequential.
+class SpillFile {
+public:
+    SpillFile() = default;
+    ~SpillFile();
+
+    SpillFile(const SpillFile&)            = delete;
+    SpillFile& operator=(const SpillFile&) = delete;
+
+    void append(std::string_view data);
+
+    // Discards everything written so far (used when a marker starts a new epoch).
+    void truncate() noexcept;
+
+    // Streams the spilled bytes, in append order, to `os`.
+    void copy_to(std::ostream& os);
+
+    // Replaces `out` with `length` bytes starting `offset` bytes into the spill.
+    void read(std::size_t offset, std::size_t length, std::string& out);
+
+    [[nodiscard]] bool        empty() const noexcept { return bytes_ == 0; }
+    [[nodiscard]] std::size_t bytes() const noexcept { return bytes_; }
+
+private:
+    void open_file();
+    void flush_buffer();
+    void write_all(std::string_view data);
+
+    int         fd_{-1};
+    std::string buffer_;
+    std::size_t bytes_{0};
+};
@@ -0,0 +1,143 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#pragma once
+
+#include "block_store.h"
+#include "canon_rules.h"
+#include "demangle.h"
+#include "thread_report.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Suppression kind line(s) for a block: "Memcheck:Addr4", "Memcheck:Leak\n
+// match-leak-kinds: definite", "Memcheck:Param\nwrite(buf)", "Helgrind:Race".
+// nullopt for blocks Valgrind cannot suppress or whose kind is ambiguous.
+[[nodiscard]] std::optional<std::string> suppression_kind(ValgrindTool tool, BlockKind kind, std::string_view header);
+
+// A fun: pattern matching `raw` wherever canonicalization erased or rewrote
+// part of it: raw "Map<int, Foo>::at" with canonical "Map<>::at" gives
+// "Map<*>::at".
+[[nodiscard]] std::string wildcard_pattern(std::string_view raw, std::string_view canonical);
+
+// Writes one Valgrind suppression per unique block (--gen-suppressions),
+// built from the first `depth` frames of the block's own stack (0 = all).
+// Blocks whose suppressions come out identical, which happens once details
+// are wildcarded, are written once.
+//
+// Valgrind matches fun: lines against mangled names, so only logs written with
+// valgrind --demangle=no give exact fun: frames: mangled names are kept as
+// they are and plain C names get wildcards. A demangled C++ frame becomes
+// obj: of its object, or fun:* when the log names a source file instead; an
+// entry left with nothing but fun:* frames is not written.
+class SuppressionWriter {
+public:
+    SuppressionWriter(std::string_view filename, std::size_t depth, const canonicalization::RuleSet& rules);
+
+    void add(const BlockStore& store, std::size_t index, ValgrindTool tool);
+    void finish();
+
+    [[nodiscard]] std::size_t written() const noexcept { return seen_.size(); }
+
+private:
+    [[nodiscard]] std::string frame_line(std::string_view function, std::string_view object);
+
+    std::string                             name_;
+    std::ofstream                           out_;
+    std::size_t                             depth_;
+    const canonicalization::RuleSet&        rules_;
+    DemangleCache                           demangler_; // tells mangled names from plain C ones
+    std::unordered_set<std::uint64_t>       seen_;   // fingerprints of the bodies written
+    std::string                             body_;
+    std::string                             canonical_;
+};
+
+// Valgrind suppression files applied to the log (--suppressions). A block is
+// dropped when an entry of its suppression kind matches the top of its own
+// stack. All entries are compiled into one trie over frame patterns: literal
+// fun:/obj:/src: patterns are hashed, and globbed ones ('*', '?') are bucketed
+// by the literal text before their first wildcard, so a frame only tries the
+// globs whose prefix it starts with. Failed "..." states are remembered per
+// block, so entries with several of them cannot backtrack exponentially.
+// Checking a block costs time proportional to its depth rather than to the
+// number of entries.
+class SuppressionSet {
+public:
+    // Adds the entries of a suppression file; `origin` names it in errors.
+    // Throws std::runtime_error on a malformed entry.
+    void parse(std::string_view text, std::string_view origin);
+    void load(std::string_view filename);
+
+    [[nodiscard]] bool        empty() const noexcept { return entries_ == 0; }
+    [[nodiscard]] std::size_t size() const noexcept { return entries_; }
+    [[nodiscard]] std::size_t node_count() const noexcept { return nodes_.size(); }
+    // Globbed patterns run against a frame so far, over all matches() calls.
+    [[nodiscard]] std::size_t glob_checks() const noexcept { return glob_checks_; }
+
+    // `stack` is the block's own stack, innermost frame first.
+    [[nodiscard]] bool matches(ValgrindTool tool, BlockKind kind, std::string_view header,
+                               std::span<const FrameText> stack) const;
+
+private:
+    struct Hash {
+        using is_transparent = void;
+        [[nodiscard]] std::size_t operator()(std::string_view s) const noexcept {
+            return std::hash<std::string_view>{}(s);
+        }
+    };
+
+    // A globbed pattern; its literal ends are compared before the glob runs
+    // on what lies between them.
+    struct Glob {
+        std::string   pattern;                                       // "fun:std::*::at(*)"
+        std::uint32_t child;
+        std::uint32_t prefix;                                        // literal length after the tag ...
+        std::uint32_t suffix;                                        // ... and after the last wildcard
+    };
+
+    // Frame fields globs are bucketed by: function, object, "FILE:LINE".
+    static constexpr std::size_t GLOB_FIELDS = 3;
+
+    struct Globs {
+        std::vector<Glob> all;
+        std::array<std::unordered_map<std::string, std::vector<std::uint32_t>, Hash, std::equal_to<>>, GLOB_FIELDS>
+            by_prefix;                                               // literal prefix → into `all`
+        std::array<std::vector<std::uint32_t>, GLOB_FIELDS> prefix_lengths; // distinct, ascending
+    };
+
+    struct Node {
+        std::unordered_map<std::string, std::uint32_t> literal;      // "fun:main" → child
+        std::unique_ptr<Globs> globs;                                // null until a glob is added
+        std::uint32_t ellipsis{0};                                   // child after "...", 0 = none
+        BlockKindMask accept{0};                                     // kinds of the entries ending here
+    };
+
+    [[nodiscard]] std::uint32_t child(std::uint32_t node, std::string_view pattern);
+    [[nodiscard]] bool match(std::uint32_t node, std::span<const FrameText> stack, std::size_t pos,
+                             BlockKindMask kind) const;
+    [[nodiscard]] bool match_globs(const Globs& globs, std::span<const FrameText> stack, std::size_t pos,
+                                   BlockKindMask kind) const;
+
+    std::unordered_map<std::string, std::uint32_t> roots_; // "Memcheck:Addr4", "Memcheck:Param\nwrite(buf)" → node
+    std::vector<Node>   nodes_;
+    std::size_t         entries_{0};
+    mutable std::string key_;                               // lookup scratch
+    mutable std::unordered_set<std::uint64_t> failed_;      // (node after "...", frame) that did not match this block
+    mutable std::size_t glob_checks_{0};
+};
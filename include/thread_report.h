@@ -0,0 +1,50 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#pragma once
+
+#include "block_kind.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+
+// Valgrind tool that wrote a log. It is named on the first line of each
+// process's preamble ("Helgrind, a thread error detector") and decides which
+// lines start a block.
+enum class ValgrindTool : std::uint8_t { Memcheck, Helgrind, Drd };
+
+// Lines are ==PID==-stripped, as for classify_block().
+[[nodiscard]] std::optional<ValgrindTool> detect_tool(std::string_view line) noexcept;
+
+// What a Helgrind or DRD line does to block segmentation. Memcheck lines go
+// through the start-pattern table and classify_block() instead.
+enum class LineRole : std::uint8_t {
+    Body,      // joins the open block
+    Start,     // closes the open block and opens one of `kind`
+    Separator, // closes the open block and is dropped ("------", DRD's "Thread 2:")
+};
+struct ThreadLine {
+    LineRole  role{LineRole::Body};
+    BlockKind kind{BlockKind::Other};
+};
+[[nodiscard]] ThreadLine classify_thread_line(ValgrindTool tool, std::string_view line) noexcept;
+
+// One side of a race, without addresses or thread numbers, appended to `out`:
+// "write of size 4" for "Possible data race during write of size 4 at 0x… by
+// thread #1" and for "This conflicts with a previous write of size 4 by thread
+// #2"; "load size 4" for DRD's "Conflicting load by thread 2 at 0x… size 4".
+// Returns false, leaving `out` alone, for any other line.
+[[nodiscard]] bool race_access(std::string_view line, std::string& out);
+
+// Rewrites thread numbers in place ("thread #3" → "thread #N", "Thread 12" →
+// "Thread N") so reports differing only in thread numbering share a signature.
+// Returns the new length, which is never larger.
+[[nodiscard]] std::size_t neutralize_thread_ids(std::span<char> text) noexcept;
@@ -0,0 +1,87 @@
+/*
+ * Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This file is part of vglog-filter and is licensed under
+ * the GNU General Public License v3.0 or later.
+ * See the LICENSE file in the project root for details.
+ */
+
+/*
+ * C interface of libvglog-filter, for filtering Valgrind output in-process
+ * instead of piping it through the vglog-filter executable.
+ *
+ *   vglog_options opt;
+ *   vglog_options_init(&opt);
+ *   vglog_filter* f = vglog_filter_new(&opt, on_block, ctx);
+ *   while (...) vglog_filter_feed(f, buf, n);   // any chunking
+ *   vglog_filter_finish(f);
+ *   vglog_filter_free(f);
+ *
+ * Each unique block is passed to the callback as soon as it completes. Its
+ * text points into the filter's own buffers: nothing is copied, and it is
+ * only valid during the call. A filter is not thread-safe; use one per
+ * stream.
+ */
+#ifndef VGLOG_FILTER_H
+#define VGLOG_FILTER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__GNUC__)
+#define VGLOG_API __attribute__((visibility("default")))
+#else
+#define VGLOG_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct vglog_filter vglog_filter;
+
+typedef struct vglog_options {
+    int         depth;             /* signature frames, 0 = unlimited (default 1) */
+    int         keep_debug_info;   /* nonzero: do not wait for the marker (-k) */
+    int         raw;               /* nonzero: keep addresses and '???' in the text (-v) */
+    const char* marker;            /* NULL: the default marker */
+    const char* canon_rules_file;  /* NULL: none (--canon-rules) */
+    const char* suppressions_file; /* NULL: none; Valgrind suppressions to apply */
+} vglog_options;
+
+typedef struct vglog_block {
+    const char* text;        /* the block's lines, '\n'-separated; not NUL-terminated */
+    size_t      length;
+    const char* kind;        /* "invalid-read", "definitely-lost", ... (static) */
+    uint64_t    fingerprint; /* signature hash, the dedupe key */
+    uint32_t    occurrences; /* seen so far, including this one */
+    uint64_t    bytes;       /* access size or bytes lost, summed over occurrences */
+    uint64_t    heap_blocks;
+} vglog_block;
+
+typedef void (*vglog_block_callback)(const vglog_block* block, void* user_data);
+
+/* Fills `options` with the defaults of the vglog-filter executable. */
+VGLOG_API void vglog_options_init(vglog_options* options);
+
+/* Returns NULL on failure (e.g. an unreadable rules file); see vglog_last_error(). */
+VGLOG_API vglog_filter* vglog_filter_new(const vglog_options* options, vglog_block_callback callback,
+                                         void* user_data);
+
+/* 0 on success, -1 on error. After an error the filter can only be freed. */
+VGLOG_API int vglog_filter_feed(vglog_filter* filter, const char* data, size_t length);
+VGLOG_API int vglog_filter_finish(vglog_filter* filter);
+
+VGLOG_API void vglog_filter_free(vglog_filter* filter);
+
+/* Message of the last failed call on this thread, or "". */
+VGLOG_API const char* vglog_last_error(void);
+
+VGLOG_API const char* vglog_version(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VGLOG_FILTER_H */
@@ -0,0 +1,51 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#pragma once
+
+#include "block_kind.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+
+inline constexpr std::size_t XML_CHUNK_BYTES = 256u * 1024u;
+
+// SAX callbacks. Views are only valid during the call. Character data arrives
+// entity-decoded, possibly in several pieces, and includes whitespace between
+// elements; attributes are not reported (Valgrind's protocol has none we use).
+class XmlHandler {
+public:
+    virtual ~XmlHandler() = default;
+    virtual void start_element(std::string_view name) = 0;
+    virtual void end_element(std::string_view name) = 0;
+    virtual void characters(std::string_view text) = 0;
+    // Checked after each element closes; true stops the parse early.
+    [[nodiscard]] virtual bool done() const noexcept { return false; }
+};
+
+// Streaming parse of `in`, read `chunk_bytes` at a time. Memory stays bounded
+// by the chunk size plus the longest single tag or text run, which is capped.
+// Throws std::runtime_error on malformed markup.
+void parse_xml(std::istream& in, XmlHandler& handler, std::size_t chunk_bytes = XML_CHUNK_BYTES);
+
+// Receives Valgrind errors as text-log style blocks: a start line, then frame
+// lines ("at 0x…: fn (file:line)", "by …") and auxiliary lines, in order.
+class XmlBlockSink {
+public:
+    virtual ~XmlBlockSink() = default;
+    virtual void begin_block(std::uint32_t pid, BlockKind kind) = 0;
+    virtual void line(std::string_view text) = 0;
+    virtual void end_block() = 0;
+    [[nodiscard]] virtual bool done() const noexcept { return false; }
+};
+
+// Reads a Valgrind --xml=yes document (protocol 4) and reports each <error>
+// and <fatal_signal> to `sink` as soon as it closes.
+void read_valgrind_xml(std::istream& in, XmlBlockSink& sink, std::size_t chunk_bytes = XML_CHUNK_BYTES);
@@ -0,0 +1,482 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include "aggregation_server.h"
+
+#include "file_utils.h"
+#include "json_writer.h"
+#include "log_processor.h"
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <poll.h>
+#include <pthread.h>
+#include <sstream>
+#include <stdexcept>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <tuple>
+#include <unistd.h>
+#include <utility>
+
+namespace {
+
+inline constexpr std::size_t READ_CHUNK_BYTES  = 64u * 1024u;
+inline constexpr std::size_t MAX_INBOX_BYTES   = 4 * READ_CHUNK_BYTES; // read ahead of the workers per connection
+inline constexpr std::size_t MAX_REQUEST_LINE  = 64; // longer first lines are log text
+inline constexpr auto        REPORT_REQUEST    = std::string_view{"REPORT"};
+inline constexpr auto        ERROR_REPLY       = std::string_view{"ERROR "};
+
+[[noreturn]] void throw_errno(std::string_view operation, std::string_view target) {
+    throw std::runtime_error(create_error_message(operation, target, std::strerror(errno)));
+}
+
+[[nodiscard]] sockaddr_un socket_address(std::string_view path) {
+    sockaddr_un addr{};
+    if (path.empty()) throw std::invalid_argument("Socket path cannot be empty");
+    if (path.find('\0') != std::string_view::npos) throw std::runtime_error("Socket path contains null bytes");
+    if (path.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("Socket path too long (max " + std::to_string(sizeof(addr.sun_path) - 1) +
+                                 " characters): " + std::string(path));
+    }
+    addr.sun_family = AF_UNIX;
+    std::copy(path.begin(), path.end(), addr.sun_path);
+    return addr;
+}
+
+// Connected socket, or -1 with errno set.
+[[nodiscard]] int connect_to(const sockaddr_un& addr) noexcept {
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+        const int saved = errno;
+        ::close(fd);
+        errno = saved;
+        return -1;
+    }
+    return fd;
+}
+
+// Reads what is available on `fd`; 0 at end of stream.
+[[nodiscard]] std::size_t read_some(int fd, char* data, std::size_t size) {
+    for (;;) {
+        pollfd in{fd, POLLIN, 0};
+        if (::poll(&in, 1, -1) < 0) {
+            if (errno == EINTR) continue;
+            throw_errno("poll", "connection");
+        }
+        const auto n = ::read(fd, data, size);
+        if (n >= 0) return static_cast<std::size_t>(n);
+        if (errno != EINTR && errno != EAGAIN) throw_errno("read", "connection");
+    }
+}
+
+void send_all(int fd, std::string_view data) {
+    while (!data.empty()) {
+        const auto n = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                // A server socket is non-blocking: wait until the client reads.
+                pollfd out{fd, POLLOUT, 0};
+                if (::poll(&out, 1, -1) >= 0 || errno == EINTR) continue;
+            }
+            throw_errno("send", "connection");
+        }
+        data.remove_prefix(static_cast<std::size_t>(n));
+    }
+}
+
+[[nodiscard]] std::string_view trim(std::string_view sv) noexcept {
+    const auto first = sv.find_first_not_of(" \t\r");
+    if (first == std::string_view::npos) return {};
+    return sv.substr(first, sv.find_last_not_of(" \t\r") - first + 1);
+}
+
+} // namespace
+
+BlockAggregate::BlockAggregate(std::size_t shards)
+    : shards_(std::make_unique<Shard[]>(std::bit_ceil(std::max<std::size_t>(shards, 1)))),
+      shard_count_(std::bit_ceil(std::max<std::size_t>(shards, 1))) {}
+
+void BlockAggregate::merge(const BlockStore& store, std::size_t i, std::string_view text) {
+    Shard&                      s = shard(store.fingerprint(i));
+    const std::lock_guard<std::mutex> lock(s.mutex);
+    const auto [it, unique] = s.index.try_emplace(store.fingerprint(i), 0);
+    if (!unique) {
+        s.store.add_counts(it->second, store, i);
+        return;
+    }
+    try {
+        it->second = s.store.append(store, i);
+        s.texts.emplace_back(text);
+        s.order.push_back(next_order_.fetch_add(1, std::memory_order_relaxed));
+    } catch (...) {
+        s.index.erase(it);
+        throw;
+    }
+}
+
+std::size_t BlockAggregate::size() const {
+    std::size_t n = 0;
+    for (std::size_t i = 0; i < shard_count_; ++i) {
+        const std::lock_guard<std::mutex> lock(shards_[i].mutex);
+        n += shards_[i].store.size();
+    }
+    return n;
+}
+
+void BlockAggregate::write_report(std::ostream& os, OutputFormat format) const {
+    // Shards are always locked in index order; merge() only ever holds one.
+    std::vector<std::unique_lock<std::mutex>> locks;
+    locks.reserve(shard_count_);
+    std::vector<std::tuple<std::uint64_t, std::size_t, std::uint32_t>> records; // order, shard, record
+    for (std::size_t i = 0; i < shard_count_; ++i) {
+        locks.emplace_back(shards_[i].mutex);
+        for (std::uint32_t r = 0; r < shards_[i].store.size(); ++r) records.emplace_back(shards_[i].order[r], i, r);
+    }
+    std::sort(records.begin(), records.end());
+
+    if (format == OutputFormat::Text) {
+        for (const auto& [order, i, r] : records) os << shards_[i].texts[r] << "\n\n";
+        os.flush();
+        return;
+    }
+    JsonRecordWriter writer(os, format);
+    for (const auto& [order, i, r] : records) writer.write(shards_[i].store, r, shards_[i].texts[r]);
+    writer.finish();
+}
+
+// One client. The reactor appends what it reads to `inbox`; a worker drains
+// it into the run. `scheduled` keeps it to one worker at a time.
+struct AggregationServer::Connection {
+    enum class Kind { Unknown, Report, Text, Xml };
+
+    explicit Connection(int socket) noexcept : fd(socket) {}
+    ~Connection() { ::close(fd); }
+    Connection(const Connection&)            = delete;
+    Connection& operator=(const Connection&) = delete;
+
+    const int   fd;
+    std::mutex  mutex;            // guards the next four
+    std::string inbox;            // read, not yet processed
+    bool        eof{false};       // nothing more will be read
+    bool        scheduled{false}; // queued or being processed
+    bool        done{false};      // processed to the end; the reactor closes it
+    // Owned by the worker processing it
+    Kind        kind{Kind::Unknown};
+    std::string head;             // bytes before the first line is known; a whole XML run
+    std::unique_ptr<LogProcessor> run;
+};
+
+AggregationServer::AggregationServer(std::string socket_path, const Options& options, std::size_t workers)
+    : path_(std::move(socket_path)), options_(options),
+      workers_(workers != 0 ? workers : std::max(1u, std::thread::hardware_concurrency())) {
+    // Each connection is one whole run read to its end, like stdin input.
+    options_.stream_mode    = true;
+    options_.use_stdin      = true;
+    options_.follow         = false;
+    options_.show_progress  = false;
+    options_.monitor_memory = false;
+    options_.result_file.clear();
+    options_.suppressions_file.clear();
+    options_.state_file.clear();
+    options_.top        = 0;
+    options_.max_unique = 0;
+    options_.fail_on    = 0;
+
+    const sockaddr_un addr = socket_address(path_);
+    struct stat st{};
+    if (::lstat(path_.c_str(), &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) throw std::runtime_error("Not a socket: " + path_);
+        // A socket nobody accepts on is left over from a server that is gone.
+        if (const int fd = connect_to(addr); fd >= 0) {
+            ::close(fd);
+            throw std::runtime_error("Another server is listening on " + path_);
+        }
+        ::unlink(path_.c_str());
+    }
+
+    listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) throw_errno("socket", path_);
+    if (::bind(listen_fd_, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(listen_fd_, SOMAXCONN) != 0) {
+        const int saved = errno;
+        ::close(listen_fd_);
+        errno = saved;
+        throw_errno("bind", path_);
+    }
+    wake_fd_   = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    notify_fd_ = wake_fd_ >= 0 ? ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK) : -1;
+    if (notify_fd_ < 0) {
+        const int saved = errno;
+        if (wake_fd_ >= 0) ::close(wake_fd_);
+        ::close(listen_fd_);
+        ::unlink(path_.c_str());
+        errno = saved;
+        throw_errno("eventfd", path_);
+    }
+}
+
+AggregationServer::~AggregationServer() {
+    stop();
+    {
+        const std::lock_guard<std::mutex> lock(queue_mutex_);
+        closing_ = true;
+    }
+    queue_ready_.notify_all();
+    for (auto& t : threads_) {
+        if (t.joinable()) t.join();
+    }
+    connections_.clear();
+    ::close(listen_fd_);
+    ::close(wake_fd_);
+    ::close(notify_fd_);
+    ::unlink(path_.c_str());
+}
+
+void AggregationServer::stop() noexcept {
+    const std::uint64_t one = 1;
+    [[maybe_unused]] const auto n = ::write(wake_fd_, &one, sizeof(one));
+}
+
+void AggregationServer::run() {
+    // Blocked before the workers start, so they inherit the mask and the
+    // signals are only ever seen through signal_fd.
+    sigset_t stop_signals;
+    sigset_t previous;
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGINT);
+    sigaddset(&stop_signals, SIGTERM);
+    if (::pthread_sigmask(SIG_BLOCK, &stop_signals, &previous) != 0) throw_errno("signal setup", path_);
+    const int signal_fd = ::signalfd(-1, &stop_signals, SFD_CLOEXEC);
+    if (signal_fd < 0) {
+        ::pthread_sigmask(SIG_SETMASK, &previous, nullptr);
+        throw_errno("signal setup", path_);
+    }
+
+    closing_ = false;
+    threads_.reserve(workers_);
+    for (std::size_t i = 0; i < workers_; ++i) threads_.emplace_back([this] { work(); });
+
+    constexpr std::size_t FIXED_FDS = 4;
+    std::vector<pollfd>      fds;
+    std::vector<Connection*> polled;
+    std::string              buffer(READ_CHUNK_BYTES, '\0');
+    for (;;) {
+        fds.assign({{listen_fd_, POLLIN, 0}, {signal_fd, POLLIN, 0}, {wake_fd_, POLLIN, 0}, {notify_fd_, POLLIN, 0}});
+        polled.clear();
+        for (auto it = connections_.begin(); it != connections_.end();) {
+            Connection& c = *it->second;
+            bool done = false;
+            bool wait = false;
+            {
+                const std::lock_guard<std::mutex> lock(c.mutex);
+                done = c.done;
+                // A full inbox is left until a worker drains it; the client blocks in send().
+                wait = !c.eof && c.inbox.size() < MAX_INBOX_BYTES;
+            }
+            if (done) {
+                it = connections_.erase(it);
+                continue;
+            }
+            if (wait) {
+                fds.push_back({c.fd, POLLIN, 0});
+                polled.push_back(&c);
+            }
+            ++it;
+        }
+
+        if (::poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[1].revents & POLLIN) {
+            // Consumed, so it is not delivered again once the mask is restored.
+            signalfd_siginfo info{};
+            [[maybe_unused]] const auto n = ::read(signal_fd, &info, sizeof(info));
+            break;
+        }
+        if (fds[2].revents & POLLIN) break;
+        if (fds[3].revents & POLLIN) {
+            std::uint64_t count = 0;
+            [[maybe_unused]] const auto n = ::read(notify_fd_, &count, sizeof(count));
+        }
+        for (std::size_t i = 0; i < polled.size(); ++i) {
+            if (fds[FIXED_FDS + i].revents != 0 && read_from(*polled[i], buffer)) schedule(*polled[i]);
+        }
+        if (fds[0].revents & POLLIN) {
+            const int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+            // Failures are the client giving up (ECONNABORTED) or a transient limit.
+            if (fd >= 0) connections_.emplace(fd, std::make_unique<Connection>(fd));
+        }
+    }
+
+    // Open connections end where they are, and what they sent so far is merged.
+    for (auto& [fd, c] : connections_) {
+        bool queue = false;
+        {
+            const std::lock_guard<std::mutex> lock(c->mutex);
+            c->eof = true;
+            queue  = !c->scheduled && !c->done;
+            c->scheduled = true;
+        }
+        if (queue) schedule(*c);
+    }
+    {
+        const std::lock_guard<std::mutex> lock(queue_mutex_);
+        closing_ = true;
+    }
+    queue_ready_.notify_all();
+    for (auto& t : threads_) t.join();
+    threads_.clear();
+    connections_.clear();
+    ::close(signal_fd);
+    ::pthread_sigmask(SIG_SETMASK, &previous, nullptr);
+}
+
+bool AggregationServer::read_from(Connection& c, std::string& buffer) {
+    const auto n = ::read(c.fd, buffer.data(), buffer.size());
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return false;
+
+    const std::lock_guard<std::mutex> lock(c.mutex);
+    if (n > 0) c.inbox.append(buffer, 0, static_cast<std::size_t>(n));
+    else       c.eof = true; // closed, or reset: the run ends here either way
+    if (c.scheduled) return false;
+    c.scheduled = true;
+    return true;
+}
+
+void AggregationServer::schedule(Connection& c) {
+    {
+        const std::lock_guard<std::mutex> lock(queue_mutex_);
+        queue_.push_back(&c);
+    }
+    queue_ready_.notify_one();
+}
+
+void AggregationServer::work() {
+    for (;;) {
+        Connection* c = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            queue_ready_.wait(lock, [this] { return closing_ || !queue_.empty(); });
+            if (queue_.empty()) return;
+            c = queue_.front();
+            queue_.pop_front();
+        }
+
+        std::string chunk;
+        bool        at_end = false;
+        {
+            const std::lock_guard<std::mutex> lock(c->mutex);
+            chunk.swap(c->inbox);
+            at_end = c->eof;
+        }
+        bool finished = at_end;
+        try {
+            process(*c, chunk, at_end);
+            finished = finished || c->kind == Connection::Kind::Report;
+        } catch (const std::exception& e) {
+            // One bad client must not take the server down.
+            std::cerr << "Warning: connection dropped: " << e.what() << '\n';
+            finished = true;
+        }
+
+        // One chunk per turn: a connection with more waits behind the others.
+        bool again = false;
+        {
+            const std::lock_guard<std::mutex> lock(c->mutex);
+            if (finished)                         c->done = true; // the reactor may free it from here on
+            else if (c->inbox.empty() && !c->eof) c->scheduled = false;
+            else                                  again = true;
+        }
+        if (again) schedule(*c);
+        const std::uint64_t one = 1;
+        [[maybe_unused]] const auto n = ::write(notify_fd_, &one, sizeof(one));
+    }
+}
+
+void AggregationServer::process(Connection& c, std::string& chunk, bool at_end) {
+    using Kind = Connection::Kind;
+    if (c.kind == Kind::Unknown) {
+        c.head.append(chunk);
+        chunk.clear();
+        const auto nl = c.head.find('\n');
+        if (nl == std::string::npos && c.head.size() < MAX_REQUEST_LINE && !at_end) return;
+
+        const std::string_view first = std::string_view{c.head}.substr(0, nl);
+        if (first.starts_with(REPORT_REQUEST) &&
+            (first.size() == REPORT_REQUEST.size() || first[REPORT_REQUEST.size()] == ' ')) {
+            c.kind = Kind::Report;
+            send_report(c.fd, trim(first.substr(REPORT_REQUEST.size())));
+            return;
+        }
+        const auto text = c.head.find_first_not_of(" \t\r\n\v\f");
+        c.kind = options_.xml_input || (text != std::string::npos && c.head[text] == '<') ? Kind::Xml : Kind::Text;
+        // Stream mode delivers the blocks at the end of input, counts final.
+        c.run = std::make_unique<LogProcessor>(options_, [this, &c](std::size_t index, std::string_view block) {
+            aggregate_.merge(c.run->blocks(), index, block);
+        });
+        if (c.kind == Kind::Text) chunk.swap(c.head);
+    }
+
+    if (c.kind == Kind::Text) {
+        c.run->feed_run(chunk);
+        if (at_end) c.run->end_of_input();
+    } else if (c.kind == Kind::Xml) {
+        c.head.append(chunk);
+        if (at_end) {
+            std::istringstream in(std::move(c.head));
+            c.run->process_xml(in);
+        }
+    }
+}
+
+void AggregationServer::send_report(int fd, std::string_view request) const {
+    OutputFormat format = options_.format;
+    try {
+        if (!request.empty()) format = parse_output_format(request);
+    } catch (const std::runtime_error& e) {
+        send_all(fd, std::string(ERROR_REPLY).append(e.what()).append("\n"));
+        return;
+    }
+    std::ostringstream report;
+    aggregate_.write_report(report, format);
+    send_all(fd, report.view());
+}
+
+void query_server(std::string_view socket_path, OutputFormat format, std::ostream& os) {
+    const std::string path{socket_path};
+    const int fd = connect_to(socket_address(path));
+    if (fd < 0) throw_errno("connect", path);
+
+    std::string reply;
+    try {
+        send_all(fd, std::string(REPORT_REQUEST).append(" ").append(output_format_name(format)).append("\n"));
+        ::shutdown(fd, SHUT_WR);
+        std::string chunk(READ_CHUNK_BYTES, '\0');
+        while (const auto n = read_some(fd, chunk.data(), chunk.size())) reply.append(chunk, 0, n);
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    ::close(fd);
+
+    if (std::string_view{reply}.starts_with(ERROR_REPLY)) {
+        throw std::runtime_error(std::string(trim(std::string_view{reply}.substr(ERROR_REPLY.size()))));
+    }
+    os << reply;
+    os.flush();
+}
@@ -0,0 +1,112 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include "block_kind.h"
+
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace {
+
+// Checked in order; the first key found in the start line decides the kind.
+constexpr std::array<std::pair<std::string_view, BlockKind>, 10> START_KEYS{{
+    {"Invalid read",         BlockKind::InvalidRead},
+    {"Invalid write",        BlockKind::InvalidWrite},
+    {"Syscall param",        BlockKind::SyscallParam},
+    {"Use of uninitialised", BlockKind::Uninitialised},
+    {"Conditional jump",     BlockKind::Uninitialised},
+    {"definitely lost",      BlockKind::DefinitelyLost},
+    {"indirectly lost",      BlockKind::IndirectlyLost},
+    {"possibly lost",        BlockKind::PossiblyLost},
+    {"still reachable",      BlockKind::StillReachable},
+    {"Process terminating",  BlockKind::Fatal},
+}};
+
+// XML <kind> values of Memcheck, Helgrind and DRD; everything else (InvalidFree,
+// Overlap, ...) is Other, as their text start lines are.
+constexpr std::array<std::pair<std::string_view, BlockKind>, 27> XML_KINDS{{
+    {"InvalidRead",         BlockKind::InvalidRead},
+    {"InvalidWrite",        BlockKind::InvalidWrite},
+    {"SyscallParam",        BlockKind::SyscallParam},
+    {"UninitValue",         BlockKind::Uninitialised},
+    {"UninitCondition",     BlockKind::Uninitialised},
+    {"Leak_DefinitelyLost", BlockKind::DefinitelyLost},
+    {"Leak_IndirectlyLost", BlockKind::IndirectlyLost},
+    {"Leak_PossiblyLost",   BlockKind::PossiblyLost},
+    {"Leak_StillReachable", BlockKind::StillReachable},
+    {"Race",                BlockKind::DataRace},
+    {"ConflictingAccess",   BlockKind::DataRace},
+    {"LockOrder",           BlockKind::LockOrder},
+    {"UnlockUnlocked",      BlockKind::ThreadApi},
+    {"UnlockForeign",       BlockKind::ThreadApi},
+    {"UnlockBogus",         BlockKind::ThreadApi},
+    {"PthAPIerror",         BlockKind::ThreadApi},
+    {"Misc",                BlockKind::ThreadApi},
+    {"MutexErr",            BlockKind::ThreadApi},
+    {"CondErr",             BlockKind::ThreadApi},
+    {"CondDestrErr",        BlockKind::ThreadApi},
+    {"CondRaceErr",         BlockKind::ThreadApi},
+    {"CondWaitErr",         BlockKind::ThreadApi},
+    {"SemaphoreErr",        BlockKind::ThreadApi},
+    {"BarrierErr",          BlockKind::ThreadApi},
+    {"RwlockErr",           BlockKind::ThreadApi},
+    {"HoldtimeErr",         BlockKind::ThreadApi},
+    {"InvalidThreadId",     BlockKind::ThreadApi},
+}};
+
+constexpr std::array<std::string_view, BLOCK_KIND_COUNT> KIND_NAMES{
+    "other", "invalid-read", "invalid-write", "syscall-param", "uninitialised",
+    "definitely-lost", "indirectly-lost", "possibly-lost", "still-reachable", "fatal",
+    "data-race", "lock-order", "thread-api",
+};
+
+} // namespace
+
+BlockKind classify_block(std::string_view start_line) noexcept {
+    for (const auto& [key, kind] : START_KEYS) {
+        if (start_line.find(key) != std::string_view::npos) return kind;
+    }
+    return BlockKind::Other;
+}
+
+BlockKind classify_xml_kind(std::string_view kind) noexcept {
+    for (const auto& [name, k] : XML_KINDS) {
+        if (kind == name) return k;
+    }
+    return BlockKind::Other;
+}
+
+std::string_view block_kind_name(BlockKind k) noexcept {
+    const auto i = static_cast<std::size_t>(k);
+    return i < KIND_NAMES.size() ? KIND_NAMES[i] : KIND_NAMES[0];
+}
+
+BlockKindMask parse_block_kinds(std::string_view list) {
+    BlockKindMask mask = 0;
+    while (!list.empty()) {
+        const auto comma = list.find(',');
+        const auto name  = list.substr(0, comma);
+        list.remove_prefix(comma == std::string_view::npos ? list.size() : comma + 1);
+
+        if (name == "any") {
+            for (std::size_t i = 1; i < KIND_NAMES.size(); ++i) mask |= kind_bit(static_cast<BlockKind>(i));
+            continue;
+        }
+        bool known = false;
+        for (std::size_t i = 0; i < KIND_NAMES.size(); ++i) {
+            if (KIND_NAMES[i] == name) {
+                mask |= kind_bit(static_cast<BlockKind>(i));
+                known = true;
+            }
+        }
+        if (!known) throw std::runtime_error("Unknown block kind: '" + std::string{name} + "'");
+    }
+    if (mask == 0) throw std::runtime_error("Block kind list cannot be empty");
+    return mask;
+}
@@ -0,0 +1,202 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include "block_store.h"
+
+#include <stdexcept>
+
+namespace {
+
+constexpr bool is_digit(char c) noexcept { return c >= '0' && c <= '9'; }
+
+// Decimal number with Valgrind's thousands separators ("1,024"); stops at the
+// first other character. Returns 0 when `sv` does not start with a digit.
+[[nodiscard]] std::uint64_t parse_count(std::string_view sv) noexcept {
+    std::uint64_t value = 0;
+    for (const char c : sv) {
+        if (is_digit(c)) value = value * 10 + static_cast<std::uint64_t>(c - '0');
+        else if (c != ',') break;
+    }
+    return value;
+}
+
+[[nodiscard]] std::string_view trim_left(std::string_view sv) noexcept {
+    const auto first = sv.find_first_not_of(" \t");
+    return first == std::string_view::npos ? std::string_view{} : sv.substr(first);
+}
+
+} // namespace
+
+std::uint32_t StringTable::intern(std::string_view s) {
+    if (s.empty()) return 0;
+    if (const auto it = ids_.find(s); it != ids_.end()) return it->second;
+    if (strings_.size() >= std::numeric_limits<std::uint32_t>::max() - 1) {
+        throw std::runtime_error("Too many distinct strings in block records");
+    }
+    const auto id = static_cast<std::uint32_t>(strings_.size() + 1);
+    ids_.emplace(strings_.emplace_back(s), id);
+    return id;
+}
+
+void StringTable::clear() noexcept {
+    ids_.clear();
+    strings_.clear();
+}
+
+std::optional<FrameText> parse_frame(std::string_view line) noexcept {
+    line = trim_left(line);
+    if (!line.starts_with("at ") && !line.starts_with("by ")) return std::nullopt;
+    line.remove_prefix(3);
+    if (line.starts_with("0x")) {
+        const auto colon = line.find(": ");
+        if (colon == std::string_view::npos) return std::nullopt;
+        line.remove_prefix(colon + 2);
+    }
+
+    FrameText f;
+    f.function = line;
+    // The location is the last parenthesized group; function names may hold
+    // their own parentheses ("operator()(int)", "(below main)").
+    const auto open = line.rfind(" (");
+    if (open == std::string_view::npos || !line.ends_with(')')) return f;
+    const std::string_view loc = line.substr(open + 2, line.size() - open - 3);
+    f.function = line.substr(0, open);
+    if (loc.starts_with("in ")) {
+        f.object = loc.substr(3);
+    } else if (const auto colon = loc.rfind(':');
+               colon != std::string_view::npos && colon + 1 < loc.size() && is_digit(loc[colon + 1])) {
+        f.file = loc.substr(0, colon);
+        f.line = static_cast<std::uint32_t>(parse_count(loc.substr(colon + 1)));
+    } else {
+        f.file = loc;
+    }
+    return f;
+}
+
+HeaderCounts parse_header_counts(std::string_view line) noexcept {
+    HeaderCounts c;
+    line = trim_left(line);
+    if (const auto in = line.find(" bytes in "); in != std::string_view::npos) {
+        c.bytes       = parse_count(line);
+        c.heap_blocks = parse_count(line.substr(in + 10));
+    } else if (const auto size = line.find(" of size "); size != std::string_view::npos) {
+        c.bytes = parse_count(line.substr(size + 9));
+    }
+    return c;
+}
+
+std::uint32_t BlockStore::add(BlockKind kind, std::uint64_t fingerprint, std::string_view header,
+                              HeaderCounts counts) {
+    const auto index = static_cast<std::uint32_t>(kinds_.size());
+    if (index == npos) throw std::runtime_error("Too many unique blocks");
+    kinds_.push_back(kind);
+    fingerprints_.push_back(fingerprint);
+    headers_.push_back(strings_.intern(header));
+    bytes_.push_back(counts.bytes);
+    heap_blocks_.push_back(counts.heap_blocks);
+    occurrences_.push_back(1);
+    frame_end_.push_back(static_cast<std::uint32_t>(frames_.size()));
+    stack_end_.push_back(frame_end_.back());
+    stack_open_  = true;
+    after_frame_ = false;
+    other_end_.push_back(static_cast<std::uint32_t>(others_.size()));
+    return index;
+}
+
+void BlockStore::add_line(std::string_view line) {
+    const auto f = parse_frame(line);
+    if (!f) {
+        // Lines before the first frame (the header, "Locks held: …") do not end it.
+        if (stack_end_.back() != frame_begin(stack_end_.size() - 1)) stack_open_ = false;
+        // The next stack is named by the line right after a run of frames, not
+        // by a "Locks held: …" closer to it.
+        if (after_frame_) message_.assign(line);
+        after_frame_ = false;
+        return;
+    }
+    if (!stack_open_ && !after_frame_) {
+        const auto at = static_cast<std::uint32_t>(frames_.size());
+        others_.push_back({strings_.intern(message_), at, at});
+        other_end_.back() = static_cast<std::uint32_t>(others_.size());
+    }
+    frames_.push_back({strings_.intern(f->function), strings_.intern(f->file), f->line, strings_.intern(f->object)});
+    frame_end_.back() = static_cast<std::uint32_t>(frames_.size());
+    if (stack_open_) stack_end_.back() = frame_end_.back();
+    else             others_.back().end = frame_end_.back();
+    after_frame_ = true;
+}
+
+void BlockStore::add_occurrence(std::uint32_t index, HeaderCounts counts) noexcept {
+    bytes_[index]       += counts.bytes;
+    heap_blocks_[index] += counts.heap_blocks;
+    ++occurrences_[index];
+}
+
+std::uint32_t BlockStore::append(const BlockStore& from, std::size_t i) {
+    const std::uint32_t index = add(from.kind(i), from.fingerprint(i), from.header(i),
+                                    {from.bytes(i), from.heap_blocks(i)});
+    occurrences_[index] = from.occurrences(i);
+    const StringTable& names = from.strings();
+    const auto         stack = from.stack(i).size();
+    for (const Frame& f : from.frames(i)) {
+        frames_.push_back({strings_.intern(names[f.function]), strings_.intern(names[f.file]), f.line,
+                           strings_.intern(names[f.object])});
+    }
+    frame_end_[index] = static_cast<std::uint32_t>(frames_.size());
+    stack_end_[index] = frame_begin(index) + static_cast<std::uint32_t>(stack);
+    stack_open_       = false;
+    after_frame_      = true; // further add_line() calls start no stack
+    const auto first  = from.frames(i).data();
+    for (const OtherStack& o : from.other_stacks(i)) {
+        const auto begin = frame_begin(index) + static_cast<std::uint32_t>(from.frames(o).data() - first);
+        others_.push_back({strings_.intern(names[o.message]), begin,
+                           begin + static_cast<std::uint32_t>(from.frames(o).size())});
+    }
+    other_end_[index] = static_cast<std::uint32_t>(others_.size());
+    return index;
+}
+
+void BlockStore::add_counts(std::uint32_t index, const BlockStore& from, std::size_t i) noexcept {
+    bytes_[index]       += from.bytes(i);
+    heap_blocks_[index] += from.heap_blocks(i);
+    occurrences_[index] += from.occurrences(i);
+}
+
+std::span<const Frame> BlockStore::frames(std::size_t i) const noexcept {
+    return std::span<const Frame>{frames_}.subspan(frame_begin(i), frame_end_[i] - frame_begin(i));
+}
+
+std::span<const Frame> BlockStore::stack(std::size_t i) const noexcept {
+    return std::span<const Frame>{frames_}.subspan(frame_begin(i), stack_end_[i] - frame_begin(i));
+}
+
+std::span<const OtherStack> BlockStore::other_stacks(std::size_t i) const noexcept {
+    const std::uint32_t begin = i == 0 ? 0 : other_end_[i - 1];
+    return std::span<const OtherStack>{others_}.subspan(begin, other_end_[i] - begin);
+}
+
+std::span<const Frame> BlockStore::frames(const OtherStack& s) const noexcept {
+    return std::span<const Frame>{frames_}.subspan(s.begin, s.end - s.begin);
+}
+
+void BlockStore::clear() noexcept {
+    kinds_.clear();
+    fingerprints_.clear();
+    headers_.clear();
+    bytes_.clear();
+    heap_blocks_.clear();
+    occurrences_.clear();
+    frame_end_.clear();
+    stack_end_.clear();
+    stack_open_  = false;
+    after_frame_ = false;
+    other_end_.clear();
+    others_.clear();
+    message_.clear();
+    frames_.clear();
+    strings_.clear();
+}
@@ -0,0 +1,416 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include "canon_rules.h"
+
+#include "canonicalization.h"
+#include "path_validation.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cctype>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace canonicalization {
+
+namespace {
+
+constexpr std::size_t MAX_RULES      = 4096u;
+constexpr std::size_t MAX_DFA_STATES = 4096u;
+constexpr std::size_t ALPHABET = 256u;
+
+using ByteSet = std::bitset<ALPHABET>;
+
+enum class Repeat : std::uint8_t { One, Optional, Star };
+
+struct Atom {
+    ByteSet cls;
+    Repeat  rep{Repeat::One};
+};
+
+[[nodiscard]] std::runtime_error rule_error(std::size_t line_no, std::string_view what) {
+    return std::runtime_error("Canon rules line " + std::to_string(line_no) + ": " + std::string{what});
+}
+
+[[nodiscard]] ByteSet make_set(bool (*pred)(int)) {
+    ByteSet s;
+    for (std::size_t b = 0; b < ALPHABET; ++b) {
+        if (pred(static_cast<int>(b))) s.set(b);
+    }
+    return s;
+}
+
+[[nodiscard]] bool is_digit_byte(int b) { return std::isdigit(b) != 0; }
+[[nodiscard]] bool is_word_byte(int b)  { return std::isalnum(b) != 0 || b == '_'; }
+[[nodiscard]] bool is_space_byte(int b) { return std::isspace(b) != 0; }
+
+// Shorthand classes (\d, \w, \s); returns false for a plain escaped literal.
+[[nodiscard]] bool shorthand_class(char c, ByteSet& out) {
+    switch (c) {
+        case 'd': out |= make_set(is_digit_byte); return true;
+        case 'w': out |= make_set(is_word_byte);  return true;
+        case 's': out |= make_set(is_space_byte); return true;
+        default:  return false;
+    }
+}
+
+[[nodiscard]] ByteSet parse_class(std::string_view p, std::size_t& i, std::size_t line_no) {
+    // p[i] is the character after '['
+    ByteSet set;
+    bool negate = false;
+    if (i < p.size() && p[i] == '^') { negate = true; ++i; }
+    bool first = true;
+    while (i < p.size() && (p[i] != ']' || first)) {
+        first = false;
+        auto lo = static_cast<unsigned char>(p[i]);
+        if (p[i] == '\\') {
+            if (++i >= p.size()) throw rule_error(line_no, "dangling '\\' in character class");
+            if (shorthand_class(p[i], set)) { ++i; continue; }
+            lo = static_cast<unsigned char>(p[i]);
+        }
+        ++i;
+        if (i + 1 < p.size() && p[i] == '-' && p[i + 1] != ']') {
+            auto hi = static_cast<unsigned char>(p[i + 1]);
+            if (p[i + 1] == '\\') {
+                if (i + 2 >= p.size()) throw rule_error(line_no, "dangling '\\' in character class");
+                hi = static_cast<unsigned char>(p[i + 2]);
+                ++i;
+            }
+            i += 2;
+            if (hi < lo) throw rule_error(line_no, "reversed range in character class");
+            for (unsigned b = lo; b <= hi; ++b) set.set(b);
+        } else {
+            set.set(lo);
+        }
+    }
+    if (i >= p.size()) throw rule_error(line_no, "unterminated character class");
+    ++i; // ']'
+    return negate ? ~set : set;
+}
+
+[[nodiscard]] std::vector<Atom> parse_pattern(std::string_view p, std::size_t line_no) {
+    std::vector<Atom> atoms;
+    std::size_t i = 0;
+    while (i < p.size()) {
+        const char c = p[i];
+        if (c == '*' || c == '+' || c == '?') {
+            if (atoms.empty() || atoms.back().rep != Repeat::One) {
+                throw rule_error(line_no, std::string{"'"} + c + "' has nothing to repeat");
+            }
+            if (c == '*') atoms.back().rep = Repeat::Star;
+            if (c == '?') atoms.back().rep = Repeat::Optional;
+            if (c == '+') atoms.push_back({atoms.back().cls, Repeat::Star}); // x+ == xx*
+            ++i;
+            continue;
+        }
+
+        Atom atom;
+        if (c == '.') {
+            atom.cls.set();
+            ++i;
+        } else if (c == '[') {
+            ++i;
+            atom.cls = parse_class(p, i, line_no);
+        } else if (c == '\\') {
+            if (++i >= p.size()) throw rule_error(line_no, "dangling '\\' at end of pattern");
+            if (!shorthand_class(p[i], atom.cls)) atom.cls.set(static_cast<unsigned char>(p[i]));
+            ++i;
+        } else {
+            atom.cls.set(static_cast<unsigned char>(c));
+            ++i;
+        }
+        atoms.push_back(atom);
+    }
+    return atoms;
+}
+
+// Subset construction over the union of all rule NFAs. A rule with atoms
+// a[0..n) has NFA positions 0..n; position n accepts.
+class DfaBuilder {
+public:
+    explicit DfaBuilder(const std::vector<std::vector<Atom>>& rules) : rules_(rules) {
+        for (std::size_t r = 0; r < rules_.size(); ++r) {
+            base_.push_back(static_cast<std::uint32_t>(rule_of_.size()));
+            for (std::size_t pos = 0; pos <= rules_[r].size(); ++pos) {
+                rule_of_.push_back(static_cast<std::uint32_t>(r));
+                pos_of_.push_back(static_cast<std::uint32_t>(pos));
+            }
+        }
+        build_byte_classes();
+    }
+
+    void build(std::vector<std::int32_t>& table, std::vector<std::int32_t>& accept) {
+        std::vector<std::uint32_t> start;
+        for (auto b : base_) start.push_back(b);
+        intern(closure(std::move(start)));
+
+        for (std::size_t d = 0; d < states_.size(); ++d) {
+            table.resize((d + 1) * ALPHABET, -1);
+            std::vector<std::int32_t> by_class(class_rep_.size(), -1);
+            for (std::size_t k = 0; k < class_rep_.size(); ++k) {
+                auto next = step(states_[d], class_rep_[k]);
+                if (!next.empty()) by_class[k] = intern(closure(std::move(next)));
+            }
+            for (std::size_t b = 0; b < ALPHABET; ++b) {
+                table[d * ALPHABET + b] = by_class[byte_class_[b]];
+            }
+        }
+
+        accept.assign(states_.size(), -1);
+        for (std::size_t d = 0; d < states_.size(); ++d) {
+            for (auto s : states_[d]) {
+                if (pos_of_[s] == rules_[rule_of_[s]].size()) {
+                    const auto r = static_cast<std::int32_t>(rule_of_[s]);
+                    if (accept[d] < 0 || r < accept[d]) accept[d] = r;
+                }
+            }
+        }
+    }
+
+private:
+    // Bytes no atom class tells apart share one column computation.
+    void build_byte_classes() {
+        std::map<std::vector<bool>, std::size_t> ids;
+        for (std::size_t b = 0; b < ALPHABET; ++b) {
+            std::vector<bool> key;
+            for (const auto& rule : rules_) {
+                for (const auto& a : rule) key.push_back(a.cls.test(b));
+            }
+            auto [it, inserted] = ids.emplace(std::move(key), class_rep_.size());
+            if (inserted) class_rep_.push_back(b);
+            byte_class_[b] = it->second;
+        }
+    }
+
+    [[nodiscard]] std::vector<std::uint32_t> closure(std::vector<std::uint32_t> set) const {
+        for (std::size_t i = 0; i < set.size(); ++i) {
+            const auto s = set[i];
+            const auto& atoms = rules_[rule_of_[s]];
+            if (pos_of_[s] < atoms.size() && atoms[pos_of_[s]].rep != Repeat::One) {
+                if (std::find(set.begin(), set.end(), s + 1) == set.end()) set.push_back(s + 1);
+            }
+        }
+        std::sort(set.begin(), set.end());
+        return set;
+    }
+
+    [[nodiscard]] std::vector<std::uint32_t> step(const std::vector<std::uint32_t>& set, std::size_t byte) const {
+        std::vector<std::uint32_t> next;
+        for (auto s : set) {
+            const auto& atoms = rules_[rule_of_[s]];
+            const auto pos = pos_of_[s];
+            if (pos >= atoms.size() || !atoms[pos].cls.test(byte)) continue;
+            const auto target = atoms[pos].rep == Repeat::Star ? s : s + 1;
+            if (std::find(next.begin(), next.end(), target) == next.end()) next.push_back(target);
+        }
+        return next;
+    }
+
+    std::int32_t intern(std::vector<std::uint32_t> set) {
+        auto it = ids_.find(set);
+        if (it != ids_.end()) return it->second;
+        if (states_.size() >= MAX_DFA_STATES) {
+            throw std::runtime_error("Canon rules too complex (DFA exceeds " +
+                                     std::to_string(MAX_DFA_STATES) + " states)");
+        }
+        const auto id = static_cast<std::int32_t>(states_.size());
+        ids_.emplace(set, id);
+        states_.push_back(std::move(set));
+        return id;
+    }
+
+    const std::vector<std::vector<Atom>>& rules_;
+    std::vector<std::uint32_t> base_;
+    std::vector<std::uint32_t> rule_of_;
+    std::vector<std::uint32_t> pos_of_;
+    std::array<std::size_t, ALPHABET> byte_class_{};
+    std::vector<std::size_t> class_rep_;
+    std::map<std::vector<std::uint32_t>, std::int32_t> ids_;
+    std::vector<std::vector<std::uint32_t>> states_;
+};
+
+// Subset construction over the reversed forward DFA. Reading a line backwards
+// from its end, the state reached before byte p is the set of forward states
+// from which some match ends at or after p: every accepting state, plus the
+// states whose transition on line[p] lands in the set for p + 1.
+class ReverseBuilder {
+public:
+    ReverseBuilder(const std::vector<std::int32_t>& table, const std::vector<std::int32_t>& accept)
+        : table_(table), accept_(accept), words_((accept.size() + 63) / 64) {
+        // Bytes with the same forward column behave the same backwards.
+        std::map<std::vector<std::int32_t>, std::size_t> ids;
+        for (std::size_t b = 0; b < ALPHABET; ++b) {
+            std::vector<std::int32_t> column(accept_.size());
+            for (std::size_t q = 0; q < accept_.size(); ++q) column[q] = table_[q * ALPHABET + b];
+            auto [it, inserted] = ids.emplace(std::move(column), class_rep_.size());
+            if (inserted) class_rep_.push_back(b);
+            byte_class_[b] = it->second;
+        }
+    }
+
+    // Returns the id of the state before the end of a line.
+    std::int32_t build(std::vector<std::int32_t>& table, std::vector<std::uint64_t>& live) {
+        Bits accepting(words_, 0);
+        for (std::size_t q = 0; q < accept_.size(); ++q) {
+            if (accept_[q] >= 0) set(accepting, q);
+        }
+        const std::int32_t end = intern(accepting);
+
+        for (std::size_t r = 0; r < states_.size(); ++r) {
+            table.resize((r + 1) * ALPHABET);
+            std::vector<std::int32_t> by_class(class_rep_.size());
+            for (std::size_t k = 0; k < class_rep_.size(); ++k) {
+                Bits prev = accepting;
+                for (std::size_t q = 0; q < accept_.size(); ++q) {
+                    const auto t = table_[q * ALPHABET + class_rep_[k]];
+                    if (t >= 0 && test(states_[r], static_cast<std::size_t>(t))) set(prev, q);
+                }
+                by_class[k] = intern(std::move(prev));
+            }
+            for (std::size_t b = 0; b < ALPHABET; ++b) table[r * ALPHABET + b] = by_class[byte_class_[b]];
+        }
+
+        live.clear();
+        for (const auto& s : states_) live.insert(live.end(), s.begin(), s.end());
+        return end;
+    }
+
+private:
+    using Bits = std::vector<std::uint64_t>;
+
+    static void set(Bits& s, std::size_t q) { s[q / 64] |= std::uint64_t{1} << (q % 64); }
+    [[nodiscard]] static bool test(const Bits& s, std::size_t q) { return ((s[q / 64] >> (q % 64)) & 1u) != 0; }
+
+    std::int32_t intern(Bits set) {
+        auto it = ids_.find(set);
+        if (it != ids_.end()) return it->second;
+        if (states_.size() >= MAX_DFA_STATES) {
+            throw std::runtime_error("Canon rules too complex (reverse DFA exceeds " +
+                                     std::to_string(MAX_DFA_STATES) + " states)");
+        }
+        const auto id = static_cast<std::int32_t>(states_.size());
+        ids_.emplace(set, id);
+        states_.push_back(std::move(set));
+        return id;
+    }
+
+    const std::vector<std::int32_t>& table_;
+    const std::vector<std::int32_t>& accept_;
+    std::size_t words_;
+    std::array<std::size_t, ALPHABET> byte_class_{};
+    std::vector<std::size_t> class_rep_;
+    std::map<Bits, std::int32_t> ids_;
+    std::vector<Bits> states_;
+};
+
+} // namespace
+
+RuleSet RuleSet::parse(std::string_view text) {
+    RuleSet rs;
+    std::vector<std::vector<Atom>> rules;
+    std::vector<std::size_t> line_numbers;
+
+    std::size_t line_no = 0;
+    while (!text.empty()) {
+        const auto nl = text.find('\n');
+        const auto line = trim_view(text.substr(0, nl));
+        text = nl == std::string_view::npos ? std::string_view{} : text.substr(nl + 1);
+        ++line_no;
+
+        if (line.empty() || line.front() == '#') continue;
+
+        const auto arrow = line.find("=>");
+        if (arrow == std::string_view::npos) throw rule_error(line_no, "missing '=>'");
+        const auto pattern = trim_view(line.substr(0, arrow));
+        if (pattern.empty()) throw rule_error(line_no, "empty pattern");
+        if (rules.size() >= MAX_RULES) {
+            throw rule_error(line_no, "too many rules (max " + std::to_string(MAX_RULES) + ")");
+        }
+
+        rules.push_back(parse_pattern(pattern, line_no));
+        line_numbers.push_back(line_no);
+        rs.replacements.emplace_back(trim_view(line.substr(arrow + 2)));
+    }
+
+    if (rules.empty()) return rs;
+
+    DfaBuilder(rules).build(rs.table, rs.accept);
+    if (rs.accept[0] != DEAD) {
+        throw rule_error(line_numbers[static_cast<std::size_t>(rs.accept[0])], "pattern matches the empty string");
+    }
+    rs.live_words = (rs.accept.size() + 63) / 64;
+    rs.reverse_end = ReverseBuilder(rs.table, rs.accept).build(rs.reverse, rs.live);
+    return rs;
+}
+
+RuleSet RuleSet::load(std::string_view filename) {
+    auto ifs = path_validation::safe_ifstream(filename);
+    std::ostringstream ss;
+    ss << ifs.rdbuf();
+    return parse(ss.str());
+}
+
+std::string RuleSet::apply(std::string_view line) const {
+    std::string out;
+    apply(line, out);
+    return out;
+}
+
+bool RuleSet::live_at(std::int32_t reverse_state, std::int32_t state) const noexcept {
+    const auto q = static_cast<std::size_t>(state);
+    return ((live[static_cast<std::size_t>(reverse_state) * live_words + q / 64] >> (q % 64)) & 1u) != 0;
+}
+
+void RuleSet::apply(std::string_view line, std::string& out) const {
+    if (empty()) {
+        out.assign(line);
+        return;
+    }
+    out.clear();
+    out.reserve(line.size());
+
+    // Backward pass: ends[p] tells which forward states can still reach a
+    // match in line[p..]. A match starts at p iff the start state can.
+    ends.resize(line.size() + 1);
+    ends[line.size()] = reverse_end;
+    for (std::size_t p = line.size(); p-- > 0;) {
+        ends[p] = reverse[static_cast<std::size_t>(ends[p + 1]) * ALPHABET + static_cast<unsigned char>(line[p])];
+    }
+
+    // Forward pass: from each match start, the DFA runs only while a longer
+    // match is still possible, so it stops one byte past the longest one and
+    // every byte is stepped over at most twice.
+    std::size_t i = 0;
+    while (i < line.size()) {
+        if (!live_at(ends[i], 0)) {
+            out.push_back(line[i++]);
+            continue;
+        }
+
+        std::int32_t state     = 0;
+        std::int32_t best_rule = DEAD;
+        std::size_t  best_end  = i;
+        for (std::size_t j = i; j < line.size();) {
+            state = table[static_cast<std::size_t>(state) * ALPHABET + static_cast<unsigned char>(line[j++])];
+            ++forward_steps_;
+            if (state == DEAD || !live_at(ends[j], state)) break;
+            if (accept[static_cast<std::size_t>(state)] != DEAD) {
+                best_rule = accept[static_cast<std::size_t>(state)];
+                best_end  = j;
+            }
+        }
+        out.append(replacements[static_cast<std::size_t>(best_rule)]);
+        i = best_end;
+    }
+}
+
+} // namespace canonicalization
@@ -28,7 +28,7 @@ constexpr bool is_xdigit(char c) noexcept {
 }
 
 // Simple string replacement functions to replace regex
-Str replace_addr_pattern(Str s) {
+void replace_addr_pattern(Str& s) {
     // Replace 0x[0-9a-fA-F]+ with 0xADDR
     size_t pos = 0;
     while ((pos = s.find("0x", pos)) != std::string::npos) {
@@ -45,10 +45,9 @@ Str replace_addr_pattern(Str s) {
             pos = start + 6; // Skip the replacement
         }
     }
-    return s;
 }
 
-Str replace_line_pattern(Str s) {
+void replace_line_pattern(Str& s) {
     // Replace :[0-9]+ with :LINE
     size_t pos = 0;
     while ((pos = s.find(':', pos)) != std::string::npos) {
@@ -64,10 +63,9 @@ Str replace_line_pattern(Str s) {
             pos = start + 5; // Skip the replacement
         }
     }
-    return s;
 }
 
-Str replace_array_pattern(Str s) {
+void replace_array_pattern(Str& s) {
     // Replace [0-9]+ with []
     size_t pos = 0;
     while ((pos = s.find('[', pos)) != std::string::npos) {
@@ -83,45 +81,75 @@ Str replace_array_pattern(Str s) {
             pos = start + 2; // Skip the replacement
         }
     }
-    return s;
 }
 
-Str replace_template_pattern(Str s) {
-    // Replace <[^>]*> with <T>
-    size_t pos = 0;
-    while ((pos = s.find('<', pos)) != std::string::npos) {
-        const size_t start = pos++;
-        
-        // Find closing '>'
-        size_t j = pos;
-        while (j < s.size() && s[j] != '>') ++j;
-        
-        // Replace if we found closing '>'
-        if (j < s.size()) {
-            s.replace(start, j - start + 1, "<T>");
-            pos = start + 3; // Skip the replacement
+// Position of the '>' closing the template argument list opened at `open`,
+// counting nested lists, or npos if it is never closed.
+size_t matching_angle(StrView s, size_t open) noexcept {
+    size_t depth = 0;
+    for (size_t j = open; j < s.size(); ++j) {
+        if (s[j] == '<') {
+            ++depth;
+        } else if (s[j] == '>' && s[j - 1] != '-' && --depth == 0) {
+            return j;
         }
     }
-    return s;
+    return StrView::npos;
 }
 
-Str replace_ws_pattern(Str s) {
-    // Collapse runs of whitespace to a single space
+void replace_template_pattern(Str& s) {
+    // Replace each outermost <...> with <T>, nested lists included:
+    // "std::map<int, std::vector<Foo>>::at" → "std::map<T>::at"
+    size_t pos = s.find('<');
+    if (pos == std::string::npos) return;
+
     Str out;
     out.reserve(s.size());
+    size_t copied = 0;
+    while (pos != std::string::npos) {
+        // "operator<", "operator<<", "operator<=>" name an operator, not a template
+        if (StrView{s}.substr(0, pos).ends_with("operator")) {
+            pos = s.find_first_not_of("<=>", pos);
+            if (pos != std::string::npos) pos = s.find('<', pos);
+            continue;
+        }
+        const size_t close = matching_angle(s, pos);
+        if (close == StrView::npos) {
+            pos = s.find('<', pos + 1); // unbalanced: an inner list may still close
+            continue;
+        }
+        out.append(s, copied, pos - copied).append("<T>");
+        copied = close + 1;
+        pos    = s.find('<', copied);
+    }
+    if (copied == 0) return;
+    out.append(s, copied, std::string::npos);
+    s.swap(out);
+}
+
+void replace_ws_pattern(Str& s) {
+    // Collapse runs of whitespace to a single space (output never outgrows input)
+    std::size_t out = 0;
     bool in_ws = false;
     for (char c : s) {
         if (is_space(c)) {
             if (!in_ws) {
-                out.push_back(' ');
+                s[out++] = ' ';
                 in_ws = true;
             }
         } else {
-            out.push_back(c);
+            s[out++] = c;
             in_ws = false;
         }
     }
-    return out;
+    s.resize(out);
+}
+
+void trim_in_place(Str& s) {
+    const StrView t = trim_view(s);
+    const auto start = static_cast<std::size_t>(t.data() - s.data());
+    s.resize(start + t.size());
+    s.erase(0, start);
 }
 
 } // namespace
@@ -132,16 +160,19 @@ Str rtrim(Str s) {
     return s;
 }
 
-Str canon(Str s) {
+void canon_in_place(Str& s) {
     // Apply canonicalization transformations in sequence using string matching
-    s = replace_addr_pattern(std::move(s));
-    s = replace_line_pattern(std::move(s));
-    s = replace_array_pattern(std::move(s));
-    s = replace_template_pattern(std::move(s));
-    s = replace_ws_pattern(std::move(s));
-    
-    // Return trimmed result
-    return Str(trim_view(s));
+    replace_addr_pattern(s);
+    replace_line_pattern(s);
+    replace_array_pattern(s);
+    replace_template_pattern(s);
+    replace_ws_pattern(s);
+    trim_in_place(s);
+}
+
+Str canon(Str s) {
+    canon_in_place(s);
+    return s;
 }
 
 Str canon(StrView s) {
@@ -0,0 +1,225 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include "checkpoint.h"
+
+#include "file_utils.h"
+#include "log_processor.h"
+#include "path_validation.h"
+
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <type_traits>
+
+namespace {
+
+// Layout (host byte order; a state file is not meant to move between machines):
+//   "VGLFSTAT" u32 version, u64 settings, device, inode, offset, u8 marker_found,
+//   u8 tool, u32 tool_probe_left,
+//   u64 n + n×u64 seen, u64 n open blocks, each:
+//     u32 pid, u8 kind, u64 begin, end, sig_lines,
+//     u64 n + head bytes, u64 n + sig bytes, u64 n + text bytes, u64 n + n×u32 line lengths
+inline constexpr std::string_view STATE_MAGIC   = "VGLFSTAT";
+inline constexpr std::uint32_t    STATE_VERSION = 5;
+// Changed whenever canonicalization keys blocks differently, so a state saved
+// by an older build starts over instead of deduping against stale signatures.
+inline constexpr std::string_view SIGNATURE_REVISION = "nested-templates,demangled";
+
+class Writer {
+public:
+    template <class T>
+    void put(T v) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        char raw[sizeof(T)];
+        std::memcpy(raw, &v, sizeof(T));
+        out.append(raw, sizeof(T));
+    }
+    void put_bytes(std::string_view s) {
+        put<std::uint64_t>(s.size());
+        out.append(s);
+    }
+    std::string out;
+};
+
+class Reader {
+public:
+    Reader(std::string_view data, std::string_view filename) : rest(data), name(filename) {}
+
+    template <class T>
+    T get() {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T v{};
+        std::memcpy(&v, take(sizeof(T)).data(), sizeof(T));
+        return v;
+    }
+    std::string_view get_bytes() { return take(get_count(1)); }
+    std::string_view take(std::size_t n) {
+        if (n > rest.size()) corrupt();
+        const auto s = rest.substr(0, n);
+        rest.remove_prefix(n);
+        return s;
+    }
+    std::uint64_t get_count(std::size_t element_size) {
+        const auto n = get<std::uint64_t>();
+        if (n > rest.size() / element_size) corrupt();
+        return n;
+    }
+    [[nodiscard]] bool done() const noexcept { return rest.empty(); }
+    [[noreturn]] void corrupt() const {
+        throw std::runtime_error(create_error_message("state load", name, "file is truncated or corrupt"));
+    }
+
+private:
+    std::string_view rest;
+    std::string_view name;
+};
+
+// Chains the contents of `filename` into `h`: an edited file counts as a
+// change even under the same name, and a renamed one does not.
+std::uint64_t fingerprint_file(const std::string& filename, std::uint64_t h) {
+    auto ifs = path_validation::safe_ifstream(filename);
+    return fingerprint(std::string{std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>()}, h);
+}
+
+} // namespace
+
+std::uint64_t signature_settings(const Options& opt) {
+    std::uint64_t h = fingerprint(SIGNATURE_REVISION);
+    if (!opt.canon_rules_file.empty()) h = fingerprint_file(opt.canon_rules_file, h);
+    return h;
+}
+
+std::uint64_t checkpoint_settings(const Options& opt) {
+    // Everything that changes a block's signature or where epochs start
+    std::uint64_t h = fingerprint(opt.marker, signature_settings(opt));
+    for (const auto& f : opt.suppress_files) h = fingerprint_file(f, h);
+    h = fingerprint(std::to_string(opt.depth), h);
+    return fingerprint(opt.trim ? "trim" : "keep", h);
+}
+
+std::optional<Checkpoint> load_checkpoint(std::string_view filename) {
+    const auto path = path_validation::validate_and_canonicalize(filename);
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        if (!std::filesystem::exists(path)) return std::nullopt;
+        throw std::runtime_error(create_error_message("state load", filename, "cannot open file"));
+    }
+    const std::string data{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+
+    Reader r(data, filename);
+    Checkpoint cp;
+    if (r.take(STATE_MAGIC.size()) != STATE_MAGIC) r.corrupt();
+    if (r.get<std::uint32_t>() != STATE_VERSION) {
+        throw std::runtime_error(create_error_message("state load", filename, "unsupported state version"));
+    }
+    cp.settings     = r.get<std::uint64_t>();
+    cp.device       = r.get<std::uint64_t>();
+    cp.inode        = r.get<std::uint64_t>();
+    cp.offset       = r.get<std::uint64_t>();
+    cp.marker_found = r.get<std::uint8_t>() != 0;
+    cp.tool            = r.get<std::uint8_t>();
+    cp.tool_probe_left = r.get<std::uint32_t>();
+    cp.seen.resize(r.get_count(sizeof(std::uint64_t)));
+    for (auto& f : cp.seen) f = r.get<std::uint64_t>();
+    cp.open_blocks.resize(r.get_count(sizeof(std::uint32_t) + sizeof(std::uint8_t)));
+    for (auto& b : cp.open_blocks) {
+        b.pid       = r.get<std::uint32_t>();
+        b.kind      = r.get<std::uint8_t>();
+        b.begin     = r.get<std::uint64_t>();
+        b.end       = r.get<std::uint64_t>();
+        b.sig_lines = r.get<std::uint64_t>();
+        b.head.assign(r.get_bytes());
+        b.sig.assign(r.get_bytes());
+        b.text.assign(r.get_bytes());
+        b.line_lengths.resize(r.get_count(sizeof(std::uint32_t)));
+        std::uint64_t total = 0;
+        for (auto& n : b.line_lengths) total += (n = r.get<std::uint32_t>());
+        if (total != b.text.size()) r.corrupt();
+    }
+    if (!r.done()) r.corrupt();
+    return cp;
+}
+
+void save_checkpoint(std::string_view filename, const Checkpoint& cp) {
+    Writer w;
+    w.out.append(STATE_MAGIC);
+    w.put(STATE_VERSION);
+    w.put(cp.settings);
+    w.put(cp.device);
+    w.put(cp.inode);
+    w.put(cp.offset);
+    w.put<std::uint8_t>(cp.marker_found ? 1 : 0);
+    w.put(cp.tool);
+    w.put(cp.tool_probe_left);
+    w.put<std::uint64_t>(cp.seen.size());
+    for (const auto f : cp.seen) w.put(f);
+    w.put<std::uint64_t>(cp.open_blocks.size());
+    for (const auto& b : cp.open_blocks) {
+        w.put(b.pid);
+        w.put(b.kind);
+        w.put(b.begin);
+        w.put(b.end);
+        w.put(b.sig_lines);
+        w.put_bytes(b.head);
+        w.put_bytes(b.sig);
+        w.put_bytes(b.text);
+        w.put<std::uint64_t>(b.line_lengths.size());
+        for (const auto n : b.line_lengths) w.put(n);
+    }
+
+    const auto path = path_validation::validate_and_canonicalize(filename);
+    auto tmp = path;
+    tmp += ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        out.write(w.out.data(), static_cast<std::streamsize>(w.out.size()));
+        out.close();
+        if (!out) throw std::runtime_error(create_error_message("state save", filename, "write failed"));
+    }
+    std::filesystem::rename(tmp, path);
+}
+
+bool process_file_resumable(std::string_view fname, const Options& opt) {
+    if (fname.empty()) throw std::invalid_argument("Filename cannot be empty");
+    auto ifs = path_validation::safe_ifstream(fname);
+
+    const std::string path{path_validation::validate_and_canonicalize(fname).string()};
+    struct stat st{};
+    if (::stat(path.c_str(), &st) != 0) {
+        throw std::runtime_error(create_error_message("stat", fname, std::strerror(errno)));
+    }
+    const auto device = static_cast<std::uint64_t>(st.st_dev);
+    const auto inode  = static_cast<std::uint64_t>(st.st_ino);
+    const auto size   = static_cast<std::uint64_t>(st.st_size);
+
+    LogProcessor processor(opt);
+    if (auto cp = load_checkpoint(opt.state_file)) {
+        if (cp->device == device && cp->inode == inode && cp->offset <= size &&
+            cp->settings == checkpoint_settings(opt)) {
+            processor.restore(*cp);
+            ifs.seekg(static_cast<std::streamoff>(cp->offset));
+        } else {
+            std::cerr << "Info: State file '" << opt.state_file << "' does not match '" << fname
+                      << "' (rotated, truncated or different options); starting from the beginning\n";
+        }
+    }
+
+    processor.process_stream(ifs);
+
+    Checkpoint out = processor.checkpoint();
+    out.settings = checkpoint_settings(opt);
+    out.device   = device;
+    out.inode    = inode;
+    save_checkpoint(opt.state_file, out);
+    return processor.fail_on_match().has_value();
+}
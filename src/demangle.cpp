@@ -0,0 +1,62 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include "demangle.h"
+
+#include <cstdlib>
+#include <cxxabi.h>
+#include <memory>
+
+namespace {
+
+// Characters of a mangled name, clone suffixes (".constprop.0", ".cold") included.
+[[nodiscard]] constexpr bool is_symbol_char(char c) noexcept {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+           c == '_' || c == '.' || c == '$';
+}
+
+} // namespace
+
+const std::string& DemangleCache::demangle(std::string_view symbol) {
+    if (const auto it = cache_.find(symbol); it != cache_.end()) {
+        ++hits_;
+        return it->second;
+    }
+    const std::string name{symbol};
+    int status = 0;
+    const std::unique_ptr<char, decltype(&std::free)> demangled{
+        abi::__cxa_demangle(name.c_str(), nullptr, nullptr, &status), &std::free};
+    // Failures are cached too, so each symbol costs one attempt.
+    return cache_.try_emplace(name, status == 0 && demangled ? demangled.get() : name).first->second;
+}
+
+bool DemangleCache::demangle_line(std::string_view line, std::string& out) {
+    std::size_t pos = line.find("_Z");
+    if (pos == std::string_view::npos) return false;
+
+    std::size_t copied  = 0;
+    bool        changed = false;
+    for (; pos != std::string_view::npos; pos = line.find("_Z", pos)) {
+        if (pos > 0 && is_symbol_char(line[pos - 1])) {
+            pos += 2; // inside a word, not the start of a symbol
+            continue;
+        }
+        std::size_t end = pos + 2;
+        while (end < line.size() && is_symbol_char(line[end])) ++end;
+        const std::string_view symbol = line.substr(pos, end - pos);
+        const std::string&     name   = demangle(symbol);
+        if (name != symbol) {
+            if (!changed) out.clear();
+            out.append(line.substr(copied, pos - copied)).append(name);
+            copied  = end;
+            changed = true;
+        }
+        pos = end;
+    }
+    if (changed) out.append(line.substr(copied));
+    return changed;
+}
@@ -0,0 +1,210 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include "file_follower.h"
+
+#include "file_utils.h"
+#include "log_processor.h"
+#include "path_validation.h"
+
+#include <array>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <poll.h>
+#include <stdexcept>
+#include <sys/inotify.h>
+#include <sys/signalfd.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace {
+
+inline constexpr std::size_t READ_CHUNK_BYTES   = 64u * 1024u;
+inline constexpr std::size_t EVENT_BUFFER_BYTES = 4096u;
+
+constexpr std::uint32_t FILE_EVENTS = IN_MODIFY | IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF;
+constexpr std::uint32_t DIR_EVENTS  = IN_CREATE | IN_MOVED_TO;
+
+[[noreturn]] void throw_errno(std::string_view operation, std::string_view target) {
+    throw std::runtime_error(create_error_message(operation, target, std::strerror(errno)));
+}
+
+} // namespace
+
+FileFollower::FileFollower(std::filesystem::path path, LogProcessor& processor)
+    : path_(std::move(path)), name_(path_.filename().string()), processor_(processor) {
+    inotify_fd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd_ < 0) throw_errno("inotify setup", path_.string());
+
+    auto dir = path_.parent_path();
+    if (dir.empty()) dir = ".";
+    dir_wd_ = ::inotify_add_watch(inotify_fd_, dir.c_str(), DIR_EVENTS | IN_ONLYDIR);
+    if (dir_wd_ < 0) {
+        const int saved = errno;
+        ::close(inotify_fd_);
+        errno = saved;
+        throw_errno("directory watch", dir.string());
+    }
+
+    try {
+        open_file();
+        if (fd_ < 0) throw_errno("open", path_.string());
+        read_new_data();
+    } catch (...) {
+        close_file();
+        ::close(inotify_fd_);
+        throw;
+    }
+}
+
+FileFollower::~FileFollower() {
+    close_file();
+    if (signal_fd_ >= 0) ::close(signal_fd_);
+    if (inotify_fd_ >= 0) ::close(inotify_fd_);
+}
+
+void FileFollower::open_file() {
+    // Watch before opening so no write between the two is missed.
+    file_wd_ = ::inotify_add_watch(inotify_fd_, path_.c_str(), FILE_EVENTS);
+    fd_      = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+    offset_  = 0;
+    if (fd_ < 0) {
+        if (errno == ENOENT) return; // rotated away; wait for the directory event
+        throw_errno("open", path_.string());
+    }
+    struct stat st{};
+    if (::fstat(fd_, &st) != 0) throw_errno("stat", path_.string());
+    dev_ = st.st_dev;
+    ino_ = st.st_ino;
+}
+
+void FileFollower::close_file() noexcept {
+    if (file_wd_ >= 0) ::inotify_rm_watch(inotify_fd_, file_wd_);
+    if (fd_ >= 0) ::close(fd_);
+    file_wd_ = -1;
+    fd_      = -1;
+}
+
+void FileFollower::read_new_data() {
+    if (fd_ < 0) return;
+
+    struct stat st{};
+    if (::fstat(fd_, &st) != 0) throw_errno("stat", path_.string());
+    if (static_cast<std::uint64_t>(st.st_size) < offset_) {
+        // Truncated in place: the writer started over.
+        processor_.finish();
+        offset_ = 0;
+    }
+
+    std::array<char, READ_CHUNK_BYTES> buf{};
+    for (;;) {
+        const auto n = ::pread(fd_, buf.data(), buf.size(), static_cast<off_t>(offset_));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw_errno("read", path_.string());
+        }
+        if (n == 0) break;
+        processor_.feed(std::string_view{buf.data(), static_cast<std::size_t>(n)});
+        offset_ += static_cast<std::uint64_t>(n);
+    }
+    std::cout.flush();
+}
+
+bool FileFollower::path_is_current_file() const {
+    struct stat st{};
+    if (::stat(path_.c_str(), &st) != 0) return fd_ < 0;
+    return fd_ >= 0 && st.st_dev == dev_ && st.st_ino == ino_;
+}
+
+void FileFollower::switch_to_new_file() {
+    read_new_data();     // whatever the writer appended before rotating
+    processor_.finish(); // a block never spans two files
+    close_file();
+    open_file();
+    read_new_data();
+}
+
+void FileFollower::handle_events() {
+    alignas(inotify_event) std::array<char, EVENT_BUFFER_BYTES> buf{};
+    bool modified = false;
+    bool rotated  = false;
+
+    for (;;) {
+        const auto n = ::read(inotify_fd_, buf.data(), buf.size());
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN) break;
+            throw_errno("inotify read", path_.string());
+        }
+        for (std::size_t pos = 0; pos < static_cast<std::size_t>(n);) {
+            inotify_event ev{};
+            std::memcpy(&ev, buf.data() + pos, sizeof ev);
+            // The name is NUL-padded to ev.len
+            const std::string_view name = ev.len > 0 ? std::string_view{buf.data() + pos + sizeof ev}
+                                                     : std::string_view{};
+            pos += sizeof ev + ev.len;
+
+            if (ev.wd == file_wd_) {
+                if (ev.mask & (IN_MOVE_SELF | IN_DELETE_SELF)) rotated = true;
+                else                                           modified = true;
+            } else if (ev.wd == dir_wd_ && (ev.mask & DIR_EVENTS) && name == name_) {
+                rotated = true;
+            }
+        }
+    }
+
+    // Renames and re-creations are confirmed against the path before switching.
+    if (rotated && !path_is_current_file()) switch_to_new_file();
+    else if (modified || rotated)           read_new_data();
+}
+
+bool FileFollower::wait(int timeout_ms) {
+    std::array<pollfd, 2> fds{{{inotify_fd_, POLLIN, 0}, {signal_fd_, POLLIN, 0}}};
+    const nfds_t count = signal_fd_ >= 0 ? 2 : 1;
+
+    const int rc = ::poll(fds.data(), count, timeout_ms);
+    if (rc < 0) {
+        if (errno == EINTR) return true;
+        throw_errno("poll", path_.string());
+    }
+    if (count == 2 && (fds[1].revents & POLLIN)) return false;
+    if (fds[0].revents & POLLIN) handle_events();
+    return true;
+}
+
+void FileFollower::run() {
+    sigset_t stop_signals;
+    sigset_t previous;
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGINT);
+    sigaddset(&stop_signals, SIGTERM);
+    if (::sigprocmask(SIG_BLOCK, &stop_signals, &previous) != 0) throw_errno("signal setup", path_.string());
+    signal_fd_ = ::signalfd(-1, &stop_signals, SFD_CLOEXEC);
+    if (signal_fd_ < 0) throw_errno("signal setup", path_.string());
+
+    while (!processor_.stopped() && wait(-1)) {}
+
+    read_new_data();
+    processor_.finish();
+    std::cout.flush();
+    ::close(signal_fd_);
+    signal_fd_ = -1;
+    ::sigprocmask(SIG_SETMASK, &previous, nullptr);
+}
+
+bool follow_file(std::string_view fname, const Options& opt) {
+    if (fname.empty()) throw std::invalid_argument("Filename cannot be empty");
+    const auto path = path_validation::validate_and_canonicalize(fname);
+    LogProcessor processor(opt);
+    FileFollower follower(path, processor);
+    follower.run();
+    return processor.fail_on_match().has_value();
+}
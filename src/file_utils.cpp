@@ -8,7 +8,11 @@
 #include "file_utils.h"
 #include "log_processor.h"
 #include "path_validation.h"
+#include "resource_governor.h"
 
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
@@ -17,7 +21,10 @@
 #include <sstream>
 #include <string>
 #include <string_view>
+#include <sys/mman.h>
 #include <sys/resource.h> // Linux
+#include <sys/stat.h>
+#include <unistd.h>
 #include <vector>
 
 namespace {
@@ -71,6 +78,16 @@ void report_progress(std::size_t bytes_processed, std::size_t total_bytes, std::
 }
 
 std::size_t get_memory_usage_mb() noexcept {
+#if defined(__linux__)
+    try {
+        if (const auto rss = ResourceGovernor{}.rss_bytes(); rss > 0) return rss / MB_TO_BYTES;
+    } catch (...) {
+    }
+#endif
+    return get_peak_memory_usage_mb();
+}
+
+std::size_t get_peak_memory_usage_mb() noexcept {
 #if defined(__linux__)
     rusage u{};
     if (getrusage(RUSAGE_SELF, &u) == 0) {
@@ -85,7 +102,7 @@ void report_memory_usage(std::string_view operation, std::string_view filename)
     if (mb > 0) {
         std::cerr << "Memory usage during " << operation;
         if (!filename.empty()) std::cerr << " for " << filename;
-        std::cerr << ": " << mb << " MB\n";
+        std::cerr << ": " << mb << " MB (peak " << get_peak_memory_usage_mb() << " MB)\n";
     }
 }
 
@@ -107,21 +124,83 @@ std::vector<std::string> read_file_lines(std::string_view fname) {
     return lines;
 }
 
-bool is_large_file(std::string_view fname) {
-    if (fname.empty()) return false;
+std::optional<std::uintmax_t> regular_file_size(std::string_view fname) {
+    if (fname.empty()) return std::nullopt;
     try {
         const auto p = path_validation::validate_and_canonicalize(fname);
+        if (!std::filesystem::is_regular_file(p)) return std::nullopt;
         const auto s = std::filesystem::file_size(p);
         validate_file_size(static_cast<std::size_t>(s));
-        return s >= static_cast<std::uintmax_t>(LARGE_FILE_THRESHOLD_MB) * MB_TO_BYTES;
+        return s;
+    } catch (...) {
+        return std::nullopt;
+    }
+}
+
+MappedFile::MappedFile(const std::filesystem::path& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) throw_errno("open", path.string());
+    struct stat st{};
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw_errno("stat", path.string());
+    }
+    size_ = static_cast<std::size_t>(st.st_size);
+    validate_file_size(size_);
+    if (size_ > 0) {
+        data_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data_ == MAP_FAILED) {
+            ::close(fd);
+            throw_errno("mmap", path.string());
+        }
+        ::madvise(data_, size_, MADV_SEQUENTIAL); // read once, front to back
+    }
+    ::close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (size_ > 0) ::munmap(data_, size_);
+}
+
+void MappedFile::throw_errno(std::string_view operation, std::string_view target) {
+    throw std::runtime_error(create_error_message(operation, target, std::strerror(errno)));
+}
+
+bool starts_like_xml(std::istream& in) {
+    // Leading blanks are consumed; a text log's first significant byte is '='.
+    in >> std::ws;
+    return in.peek() == '<';
+}
+
+bool is_xml_file(std::string_view fname) {
+    try {
+        auto ifs = path_validation::safe_ifstream(fname);
+        return starts_like_xml(ifs);
     } catch (...) {
         return false;
     }
 }
 
-void process_file_stream(std::string_view fname, const Options& opt) {
+bool process_file_stream(std::string_view fname, const Options& opt) {
     if (fname.empty()) throw std::invalid_argument("Filename cannot be empty");
     auto ifs = path_validation::safe_ifstream(fname);
     LogProcessor processor(opt);
     processor.process_stream(ifs);
+    return processor.fail_on_match().has_value();
+}
+
+bool process_file_xml(std::string_view fname, const Options& opt) {
+    if (fname.empty()) throw std::invalid_argument("Filename cannot be empty");
+    auto ifs = path_validation::safe_ifstream(fname);
+    LogProcessor processor(opt);
+    processor.process_xml(ifs);
+    return processor.fail_on_match().has_value();
+}
+
+bool process_file_mapped(std::string_view fname, const Options& opt) {
+    if (fname.empty()) throw std::invalid_argument("Filename cannot be empty");
+    const MappedFile file(path_validation::validate_and_canonicalize(fname));
+    LogProcessor processor(opt);
+    processor.process_buffer(file.view());
+    return processor.fail_on_match().has_value();
 }
\ No newline at end of file
@@ -0,0 +1,82 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include "frame_cache.h"
+
+#include <iomanip>
+#include <ostream>
+
+namespace {
+
+// Rough per-entry cost of an unordered_map node plus its bucket slot
+constinit inline std::size_t INDEX_ENTRY_OVERHEAD = 48u;
+
+} // namespace
+
+FrameCache::FrameCache(std::size_t capacity) : slots(capacity) {
+    index.reserve(capacity);
+}
+
+FrameCache::Slot& FrameCache::lookup(std::string_view line) {
+    if (auto it = index.find(line); it != index.end()) {
+        Slot& s = slots[it->second];
+        s.referenced = true;
+        return s;
+    }
+
+    std::size_t victim = 0;
+    if (used < slots.size()) {
+        victim = used++;
+    } else {
+        // CLOCK: sweep, clearing reference bits, until an unreferenced slot turns up
+        while (slots[hand].referenced) {
+            slots[hand].referenced = false;
+            hand = (hand + 1) % slots.size();
+        }
+        victim = hand;
+        hand   = (hand + 1) % slots.size();
+        index.erase(slots[victim].key);
+        ++counters.evictions;
+    }
+
+    Slot& s = slots[victim];
+    s.key.assign(line);
+    s.canon.clear();
+    s.scrub.clear();
+    s.has_canon  = false;
+    s.has_scrub  = false;
+    s.referenced = false;
+    index.emplace(std::string_view{s.key}, static_cast<std::uint32_t>(victim));
+    return s;
+}
+
+FrameCacheStats FrameCache::stats() const {
+    FrameCacheStats out = counters;
+    out.entries  = used;
+    out.capacity = slots.size();
+    out.bytes    = slots.capacity() * sizeof(Slot) + index.bucket_count() * sizeof(void*) +
+                   used * INDEX_ENTRY_OVERHEAD;
+    for (std::size_t i = 0; i < used; ++i) {
+        const Slot& s = slots[i];
+        out.bytes += s.key.capacity() + s.canon.capacity() + s.scrub.capacity();
+    }
+    return out;
+}
+
+void report_frame_cache_stats(std::ostream& os, const FrameCacheStats& stats) {
+    if (stats.capacity == 0) {
+        os << "Frame cache: disabled\n";
+        return;
+    }
+    os << "Frame cache: " << stats.entries << '/' << stats.capacity << " entries, "
+       << (stats.bytes + 1023u) / 1024u << " KB, hit rate "
+       << std::fixed << std::setprecision(1) << stats.hit_rate() * 100.0 << "% "
+       << "(canon " << stats.canon_hits << '/' << stats.canon_hits + stats.canon_misses
+       << ", scrub " << stats.scrub_hits << '/' << stats.scrub_hits + stats.scrub_misses
+       << "), " << stats.evictions << " evictions\n";
+    os.unsetf(std::ios::floatfield);
+}
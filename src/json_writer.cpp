@@ -0,0 +1,366 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include "json_writer.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <ostream>
+#include <span>
+
+namespace {
+
+constinit inline std::size_t DRAIN_BYTES = 64u * 1024u; // buffered output per write to the stream
+
+constexpr std::string_view HEX       = "0123456789abcdef";
+constexpr std::string_view HEX_UPPER = "0123456789ABCDEF"; // percent-encoding
+
+// Marks bytes >= 0x80 in ESCAPES: the start of a UTF-8 sequence to validate.
+constexpr char UTF8_LEAD = '8';
+
+// Character written after the backslash for each byte; 0 = copy the byte as is.
+constexpr std::array<char, 256> ESCAPES = [] {
+    std::array<char, 256> t{};
+    for (std::size_t c = 0; c < 0x20; ++c) t[c] = 'u';
+    for (std::size_t c = 0x80; c < 0x100; ++c) t[c] = UTF8_LEAD;
+    t['"']  = '"';
+    t['\\'] = '\\';
+    t['\b'] = 'b';
+    t['\f'] = 'f';
+    t['\n'] = 'n';
+    t['\r'] = 'r';
+    t['\t'] = 't';
+    return t;
+}();
+
+// Length of the well-formed UTF-8 sequence that `s` starts with (RFC 3629: no
+// overlong forms, surrogates or code points past U+10FFFF). An ill-formed one
+// gives minus the length of its longest valid prefix, at least one byte, which
+// becomes a single U+FFFD as in the Unicode "maximal subpart" practice.
+[[nodiscard]] int utf8_sequence(std::string_view s) noexcept {
+    const auto    lead   = static_cast<unsigned char>(s[0]);
+    int           length = 0;
+    unsigned char low    = 0x80;
+    unsigned char high   = 0xBF;
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        length = 2;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+        length = 3;
+        if (lead == 0xE0) low = 0xA0;       // overlong
+        else if (lead == 0xED) high = 0x9F; // surrogates
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        length = 4;
+        if (lead == 0xF0) low = 0x90;       // overlong
+        else if (lead == 0xF4) high = 0x8F; // past U+10FFFF
+    } else {
+        return -1; // continuation byte, overlong C0/C1 or F5..FF
+    }
+    for (int k = 1; k < length; ++k) {
+        if (static_cast<std::size_t>(k) >= s.size()) return -k;
+        const auto c = static_cast<unsigned char>(s[static_cast<std::size_t>(k)]);
+        if (c < low || c > high) return -k;
+        low  = 0x80;
+        high = 0xBF;
+    }
+    return length;
+}
+
+void append_number(std::string& out, std::uint64_t v) {
+    std::array<char, 20> digits{};
+    const auto [end, ec] = std::to_chars(digits.data(), digits.data() + digits.size(), v);
+    out.append(digits.data(), end);
+}
+
+void append_hex64(std::string& out, std::uint64_t v) {
+    for (int shift = 60; shift >= 0; shift -= 4) out.push_back(HEX[(v >> shift) & 0xF]);
+}
+
+void append_field(std::string& out, std::string_view key, std::string_view value) {
+    out.append(",\"").append(key).append("\":\"");
+    append_json_string(out, value);
+    out.push_back('"');
+}
+
+// ---- SARIF -----------------------------------------------------------------
+
+#ifndef VGLOG_FILTER_VERSION
+#define VGLOG_FILTER_VERSION "0.0.0"
+#endif
+
+struct SarifRule {
+    std::string_view name;        // PascalCase, as SARIF rule names go
+    std::string_view description;
+    std::string_view level;       // "error", "warning" or "note"
+};
+
+// Indexed by BlockKind; a result's ruleIndex is its kind.
+constexpr std::array<SarifRule, BLOCK_KIND_COUNT> SARIF_RULES{{
+    {"Other",          "Other Valgrind report",                         "note"},
+    {"InvalidRead",    "Invalid read",                                  "error"},
+    {"InvalidWrite",   "Invalid write",                                 "error"},
+    {"SyscallParam",   "Syscall parameter points to unaddressable or uninitialised bytes", "error"},
+    {"Uninitialised",  "Use of an uninitialised value",                 "error"},
+    {"DefinitelyLost", "Memory definitely lost",                        "error"},
+    {"IndirectlyLost", "Memory indirectly lost",                        "warning"},
+    {"PossiblyLost",   "Memory possibly lost",                          "warning"},
+    {"StillReachable", "Memory still reachable at exit",                "note"},
+    {"Fatal",          "Process terminated by a signal",                "error"},
+    {"DataRace",       "Possible data race",                            "error"},
+    {"LockOrder",      "Lock order violated",                           "error"},
+    {"ThreadApi",      "Misuse of the threading API",                   "error"},
+}};
+
+constexpr std::string_view SARIF_FINGERPRINT_KEY = "vglogFilterSignature/v1";
+
+[[nodiscard]] constexpr bool uri_safe(unsigned char c) noexcept {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+           c == '-' || c == '.' || c == '_' || c == '~' || c == '/' || c == '+' || c == '@' || c == ':';
+}
+
+// A path as a URI reference: absolute paths become file:// URIs, other bytes
+// outside the unreserved set are percent-encoded (so no JSON escaping is needed).
+void append_uri(std::string& out, std::string_view path) {
+    if (path.starts_with('/')) out.append("file://");
+    for (const char ch : path) {
+        const auto c = static_cast<unsigned char>(ch);
+        if (uri_safe(c)) {
+            out.push_back(ch);
+        } else {
+            out.push_back('%');
+            out.push_back(HEX_UPPER[c >> 4]);
+            out.push_back(HEX_UPPER[c & 0xF]);
+        }
+    }
+}
+
+// {"physicalLocation":{...},"logicalLocations":[...]} of one frame.
+void append_sarif_location(std::string& out, const StringTable& names, const Frame& f) {
+    out.append("{\"physicalLocation\":{\"artifactLocation\":{\"uri\":\"");
+    append_uri(out, names[f.file != 0 ? f.file : f.object]);
+    out.append("\"}");
+    if (f.file != 0 && f.line != 0) {
+        out.append(",\"region\":{\"startLine\":");
+        append_number(out, f.line);
+        out.push_back('}');
+    }
+    out.append("},\"logicalLocations\":[{\"fullyQualifiedName\":\"");
+    append_json_string(out, names[f.function]);
+    out.append("\"}]}");
+}
+
+// {"message":{"text":...},"frames":[...]} of one stack; frames without a
+// file or object only get a logical location.
+void append_sarif_stack(std::string& out, const StringTable& names, std::string_view message,
+                        std::span<const Frame> frames) {
+    out.append("{\"message\":{\"text\":\"");
+    append_json_string(out, message);
+    out.append("\"},\"frames\":[");
+    bool first = true;
+    for (const Frame& f : frames) {
+        out.append(first ? "{\"location\":" : ",{\"location\":");
+        first = false;
+        if (f.file != 0 || f.object != 0) {
+            append_sarif_location(out, names, f);
+        } else {
+            out.append("{\"logicalLocations\":[{\"fullyQualifiedName\":\"");
+            append_json_string(out, names[f.function]);
+            out.append("\"}]}");
+        }
+        out.push_back('}');
+    }
+    out.append("]}");
+}
+
+void append_sarif_prologue(std::string& out) {
+    out.append("{\"version\":\"2.1.0\",\"$schema\":\"https://json.schemastore.org/sarif-2.1.0.json\",")
+       .append("\"runs\":[{\"tool\":{\"driver\":{\"name\":\"vglog-filter\",\"version\":\"")
+       .append(std::string_view{VGLOG_FILTER_VERSION})
+       .append("\",\"rules\":[");
+    for (std::size_t k = 0; k < SARIF_RULES.size(); ++k) {
+        const SarifRule& r = SARIF_RULES[k];
+        if (k != 0) out.push_back(',');
+        out.append("\n{\"id\":\"").append(block_kind_name(static_cast<BlockKind>(k)))
+           .append("\",\"name\":\"").append(r.name)
+           .append("\",\"shortDescription\":{\"text\":\"").append(r.description)
+           .append("\"},\"defaultConfiguration\":{\"level\":\"").append(r.level).append("\"}}");
+    }
+    out.append("]}},\"results\":[");
+}
+
+} // namespace
+
+void append_json_string(std::string& out, std::string_view s) {
+    std::size_t run = 0; // start of the bytes not yet copied
+    for (std::size_t i = 0; i < s.size(); ++i) {
+        const auto c = static_cast<unsigned char>(s[i]);
+        const char e = ESCAPES[c];
+        if (e == 0) continue;
+        if (e == UTF8_LEAD) {
+            const int length = utf8_sequence(s.substr(i));
+            if (length > 0) {
+                i += static_cast<std::size_t>(length) - 1; // copied with the run
+                continue;
+            }
+            // Log text is whatever bytes the program printed; the output must stay valid JSON.
+            out.append(s.data() + run, i - run);
+            out.append("\\ufffd");
+            i  += static_cast<std::size_t>(-length) - 1;
+            run = i + 1;
+            continue;
+        }
+        out.append(s.data() + run, i - run);
+        out.push_back('\\');
+        out.push_back(e);
+        if (e == 'u') {
+            out.append("00");
+            out.push_back(HEX[c >> 4]);
+            out.push_back(HEX[c & 0xF]);
+        }
+        run = i + 1;
+    }
+    out.append(s.data() + run, s.size() - run);
+}
+
+JsonRecordWriter::JsonRecordWriter(std::ostream& os, OutputFormat format) : os_(os), format_(format) {
+    buf_.reserve(DRAIN_BYTES * 2);
+}
+
+JsonRecordWriter::~JsonRecordWriter() {
+    try {
+        drain();
+    } catch (...) {
+        // Destructors must not throw; the stream's state reports the failure.
+    }
+}
+
+void JsonRecordWriter::write(const BlockStore& store, std::size_t index, std::string_view text) {
+    begin_record();
+    if (format_ == OutputFormat::Sarif) write_sarif_result(store, index);
+    else                                write_record(store, index, text);
+    if (buf_.size() >= DRAIN_BYTES) drain();
+}
+
+void JsonRecordWriter::begin_record() {
+    if (format_ == OutputFormat::Ndjson) return;
+    if (!open_) open_document();
+    buf_.append(records_++ == 0 ? "\n" : ",\n");
+}
+
+void JsonRecordWriter::open_document() {
+    if (format_ == OutputFormat::Sarif) append_sarif_prologue(buf_);
+    else                                buf_.push_back('[');
+    open_ = true;
+}
+
+void JsonRecordWriter::write_record(const BlockStore& store, std::size_t index, std::string_view text) {
+    buf_.append("{\"kind\":\"").append(block_kind_name(store.kind(index)));
+    buf_.append("\",\"fingerprint\":\"");
+    append_hex64(buf_, store.fingerprint(index));
+    buf_.append("\",\"count\":");
+    append_number(buf_, store.occurrences(index));
+    buf_.append(",\"bytes\":");
+    append_number(buf_, store.bytes(index));
+    buf_.append(",\"blocks\":");
+    append_number(buf_, store.heap_blocks(index));
+    append_field(buf_, "header", store.header(index));
+
+    const StringTable& names = store.strings();
+    buf_.append(",\"frames\":[");
+    bool first = true;
+    for (const Frame& f : store.frames(index)) {
+        buf_.append(first ? "{\"fn\":\"" : ",{\"fn\":\"");
+        first = false;
+        append_json_string(buf_, names[f.function]);
+        buf_.push_back('"');
+        if (f.file != 0) {
+            append_field(buf_, "file", names[f.file]);
+            buf_.append(",\"line\":");
+            append_number(buf_, f.line);
+        }
+        if (f.object != 0) append_field(buf_, "obj", names[f.object]);
+        buf_.push_back('}');
+    }
+    buf_.push_back(']');
+    append_field(buf_, "text", text);
+    buf_.push_back('}');
+    if (format_ == OutputFormat::Ndjson) buf_.push_back('\n');
+}
+
+void JsonRecordWriter::write_sarif_result(const BlockStore& store, std::size_t index) {
+    const auto kind = static_cast<std::size_t>(store.kind(index));
+    buf_.append("{\"ruleId\":\"").append(block_kind_name(store.kind(index)));
+    buf_.append("\",\"ruleIndex\":");
+    append_number(buf_, kind);
+    buf_.append(",\"level\":\"").append(SARIF_RULES[kind].level);
+    buf_.append("\",\"message\":{\"text\":\"");
+    append_json_string(buf_, store.header(index));
+    buf_.append("\"}");
+
+    // Code scanning annotates the first location: the innermost frame of the
+    // block's own stack with a source line, which skips allocator and libc
+    // frames without debug info.
+    const StringTable& names = store.strings();
+    const auto         stack = store.stack(index);
+    const auto source = std::ranges::find_if(stack, [](const Frame& f) { return f.file != 0; });
+    const Frame* where = source != stack.end() ? &*source : nullptr;
+    if (where == nullptr && !stack.empty() && stack.front().object != 0) where = &stack.front();
+    if (where != nullptr) {
+        buf_.append(",\"locations\":[");
+        append_sarif_location(buf_, names, *where);
+        buf_.push_back(']');
+    }
+    // The own stack first, then the allocation, free or conflicting access
+    // stacks, each under the line that introduced it.
+    const auto others = store.other_stacks(index);
+    if (!stack.empty() || !others.empty()) {
+        buf_.append(",\"stacks\":[");
+        bool first = true;
+        if (!stack.empty()) {
+            append_sarif_stack(buf_, names, store.header(index), stack);
+            first = false;
+        }
+        for (const OtherStack& o : others) {
+            if (!first) buf_.push_back(',');
+            first = false;
+            append_sarif_stack(buf_, names, names[o.message], store.frames(o));
+        }
+        buf_.push_back(']');
+    }
+
+    buf_.append(",\"partialFingerprints\":{\"").append(SARIF_FINGERPRINT_KEY).append("\":\"");
+    append_hex64(buf_, store.fingerprint(index));
+    buf_.append("\"},\"occurrenceCount\":");
+    append_number(buf_, store.occurrences(index));
+    buf_.append(",\"properties\":{\"bytes\":");
+    append_number(buf_, store.bytes(index));
+    buf_.append(",\"heapBlocks\":");
+    append_number(buf_, store.heap_blocks(index));
+    buf_.append("}}");
+}
+
+void JsonRecordWriter::flush() {
+    drain();
+    os_.flush();
+}
+
+void JsonRecordWriter::finish() {
+    if (format_ != OutputFormat::Ndjson) {
+        if (!open_) open_document(); // an empty run is still a document
+        if (records_ != 0) buf_.push_back('\n');
+        buf_.append(format_ == OutputFormat::Sarif ? "]}]}\n" : "]\n");
+    }
+    open_    = false;
+    records_ = 0;
+    flush();
+}
+
+void JsonRecordWriter::drain() {
+    if (buf_.empty()) return;
+    os_.write(buf_.data(), static_cast<std::streamsize>(buf_.size()));
+    buf_.clear();
+}
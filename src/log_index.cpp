@@ -0,0 +1,232 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include "log_index.h"
+
+#include "checkpoint.h"
+#include "file_utils.h"
+#include "log_processor.h"
+#include "path_validation.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr std::uint64_t align8(std::uint64_t n) noexcept { return (n + 7) & ~std::uint64_t{7}; }
+
+template <class T>
+void write_raw(std::ofstream& out, const T& v) {
+    out.write(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+void write_padding(std::ofstream& out, std::uint64_t from) {
+    constexpr char zeros[8]{};
+    out.write(zeros, static_cast<std::streamsize>(align8(from) - from));
+}
+
+[[noreturn]] void corrupt(const std::filesystem::path& path) {
+    throw std::runtime_error(create_error_message("index load", path.string(), "file is truncated or corrupt"));
+}
+
+// Size and modification time of the log, which an index must match.
+struct LogIdentity {
+    std::uint64_t size{0};
+    std::uint64_t mtime{0};
+};
+
+[[nodiscard]] LogIdentity log_identity(const std::filesystem::path& path) {
+    struct stat st{};
+    if (::stat(path.c_str(), &st) != 0) {
+        throw std::runtime_error(create_error_message("stat", path.string(), std::strerror(errno)));
+    }
+    return {static_cast<std::uint64_t>(st.st_size),
+            static_cast<std::uint64_t>(st.st_mtim.tv_sec) * 1'000'000'000u + static_cast<std::uint64_t>(st.st_mtim.tv_nsec)};
+}
+
+} // namespace
+
+LogIndexWriter::LogIndexWriter(std::filesystem::path path) : path_(std::move(path)) {
+    tmp_ = path_;
+    tmp_ += ".tmp";
+    out_.open(tmp_, std::ios::binary | std::ios::trunc);
+    if (!out_) throw std::runtime_error(create_error_message("index save", path_.string(), "cannot create file"));
+    const IndexHeader placeholder{};
+    write_raw(out_, placeholder); // filled in by finish()
+}
+
+LogIndexWriter::~LogIndexWriter() {
+    if (finished_) return;
+    out_.close();
+    std::error_code ec;
+    std::filesystem::remove(tmp_, ec); // a failed run leaves no index behind
+}
+
+void LogIndexWriter::add_block(IndexBlock block, std::span<const IndexLine> lines) {
+    block.first_line = lines_;
+    block.lines      = static_cast<std::uint32_t>(lines.size()); // blocks are at most 10 MB
+    blocks_.push_back(block);
+    out_.write(reinterpret_cast<const char*>(lines.data()), static_cast<std::streamsize>(lines.size_bytes()));
+    lines_ += lines.size();
+}
+
+void LogIndexWriter::finish(const IndexHeader& identity, std::string_view marker) {
+    IndexHeader h{};
+    std::memcpy(h.magic, INDEX_MAGIC.data(), sizeof(h.magic));
+    h.version        = INDEX_VERSION;
+    h.marker_length  = static_cast<std::uint32_t>(marker.size());
+    h.log_size       = identity.log_size;
+    h.log_mtime      = identity.log_mtime;
+    h.settings       = identity.settings;
+    h.lines          = lines_;
+    h.lines_offset   = sizeof(IndexHeader);
+    h.blocks         = blocks_.size();
+    h.blocks_offset  = h.lines_offset + lines_ * sizeof(IndexLine);
+    h.markers        = markers_.size();
+    h.markers_offset = h.blocks_offset + blocks_.size() * sizeof(IndexBlock);
+    h.strings        = strings_.size();
+    h.strings_offset = h.markers_offset + markers_.size() * sizeof(std::uint64_t);
+    h.blob_offset    = h.strings_offset + strings_.size() * sizeof(IndexString);
+
+    out_.write(reinterpret_cast<const char*>(blocks_.data()),
+               static_cast<std::streamsize>(blocks_.size() * sizeof(IndexBlock)));
+    out_.write(reinterpret_cast<const char*>(markers_.data()),
+               static_cast<std::streamsize>(markers_.size() * sizeof(std::uint64_t)));
+    std::uint64_t blob = marker.size();
+    for (std::uint32_t id = 1; id <= strings_.size(); ++id) {
+        const IndexString s{blob, static_cast<std::uint32_t>(strings_[id].size()), 0};
+        write_raw(out_, s);
+        blob += s.length;
+    }
+    out_.write(marker.data(), static_cast<std::streamsize>(marker.size()));
+    for (std::uint32_t id = 1; id <= strings_.size(); ++id) {
+        out_.write(strings_[id].data(), static_cast<std::streamsize>(strings_[id].size()));
+    }
+    h.blob_size = blob;
+    write_padding(out_, h.blob_offset + blob);
+    out_.seekp(0);
+    write_raw(out_, h);
+    out_.close();
+    if (!out_) throw std::runtime_error(create_error_message("index save", path_.string(), "write failed"));
+    std::filesystem::rename(tmp_, path_);
+    finished_ = true;
+}
+
+LogIndex::LogIndex(const std::filesystem::path& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) throw std::runtime_error(create_error_message("index load", path.string(), std::strerror(errno)));
+    struct stat st{};
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error(create_error_message("index load", path.string(), std::strerror(errno)));
+    }
+    size_ = static_cast<std::size_t>(st.st_size);
+    if (size_ < sizeof(IndexHeader)) {
+        ::close(fd);
+        corrupt(path);
+    }
+    void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) throw std::runtime_error(create_error_message("index load", path.string(), std::strerror(errno)));
+    data_ = static_cast<const char*>(data);
+
+    std::memcpy(&header_, data_, sizeof(header_));
+    const auto fits = [&](std::uint64_t offset, std::uint64_t count, std::uint64_t element) {
+        return offset <= size_ && count <= (size_ - offset) / element;
+    };
+    bool valid = std::string_view{header_.magic, sizeof(header_.magic)} == INDEX_MAGIC &&
+                 header_.version == INDEX_VERSION &&
+                 fits(header_.lines_offset, header_.lines, sizeof(IndexLine)) &&
+                 fits(header_.blocks_offset, header_.blocks, sizeof(IndexBlock)) &&
+                 fits(header_.markers_offset, header_.markers, sizeof(std::uint64_t)) &&
+                 fits(header_.strings_offset, header_.strings, sizeof(IndexString)) &&
+                 fits(header_.blob_offset, header_.blob_size, 1) && header_.marker_length <= header_.blob_size;
+    // Queries then read the tables without bounds checks.
+    for (std::uint64_t i = 0; valid && i < header_.lines; ++i) {
+        const IndexLine l = line(i);
+        const std::uint64_t length = l.length & ~INDEX_SCRUBS_BLANK;
+        valid = l.offset <= header_.log_size && length <= header_.log_size - l.offset && l.canonical <= header_.strings;
+    }
+    for (std::uint64_t i = 0; valid && i < header_.strings; ++i) {
+        const auto s = get<IndexString>(header_.strings_offset, i);
+        valid = s.offset <= header_.blob_size && s.length <= header_.blob_size - s.offset;
+    }
+    for (std::uint64_t i = 0; valid && i < header_.blocks; ++i) {
+        const IndexBlock b = block(i);
+        valid = b.first_line <= header_.lines && b.lines <= header_.lines - b.first_line &&
+                b.head_offset <= header_.log_size && b.head_length <= header_.log_size - b.head_offset &&
+                b.kind < BLOCK_KIND_COUNT;
+    }
+    if (!valid) {
+        ::munmap(data, size_);
+        corrupt(path);
+    }
+}
+
+LogIndex::~LogIndex() {
+    ::munmap(const_cast<char*>(data_), size_);
+}
+
+std::string_view LogIndex::string(std::uint32_t id) const noexcept {
+    if (id == 0) return {};
+    const auto s = get<IndexString>(header_.strings_offset, id - 1);
+    return {data_ + header_.blob_offset + s.offset, s.length};
+}
+
+std::filesystem::path index_path(std::string_view log_file) {
+    auto path = path_validation::validate_and_canonicalize(log_file);
+    path += INDEX_EXTENSION;
+    return path;
+}
+
+std::size_t build_log_index(std::string_view log_file, const Options& opt) {
+    const auto log = path_validation::validate_and_canonicalize(log_file);
+    const LogIdentity id = log_identity(log);
+    const MappedFile  file(log);
+    if (file.view().size() != id.size) {
+        throw std::runtime_error(create_error_message("index", log_file, "file changed while it was read"));
+    }
+
+    LogIndexWriter writer(index_path(log_file));
+    LogProcessor   processor(opt);
+    processor.index_buffer(file.view(), writer);
+
+    IndexHeader h{};
+    h.log_size  = id.size;
+    h.log_mtime = id.mtime;
+    h.settings  = signature_settings(opt);
+    writer.finish(h, opt.marker);
+    return writer.blocks();
+}
+
+std::optional<bool> process_file_indexed(std::string_view log_file, const Options& opt) {
+    const auto path = index_path(log_file);
+    if (!std::filesystem::exists(path)) return std::nullopt;
+
+    const auto log = path_validation::validate_and_canonicalize(log_file);
+    const LogIdentity id = log_identity(log);
+    const LogIndex    index(path);
+    const IndexHeader& h = index.header();
+    if (h.log_size != id.size || h.log_mtime != id.mtime || h.settings != signature_settings(opt) ||
+        (opt.trim && index.marker() != opt.marker)) {
+        std::cerr << "Info: Index '" << path.string() << "' does not match '" << log_file
+                  << "' (changed log or different options); parsing the log\n";
+        return std::nullopt;
+    }
+
+    const MappedFile file(log);
+    if (file.view().size() != h.log_size) return std::nullopt; // rewritten since the check
+    LogProcessor processor(opt);
+    processor.process_indexed(index, file.view());
+    return processor.fail_on_match().has_value();
+}
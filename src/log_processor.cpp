@@ -9,14 +9,19 @@
 
 #include "file_utils.h"
 #include "canonicalization.h"
+#include "log_index.h"
+#include "xml_reader.h"
 
+#include <algorithm>
 #include <array>
 #include <chrono>
 #include <filesystem>
 #include <iostream>
+#include <numeric>
 #include <ranges>
 #include <string>
 #include <thread>
+#include <utility>
 
 using namespace canonicalization;
 
@@ -29,7 +34,13 @@ constinit inline std::size_t PROGRESS_REPORT_INTERVAL = 1024u * 1024u; // 1MB
 
 constinit inline std::size_t MAX_LINE_LENGTH     = 1024u * 1024u;   // 1MB per line
 constinit inline std::size_t MAX_BLOCK_SIZE      = 10u   * 1024u * 1024u; // 10MB per block
-constinit inline std::size_t MAX_PENDING_BLOCKS  = 1000u;
+constinit inline std::size_t FALLBACK_PENDING_BYTES = 64u * 1024u * 1024u; // budget when free memory is unknown
+
+constinit inline std::size_t BLOCK_ARENA_BYTES   = 64u * 1024u;     // inline scratch per block
+constinit inline std::size_t BUDGET_RECHECK_BYTES = 8u * 1024u * 1024u; // pending growth between memory samples
+constinit inline std::uint32_t TOOL_PROBE_LINES  = 32;              // Valgrind lines searched for the tool banner
+
+inline constexpr std::string_view ERROR_SUMMARY = "ERROR SUMMARY:"; // a process's last line
 
 void validate_line_length(std::string_view line) {
     if (line.size() > MAX_LINE_LENGTH) {
@@ -41,21 +52,145 @@ void validate_block_size(std::size_t s) {
         throw std::runtime_error("Block too large (max " + std::to_string(MAX_BLOCK_SIZE) + " bytes)");
     }
 }
-void validate_pending_blocks_count(std::size_t n) {
-    if (n > MAX_PENDING_BLOCKS) {
-        throw std::runtime_error("Too many pending blocks (max " + std::to_string(MAX_PENDING_BLOCKS) + ")");
+
+// Digits of the ==PID== prefix; `line` must satisfy matches_vg_line().
+std::uint32_t line_pid(std::string_view line) noexcept {
+    std::uint32_t pid = 0;
+    for (std::size_t i = 2; i < line.size() && is_digit(line[i]); ++i) {
+        pid = pid * 10u + static_cast<std::uint32_t>(line[i] - '0');
+    }
+    return pid;
+}
+
+// The ==PID== prefix of a Valgrind line: the PID, and where the text after
+// the prefix and its blanks begins. One pass instead of matches_vg_line(),
+// line_pid() and strip_prefix() on the per-line path.
+struct VgPrefix {
+    std::uint32_t pid;
+    std::size_t   body;
+};
+std::optional<VgPrefix> vg_prefix(std::string_view line) noexcept {
+    if (line.size() < 4 || line[0] != '=' || line[1] != '=') return std::nullopt;
+    std::uint32_t pid = 0;
+    std::size_t   i   = 2;
+    for (; i < line.size() && is_digit(line[i]); ++i) pid = pid * 10u + static_cast<std::uint32_t>(line[i] - '0');
+    if (i < 4 || i + 1 >= line.size() || line[i] != '=' || line[i + 1] != '=') return std::nullopt;
+    i += 2;
+    while (i < line.size() && std::isspace(static_cast<unsigned char>(line[i]))) ++i;
+    return VgPrefix{pid, i};
+}
+
+// Figures of an access or leak record's header; the other kinds carry none,
+// so their headers are not scanned.
+HeaderCounts header_counts_of(BlockKind kind, std::string_view header) noexcept {
+    switch (kind) {
+        case BlockKind::InvalidRead:
+        case BlockKind::InvalidWrite:
+        case BlockKind::DefinitelyLost:
+        case BlockKind::IndirectlyLost:
+        case BlockKind::PossiblyLost:
+        case BlockKind::StillReachable:
+            return parse_header_counts(header);
+        default:
+            return {};
+    }
+}
+
+// Whether an indexed line is one of the block's lines in this run: at or after
+// the trim point, and not emptied by scrubbing when the output is scrubbed.
+template <class Policy>
+bool accepts(const IndexLine& l, std::uint64_t from) noexcept {
+    if constexpr (Policy::scrub) {
+        if ((l.length & INDEX_SCRUBS_BLANK) != 0) return false;
     }
+    return l.offset >= from;
+}
+
+// Turns runtime flags into template arguments, one flag at a time, and calls
+// fn.template operator()<Flags...>() with the resulting pack.
+template <bool... Flags, class Fn>
+void dispatch_flags(Fn&& fn) {
+    fn.template operator()<Flags...>();
+}
+template <bool... Flags, class Fn, class... Rest>
+void dispatch_flags(Fn&& fn, bool flag, Rest... rest) {
+    if (flag) dispatch_flags<Flags..., true>(std::forward<Fn>(fn), rest...);
+    else      dispatch_flags<Flags..., false>(std::forward<Fn>(fn), rest...);
+}
+
+// Selects the ProcessingPolicy instantiation matching `opt` and `seg` and
+// passes it to fn.
+template <class Fn>
+void dispatch_policy(const Options& opt, Segmentation seg, Fn&& fn) {
+    dispatch_flags([&]<bool Trim, bool Stream, bool Scrub, bool Unlimited>() {
+        switch (seg) {
+            case Segmentation::Probing:
+                fn.template operator()<ProcessingPolicy<Trim, Stream, Scrub, Unlimited, Segmentation::Probing>>();
+                break;
+            case Segmentation::Memcheck:
+                fn.template operator()<ProcessingPolicy<Trim, Stream, Scrub, Unlimited, Segmentation::Memcheck>>();
+                break;
+            case Segmentation::ThreadTool:
+                fn.template operator()<ProcessingPolicy<Trim, Stream, Scrub, Unlimited, Segmentation::ThreadTool>>();
+                break;
+        }
+    }, opt.trim, opt.stream_mode, opt.scrub_raw, opt.depth <= 0);
 }
 
 } // namespace
 
-LogProcessor::LogProcessor(const Options& options) : opt(options) {
-    seen.reserve(256);
-    pending_blocks.reserve(opt.stream_mode ? 64 : 0);
-    sigLines.reserve(64);
+LogProcessor::LogProcessor(const Options& options, BlockCallback callback)
+    : opt(options),
+      on_block(std::move(callback)),
+      depth_limit(options.depth > 0 ? static_cast<std::size_t>(options.depth) : 0),
+      defer_output(options.format != OutputFormat::Text || !options.result_file.empty() ||
+                   !options.suppressions_file.empty() || options.top > 0 || on_block != nullptr),
+      frame_cache(options.frame_cache_entries),
+      pending_budget(options.max_memory_mb * 1024u * 1024u),
+      tool_probe_left(TOOL_PROBE_LINES) {
+    select_pid(0);
+    epoch.emplace(&epoch_pool);
+    epoch->seen.reserve(256);
+    epoch->pending_blocks.reserve(opt.stream_mode ? 64 : 0);
+    if (!opt.canon_rules_file.empty()) {
+        canon_rules = RuleSet::load(opt.canon_rules_file);
+    }
+    for (const auto& f : opt.suppress_files) suppression_set.load(f);
     initialize_string_patterns();
 }
 
+LogProcessor::PidBlock::PidBlock()
+    : buffer(std::make_unique_for_overwrite<std::byte[]>(BLOCK_ARENA_BYTES)),
+      arena(buffer.get(), BLOCK_ARENA_BYTES) {
+    state.emplace(&arena);
+}
+
+void LogProcessor::select_pid(std::uint32_t pid) {
+    if (active != nullptr) {
+        if (active->pid == pid) return;
+        if (active->idle()) {
+            // Nothing pending for that process: recycle its slot and arena buffer.
+            auto node = pid_blocks.extract(active->pid);
+            spare_pid_blocks.push_back(std::move(node.mapped()));
+        }
+    }
+
+    auto it = pid_blocks.find(pid);
+    if (it == pid_blocks.end()) {
+        std::unique_ptr<PidBlock> slot;
+        if (spare_pid_blocks.empty()) {
+            slot = std::make_unique<PidBlock>();
+        } else {
+            slot = std::move(spare_pid_blocks.back());
+            spare_pid_blocks.pop_back();
+        }
+        slot->pid = pid;
+        it = pid_blocks.emplace(pid, std::move(slot)).first;
+    }
+    active = it->second.get();
+    cur    = &*active->state;
+}
+
 void LogProcessor::initialize_string_patterns() {
     // Retained for compatibility; using simple string checks in code paths.
     vg_pattern          = "^==[0-9]+==";
@@ -130,18 +265,16 @@ bool LogProcessor::matches_q_pattern(std::string_view line) const noexcept {
     return false;
 }
 
-std::string LogProcessor::replace_prefix(std::string_view line) const {
-    if (!matches_vg_line(line)) return std::string{line};
+std::string_view LogProcessor::strip_prefix(std::string_view line) const noexcept {
+    if (!matches_vg_line(line)) return line;
     std::size_t i = 2;
     while (i < line.size() && is_digit(line[i])) ++i;
     i += 2; // ==
     while (i < line.size() && std::isspace(static_cast<unsigned char>(line[i]))) ++i;
-    return std::string{line.substr(i)};
+    return line.substr(i);
 }
 
-std::string LogProcessor::replace_patterns(const std::string& line) const {
-    std::string out = line;
-
+void LogProcessor::replace_patterns(std::string& out) const {
     // remove 0x[hex]+
     {
         std::size_t pos = 0;
@@ -173,7 +306,49 @@ std::string LogProcessor::replace_patterns(const std::string& line) const {
             }
         }
     }
-    return out;
+}
+
+// Calls fn with the policy for the options. The segmentation is checked at
+// run time, which is all the end of input needs; line loops go through run_lines().
+template <class Fn>
+void LogProcessor::dispatch(Fn&& fn) {
+    route_unique_blocks();
+    dispatch_policy(opt, Segmentation::Probing, std::forward<Fn>(fn));
+}
+
+// Runs a line loop with the segmentation fixed once the tool is known. Under
+// the probing policy the loop returns as soon as the probe is over, and the
+// rest of the input goes through the specialised one.
+template <class Loop>
+void LogProcessor::run_lines(Loop&& loop) {
+    const auto run = [&] {
+        route_unique_blocks();
+        const Segmentation seg = tool_probe_left > 0             ? Segmentation::Probing
+                                 : tool == ValgrindTool::Memcheck ? Segmentation::Memcheck
+                                                                  : Segmentation::ThreadTool;
+        dispatch_policy(opt, seg, loop);
+    };
+    const bool probing = tool_probe_left > 0;
+    run();
+    if (probing && tool_probe_left == 0 && !stop_requested) run();
+}
+
+void LogProcessor::route_unique_blocks() noexcept {
+    if (!opt.stream_mode) {
+        route = defer_output ? Route::Pending : Route::Print;
+    } else if (live) {
+        // Nothing is held back: before the first marker a trimmed run has no output.
+        if (opt.trim && !marker_found) route = Route::Drop;
+        else                           route = defer_output ? Route::Record : Route::Print;
+    } else {
+        route = source != nullptr ? Route::Range : Route::Pending;
+    }
+}
+
+template <class Policy>
+bool LogProcessor::memcheck_segmentation() const noexcept {
+    if constexpr (Policy::probing) return tool == ValgrindTool::Memcheck;
+    else                           return Policy::memcheck;
 }
 
 void LogProcessor::process_stream(std::istream& in) {
@@ -184,22 +359,169 @@ void LogProcessor::process_stream(std::istream& in) {
         total_bytes = get_file_size_for_progress();
     }
 
-    std::string line;
-    while (std::getline(in, line)) {
-        validate_line_length(line);
-        bytes_processed += line.size() + 1;
-        if (should_report_progress(bytes_processed, total_bytes)) {
-            report_progress(bytes_processed, total_bytes, opt.filename);
+    // A seekable input lets pending blocks be stored as byte ranges and re-read
+    // at EOF, so their text is never held in memory.
+    std::uint64_t offset = 0;
+    source = nullptr;
+    if (opt.stream_mode && !opt.use_stdin) {
+        if (const auto start = in.tellg(); start != std::istream::pos_type(-1)) {
+            source = &in;
+            offset = static_cast<std::uint64_t>(static_cast<std::streamoff>(start));
         }
-        process_line(line);
     }
 
+    // With a state file an unterminated last line may still be growing: leave it,
+    // and the open blocks, for the next run.
+    const bool resumable = !opt.state_file.empty();
+
+    std::string line;
+    run_lines([&]<class Policy>() {
+        while (std::getline(in, line)) {
+            if (resumable && in.eof()) break;
+            validate_line_length(line);
+            bytes_processed += line.size() + 1;
+            line_begin = offset;
+            line_end   = offset + line.size();
+            offset     = line_end + 1;
+            if (should_report_progress(bytes_processed, total_bytes)) {
+                report_progress(bytes_processed, total_bytes, opt.filename);
+            }
+            process_line<Policy>(line);
+            if (stop_requested) {
+                // A line that started the next block is not consumed
+                if (!active->idle()) offset = line_begin;
+                break;
+            }
+            if (Policy::probing && tool_probe_left == 0) break;
+        }
+    });
+
+    consumed = offset;
+
     if (opt.show_progress && total_bytes > 0) {
         report_progress(bytes_processed, total_bytes, opt.filename);
     }
 
-    flush();
-    output_pending_blocks();
+    dispatch([&]<class Policy>() {
+        if (stop_requested)  clear_all_blocks();
+        else if (!resumable) flush_all<Policy>();
+        if constexpr (Policy::stream) output_pending_blocks<Policy>();
+    });
+    finish_records();
+    report_statistics();
+}
+
+void LogProcessor::feed(std::string_view chunk) {
+    live = true;
+    feed_lines(chunk);
+}
+
+void LogProcessor::finish() {
+    dispatch([&]<class Policy>() { finish_impl<Policy>(); });
+}
+
+void LogProcessor::feed_run(std::string_view chunk) {
+    feed_lines(chunk);
+}
+
+void LogProcessor::end_of_input() {
+    dispatch([&]<class Policy>() { end_of_input_impl<Policy>(); });
+}
+
+void LogProcessor::feed_lines(std::string_view chunk) {
+    run_lines([&]<class Policy>() {
+        while (!chunk.empty() && !stop_requested) {
+            const auto nl = chunk.find('\n');
+            if (nl == std::string_view::npos) {
+                partial_line.append(chunk);
+                validate_line_length(partial_line);
+                return;
+            }
+            std::string_view line = chunk.substr(0, nl);
+            chunk.remove_prefix(nl + 1);
+            if (!partial_line.empty()) {
+                partial_line.append(line);
+                line = partial_line;
+            }
+            validate_line_length(line);
+            process_line<Policy>(line);
+            partial_line.clear();
+            if (Policy::probing && tool_probe_left == 0) return;
+        }
+    });
+    if (stop_requested) clear_all_blocks();
+}
+
+template <class Policy>
+void LogProcessor::finish_impl() {
+    if (!partial_line.empty() && !stop_requested) {
+        process_line<Policy>(partial_line);
+        partial_line.clear();
+    }
+    flush_all<Policy>();
+    report_statistics();
+}
+
+template <class Policy>
+void LogProcessor::end_of_input_impl() {
+    finish_impl<Policy>();
+    if (Policy::stream || defer_output) output_pending_blocks<Policy>();
+    finish_records();
+}
+
+void LogProcessor::restore(const Checkpoint& cp) {
+    reset_epoch();
+    marker_found = cp.marker_found;
+    tool            = static_cast<ValgrindTool>(cp.tool);
+    tool_probe_left = cp.tool_probe_left;
+    // Records of earlier runs are gone; their signatures still count as seen.
+    epoch->seen.reserve(cp.seen.size());
+    for (const auto f : cp.seen) epoch->seen.emplace(f, BlockStore::npos);
+
+    for (const auto& b : cp.open_blocks) {
+        select_pid(b.pid);
+        std::string_view text{b.text};
+        for (const auto n : b.line_lengths) {
+            append_block_line(text.substr(0, n));
+            text.remove_prefix(n);
+        }
+        cur->source_begin = b.begin;
+        cur->source_end   = b.end;
+        cur->kind         = static_cast<BlockKind>(b.kind);
+        cur->head.assign(b.head);
+        cur->sig.assign(b.sig);
+        cur->sig_lines = static_cast<std::size_t>(b.sig_lines);
+    }
+    consumed       = cp.offset;
+}
+
+Checkpoint LogProcessor::checkpoint() const {
+    Checkpoint cp;
+    cp.offset       = consumed;
+    cp.marker_found = marker_found;
+    cp.tool            = static_cast<std::uint8_t>(tool);
+    cp.tool_probe_left = tool_probe_left;
+    cp.seen.reserve(epoch->seen.size());
+    for (const auto& [f, index] : epoch->seen) cp.seen.push_back(f);
+
+    for (const auto& [pid, slot] : pid_blocks) {
+        if (slot->idle()) continue;
+        const BlockState& b = *slot->state;
+        auto& out = cp.open_blocks.emplace_back();
+        out.pid       = pid;
+        out.kind      = static_cast<std::uint8_t>(b.kind);
+        out.begin     = b.source_begin;
+        out.end       = b.source_end;
+        out.sig_lines = b.sig_lines;
+        out.head.assign(b.head);
+        out.sig.assign(b.sig);
+        out.text.assign(b.text);
+        out.line_lengths.reserve(b.spans.size());
+        for (const auto& s : b.spans) out.line_lengths.push_back(s.length);
+        out.started = b.started;
+    }
+    std::ranges::sort(cp.open_blocks, {}, &Checkpoint::OpenBlock::started);
+    return cp;
 }
 
 std::size_t LogProcessor::get_file_size_for_progress() const {
@@ -215,97 +537,758 @@ bool LogProcessor::should_report_progress(std::size_t bytes_processed, std::size
            (bytes_processed % PROGRESS_REPORT_INTERVAL == 0 || bytes_processed >= total_bytes);
 }
 
-void LogProcessor::output_pending_blocks() const {
-    if (!opt.trim || marker_found) {
-        for (const auto& b : pending_blocks) std::cout << b;
+template <class Policy>
+void LogProcessor::output_pending_blocks() {
+    if (Policy::watch_marker && !marker_found) return;
+    if (defer_output) {
+        output_pending_records<Policy>();
+        return;
+    }
+
+    for (const auto& b : epoch->pending_blocks) std::cout << b;
+    spill.copy_to(std::cout);
+
+    if (source == nullptr || epoch->pending_ranges.empty()) return;
+    source->clear(); // EOF was reached
+    std::string chunk;
+    std::string out;
+    for (const auto& r : epoch->pending_ranges) {
+        render_source_range<Policy>(chunk, out, r);
+        out.push_back('\n');
+        std::cout << out;
     }
 }
 
+template <class Policy>
+void LogProcessor::output_pending_records() {
+    if (opt.top > 0) {
+        output_top_records<Policy>();
+        return;
+    }
+
+    // Pending blocks are the epoch's records in order, so the i-th one written
+    // is record i of `store`, whose counts are final by now.
+    std::size_t index = 0;
+    for (const auto& b : epoch->pending_blocks) write_record(index++, b);
+
+    std::string text;
+    std::size_t offset = 0;
+    for (const auto n : epoch->spill_lengths) {
+        spill.read(offset, n, text);
+        write_record(index++, text);
+        offset += n;
+    }
+
+    if (source == nullptr || epoch->pending_ranges.empty()) return;
+    source->clear(); // EOF was reached
+    std::string chunk;
+    for (const auto& r : epoch->pending_ranges) {
+        render_source_range<Policy>(chunk, text, r);
+        write_record(index++, text);
+    }
+}
+
+template <class Policy>
+void LogProcessor::output_top_records() {
+    // Record i's text is pending block i, the next spilled one, or the next range.
+    const std::size_t in_memory = epoch->pending_blocks.size();
+    const std::size_t spilled   = epoch->spill_lengths.size();
+    std::vector<std::size_t> spill_offsets(spilled);
+    std::exclusive_scan(epoch->spill_lengths.begin(), epoch->spill_lengths.end(), spill_offsets.begin(), std::size_t{0});
+    if (source != nullptr) source->clear(); // EOF was reached
+
+    std::string text;
+    std::string chunk;
+    for (const std::uint32_t i : top_records()) {
+        if (i < in_memory) {
+            write_record(i, epoch->pending_blocks[i]);
+            continue;
+        }
+        if (const std::size_t s = i - in_memory; s < spilled) {
+            spill.read(spill_offsets[s], epoch->spill_lengths[s], text);
+        } else {
+            render_source_range<Policy>(chunk, text, epoch->pending_ranges[s - spilled]);
+        }
+        write_record(i, text);
+    }
+}
+
+std::vector<std::uint32_t> LogProcessor::top_records() const {
+    // Bounded heap of the best `top` records so far, the weakest at the front;
+    // counts are exact, so ties are the only order left to break (output order).
+    const bool by_bytes = opt.rank_by == RankBy::Bytes;
+    const auto value    = [&](std::uint32_t i) -> std::uint64_t {
+        return by_bytes ? store.bytes(i) : store.occurrences(i);
+    };
+    const auto ranks_before = [&](std::uint32_t a, std::uint32_t b) {
+        const auto va = value(a);
+        const auto vb = value(b);
+        return va != vb ? va > vb : a < b;
+    };
+
+    std::vector<std::uint32_t> heap;
+    heap.reserve(std::min(opt.top, store.size()));
+    for (std::uint32_t i = 0; i < store.size(); ++i) {
+        if (by_bytes && !is_leak_kind(store.kind(i))) continue;
+        if (heap.size() < opt.top) {
+            heap.push_back(i);
+            std::ranges::push_heap(heap, ranks_before);
+        } else if (ranks_before(i, heap.front())) {
+            std::ranges::pop_heap(heap, ranks_before);
+            heap.back() = i;
+            std::ranges::push_heap(heap, ranks_before);
+        }
+    }
+    std::ranges::sort_heap(heap, ranks_before);
+    return heap;
+}
+
+void LogProcessor::write_record(std::size_t index, std::string_view text) {
+    while (text.ends_with('\n')) text.remove_suffix(1);
+    if (!opt.result_file.empty()) {
+        if (!results) results.emplace(opt.result_file);
+        results->add(store, index, text);
+    }
+    if (!opt.suppressions_file.empty()) {
+        if (!suppressions) suppressions.emplace(opt.suppressions_file, depth_limit, canon_rules);
+        suppressions->add(store, index, tool);
+    }
+    if (on_block) {
+        on_block(index, text);
+        return;
+    }
+    if (opt.format == OutputFormat::Text) {
+        std::cout << text << "\n\n";
+        return;
+    }
+    if (!records) records.emplace(std::cout, opt.format);
+    records->write(store, index, text);
+    if (live) records->flush();
+}
+
+void LogProcessor::finish_records() {
+    // An empty run still writes a document ("[]") and a result file.
+    if (!opt.result_file.empty()) {
+        if (!results) results.emplace(opt.result_file);
+        results->finish();
+        results.reset();
+    }
+    if (!opt.suppressions_file.empty()) {
+        if (!suppressions) suppressions.emplace(opt.suppressions_file, depth_limit, canon_rules);
+        suppressions->finish();
+        suppressions.reset();
+    }
+    if (opt.format == OutputFormat::Text || on_block) return;
+    if (!records) records.emplace(std::cout, opt.format);
+    records->finish();
+}
+
+template <class Policy>
+void LogProcessor::render_source_range(std::string& chunk, std::string& out, const SourceRange& range) {
+    chunk.resize(static_cast<std::size_t>(range.length));
+    source->seekg(static_cast<std::streamoff>(range.offset));
+    if (!source->read(chunk.data(), static_cast<std::streamsize>(range.length))) {
+        throw std::runtime_error("Failed to re-read a pending block (input changed during processing?)");
+    }
+
+    // Same line filter as process_line; among its PID's lines the range holds
+    // exactly one block, so the start-pattern checks are not needed here.
+    out.clear();
+    std::string_view rest{chunk};
+    while (!rest.empty()) {
+        const auto nl = rest.find('\n');
+        const std::string_view line = rest.substr(0, nl);
+        rest.remove_prefix(nl == std::string_view::npos ? rest.size() : nl + 1);
+
+        if (!matches_vg_line(line) || line_pid(line) != range.pid) continue;
+        const std::string_view processed = strip_prefix(line);
+        if (scrubs_to_blank<Policy>(processed)) continue;
+        if constexpr (Policy::scrub) out.append(scrubbed_line(processed));
+        else                         out.append(processed);
+        out.push_back('\n');
+    }
+}
+
+void LogProcessor::add_pending_block(std::string_view text) {
+    if (opt.max_memory_mb == 0 && epoch->pending_bytes >= next_budget_check) retune_pending_budget();
+    if (!spill.empty() || epoch->pending_bytes + text.size() + 1 > pending_budget) {
+        // Over budget: append to the spill file. Once spilling starts every later
+        // block of the epoch goes there too, so output order is preserved.
+        spill.append(text);
+        spill.append("\n");
+        epoch->spill_lengths.push_back(text.size() + 1);
+        return;
+    }
+    auto& out = epoch->pending_blocks.emplace_back();
+    out.reserve(text.size() + 1);
+    out.append(text).push_back('\n');
+    epoch->pending_bytes += out.size();
+}
+
+// Without --max-memory the budget follows the memory actually free: what is
+// pending plus half the remaining headroom, re-sampled as pending output grows.
+// If memory cannot be measured a fixed byte budget applies instead.
+void LogProcessor::retune_pending_budget() {
+    next_budget_check = epoch->pending_bytes + BUDGET_RECHECK_BYTES;
+    if (!governor) governor.emplace(opt.system_root);
+    if (const auto room = governor->sample().headroom()) {
+        pending_budget = std::max<std::size_t>(epoch->pending_bytes + *room / 2, 1);
+    } else {
+        pending_budget = FALLBACK_PENDING_BYTES;
+    }
+}
+
+void LogProcessor::process_xml(std::istream& in) {
+    dispatch([&]<class Policy>() { process_xml_impl<Policy>(in); });
+}
+
+template <class Policy>
+void LogProcessor::process_xml_impl(std::istream& in) {
+    // Blocks arrive whole, one element each, and the document has no marker
+    // lines: every block counts and, as text, is written as soon as it closes.
+    // Records wait for the end of the document, when their counts are final.
+    marker_found = true;
+    live         = !defer_output;
+    source       = nullptr;
+    route_unique_blocks();
+
+    class Sink final : public XmlBlockSink {
+    public:
+        explicit Sink(LogProcessor& processor) : p(processor) {}
+        void begin_block(std::uint32_t pid, BlockKind kind) override {
+            p.select_pid(pid);
+            p.flush<Policy>();
+            p.cur->kind = kind;
+            first       = true;
+        }
+        void line(std::string_view text) override {
+            // Same as a start line of the text log: a leak record's figures are kept aside.
+            if (first && p.matches_bytes_head(text)) p.cur->head.assign(text);
+            else                                     p.add_line<Policy>(text);
+            first = false;
+        }
+        void end_block() override { p.flush<Policy>(); }
+        [[nodiscard]] bool done() const noexcept override { return p.stop_requested; }
+
+    private:
+        LogProcessor& p;
+        bool          first{false};
+    } sink{*this};
+
+    read_valgrind_xml(in, sink);
+
+    if (stop_requested) clear_all_blocks();
+    else                flush_all<Policy>();
+    if (!live) output_pending_blocks<Policy>();
+    finish_records();
+    report_statistics();
+}
+
 void LogProcessor::process_lines(const VecS& lines) {
-    std::size_t start_index = 0;
+    std::size_t i = 0;
     if (opt.trim) {
-        start_index = find_marker(lines);
-        if (start_index == 0) return; // trim requested but no marker found → nothing
+        i = find_marker(lines);
+        if (i == 0) { // trim requested but no marker found → nothing
+            finish_records();
+            return;
+        }
+        for (std::size_t h = 0; h < i && tool_probe_left > 0; ++h) probe_tool(lines[h]);
+    }
+    run_lines([&]<class Policy>() {
+        while (i < lines.size() && !stop_requested) {
+            const Str& line = lines[i++];
+            validate_line_length(line);
+            process_line<Policy>(line);
+            if (Policy::probing && tool_probe_left == 0) return;
+        }
+    });
+    dispatch([&]<class Policy>() {
+        if (stop_requested) clear_all_blocks();
+        else                flush_all<Policy>();
+        if (defer_output) output_pending_blocks<Policy>();
+    });
+    finish_records();
+    report_statistics();
+}
+
+void LogProcessor::process_buffer(std::string_view data) {
+    if (opt.trim) {
+        const std::size_t start = find_marker(data);
+        if (start == 0) { // trim requested but no marker found → nothing
+            finish_records();
+            return;
+        }
+        for (auto head = data.substr(0, start); !head.empty() && tool_probe_left > 0;) {
+            const auto nl = head.find('\n');
+            probe_tool(head.substr(0, nl));
+            head.remove_prefix(nl == std::string_view::npos ? head.size() : nl + 1);
+        }
+        data.remove_prefix(start);
+    }
+    run_lines([&]<class Policy>() {
+        while (!data.empty() && !stop_requested) {
+            const auto nl = data.find('\n');
+            const std::string_view line = data.substr(0, nl);
+            data.remove_prefix(nl == std::string_view::npos ? data.size() : nl + 1);
+            validate_line_length(line);
+            process_line<Policy>(line);
+            if (Policy::probing && tool_probe_left == 0) return;
+        }
+    });
+    dispatch([&]<class Policy>() {
+        if (stop_requested) clear_all_blocks();
+        else                flush_all<Policy>();
+        if (defer_output) output_pending_blocks<Policy>();
+    });
+    finish_records();
+    report_statistics();
+}
+
+void LogProcessor::index_buffer(std::string_view data, LogIndexWriter& out) {
+    // The open block of each PID, segmented as process_line() does, but with
+    // the lines' positions in `data` instead of their text.
+    struct OpenBlock {
+        IndexBlock             block{};
+        bool                   opened{false};
+        std::vector<IndexLine> lines;
+        std::uint64_t          started{0}; // order of its first line, for the end of input
+    };
+    using Scrubbed = ProcessingPolicy<false, false, true, true, Segmentation::Memcheck>;
+    std::unordered_map<std::uint32_t, OpenBlock> open;
+    const auto offset_of = [&](std::string_view s) { return static_cast<std::uint64_t>(s.data() - data.data()); };
+    const auto emit = [&](OpenBlock& b) {
+        if (!b.lines.empty()) out.add_block(b.block, b.lines);
+        b.block  = {};
+        b.opened = false;
+        b.lines.clear();
+    };
+
+    for (std::string_view rest = data; !rest.empty();) {
+        const auto nl = rest.find('\n');
+        const std::string_view line = rest.substr(0, nl);
+        rest.remove_prefix(nl == std::string_view::npos ? rest.size() : nl + 1);
+        validate_line_length(line);
+        if (line.find(opt.marker) != std::string_view::npos) out.add_marker(offset_of(rest));
+
+        if (!matches_vg_line(line)) continue;
+        if (tool_probe_left > 0) probe_tool(line);
+        if (tool != ValgrindTool::Memcheck) throw std::runtime_error("Only Memcheck logs can be indexed");
+
+        const std::uint32_t pid = line_pid(line);
+        OpenBlock& b = open[pid];
+        const std::string_view processed = strip_prefix(line);
+        if (matches_start_pattern(processed)) {
+            emit(b);
+            b.opened      = true;
+            b.block.start = offset_of(line);
+            b.block.kind  = static_cast<std::uint8_t>(classify_block(processed));
+            if (matches_bytes_head(processed)) {
+                b.block.head_offset = offset_of(processed);
+                b.block.head_length = static_cast<std::uint32_t>(processed.size());
+                continue;
+            }
+        }
+        if (trim_view(processed).empty()) continue;
+
+        if (!b.opened) {
+            b.opened      = true;
+            b.block.start = offset_of(line);
+        }
+        if (b.lines.empty()) b.started = ++blocks_started;
+        b.block.pid = pid;
+        const std::uint32_t flags = scrubs_to_blank<Scrubbed>(processed) ? INDEX_SCRUBS_BLANK : 0;
+        b.lines.push_back({offset_of(processed), static_cast<std::uint32_t>(processed.size()) | flags,
+                           out.intern(canonical_line(processed))});
+        if (processed.starts_with(ERROR_SUMMARY)) emit(b);
+    }
+
+    std::vector<OpenBlock*> at_end;
+    for (auto& [pid, b] : open) {
+        if (!b.lines.empty()) at_end.push_back(&b);
+    }
+    std::ranges::sort(at_end, {}, [](const OpenBlock* b) { return b->started; });
+    for (OpenBlock* b : at_end) {
+        b->block.flags = INDEX_AT_END;
+        emit(*b);
+    }
+}
+
+void LogProcessor::process_indexed(const LogIndex& index, std::string_view data) {
+    // index_buffer() only accepts Memcheck logs.
+    route_unique_blocks();
+    dispatch_policy(opt, Segmentation::Memcheck, [&]<class Policy>() { process_indexed_impl<Policy>(index, data); });
+}
+
+template <class Policy>
+void LogProcessor::process_indexed_impl(const LogIndex& index, std::string_view data) {
+    // Lines before the last marker are dropped, as process_buffer() drops them.
+    std::uint64_t from = 0;
+    if (opt.trim) {
+        if (index.markers() == 0) { // trim requested but no marker found → nothing
+            finish_records();
+            return;
+        }
+        from         = index.marker_offset(index.markers() - 1);
+        marker_found = true;
+        route_unique_blocks();
+    }
+
+    // Blocks still open at the end of input go last, in the order of their
+    // first line in this run, as flush_all() orders them.
+    std::vector<std::pair<std::uint64_t, std::size_t>> at_end;
+    for (std::size_t b = 0; b < index.blocks() && !stop_requested; ++b) {
+        const IndexBlock block = index.block(b);
+        if ((block.flags & INDEX_AT_END) == 0) {
+            flush_indexed<Policy>(index, data, b, from);
+            continue;
+        }
+        for (std::uint64_t i = block.first_line; i < block.first_line + block.lines; ++i) {
+            if (const IndexLine l = index.line(i); accepts<Policy>(l, from)) {
+                at_end.emplace_back(l.offset, b);
+                break;
+            }
+        }
+    }
+    std::ranges::sort(at_end);
+    for (const auto& [offset, b] : at_end) {
+        if (stop_requested) break;
+        flush_indexed<Policy>(index, data, b, from);
+    }
+    if (Policy::stream || defer_output) output_pending_blocks<Policy>();
+    finish_records();
+    report_statistics();
+}
+
+template <class Policy>
+void LogProcessor::flush_indexed(const LogIndex& index, std::string_view data, std::size_t b, std::uint64_t from) {
+    const IndexBlock block = index.block(b);
+    // A block the marker cut in two continues as a block without a start line.
+    const bool whole = block.start >= from;
+    const std::uint64_t end = block.first_line + block.lines;
+    const auto text = [&](const IndexLine& l) { return data.substr(l.offset, l.length & ~INDEX_SCRUBS_BLANK); };
+
+    select_pid(block.pid);
+    cur->kind = whole ? static_cast<BlockKind>(block.kind) : BlockKind::Other;
+
+    // The key first, from the canonical lines: a duplicate only needs its
+    // header for the counts, so its text is never touched.
+    std::string_view header = whole ? data.substr(block.head_offset, block.head_length) : std::string_view{};
+    for (std::uint64_t i = block.first_line; i < end; ++i) {
+        const IndexLine l = index.line(i);
+        if (!accepts<Policy>(l, from)) continue;
+        if (!Policy::unlimited_depth && cur->sig_lines >= depth_limit) break;
+        if (header.empty()) header = text(l);
+        cur->sig.append(index.string(l.canonical)).push_back('\n');
+        ++cur->sig_lines;
+    }
+    if (cur->sig_lines == 0) {
+        clear_current_state();
+        return;
+    }
+    if (const auto it = epoch->seen.find(fingerprint(cur->sig)); it != epoch->seen.end()) {
+        if (it->second != BlockStore::npos) store.add_occurrence(it->second, header_counts_of(cur->kind, header));
+        clear_current_state();
+        return;
     }
-    for (std::size_t i = start_index; i < lines.size(); ++i) {
-        validate_line_length(lines[i]);
-        process_line(lines[i]);
+
+    if (whole && block.head_length > 0) cur->head.assign(data.substr(block.head_offset, block.head_length));
+    for (std::uint64_t i = block.first_line; i < end; ++i) {
+        if (const IndexLine l = index.line(i); accepts<Policy>(l, from)) append_block_line(text(l));
     }
-    flush();
+    flush<Policy>();
 }
 
+template <class Policy>
 void LogProcessor::process_line(std::string_view line) {
-    if (opt.trim && opt.stream_mode && line.find(opt.marker) != std::string_view::npos) {
+    if (Policy::watch_marker && line.find(opt.marker) != std::string_view::npos) {
         marker_found = true;
         reset_epoch();
+        route_unique_blocks();
         return; // skip marker itself
     }
 
+    const auto prefix = vg_prefix(line);
+    if (!prefix) return;
+    if constexpr (Policy::probing) {
+        if (tool_probe_left > 0) probe_tool(line);
+    }
+    if (prefix->pid != active->pid) [[unlikely]] select_pid(prefix->pid);
+
+    const std::string_view processed = line.substr(prefix->body);
+
+    if (!memcheck_segmentation<Policy>()) {
+        const auto [role, kind] = classify_thread_line(tool, processed);
+        if (role != LineRole::Body) {
+            flush<Policy>();
+            if (role == LineRole::Separator) return;
+            cur->kind = kind;
+        }
+    } else if (matches_start_pattern(processed)) {
+        flush<Policy>();
+        cur->kind = classify_block(processed);
+        if (matches_bytes_head(processed)) {
+            cur->head.assign(processed); // not output, but the block record needs it
+            return;
+        }
+    }
+
+    add_line<Policy>(processed);
+}
+
+template <class Policy>
+void LogProcessor::add_line(std::string_view processed) {
+    if (scrubs_to_blank<Policy>(processed)) return;
+
+    append_block_line(processed);
+
+    // Only the first `depth` canonical lines take part in the key. A race's key
+    // is built from both of its sides when it is flushed.
+    if ((Policy::unlimited_depth || cur->sig_lines < depth_limit) && cur->kind != BlockKind::DataRace) {
+        cur->sig.append(canonical_line(processed)).push_back('\n');
+        ++cur->sig_lines;
+    }
+
+    // Valgrind's last line for a process: nothing more joins its block. This
+    // holds for any input, so in concatenated logs the next run's banner
+    // starts a block of its own (index_buffer() segments the same way).
+    if (processed.starts_with(ERROR_SUMMARY)) flush<Policy>();
+}
+
+void LogProcessor::probe_tool(std::string_view line) {
+    // The banner is the first line Valgrind writes for a process.
     if (!matches_vg_line(line)) return;
+    --tool_probe_left;
+    if (const auto t = detect_tool(strip_prefix(line))) {
+        tool            = *t;
+        tool_probe_left = 0;
+    }
+}
 
-    std::string processed = replace_prefix(line);
+template <class Policy>
+bool LogProcessor::scrubs_to_blank(std::string_view processed_line) const {
+    if constexpr (!Policy::scrub) return trim_view(processed_line).empty();
+
+    // Scrubbing only erases hex addresses, "at : "/"by : " and runs of '?', so a
+    // line holding any other non-space character survives; skip the scrub for it.
+    const bool maybe_blank = std::ranges::all_of(processed_line, [](char c) {
+        return std::isxdigit(static_cast<unsigned char>(c)) || is_space(c) ||
+               c == 'x' || c == 't' || c == 'y' || c == ':' || c == '?';
+    });
+    return maybe_blank && trim_view(scrubbed_line(processed_line)).empty();
+}
 
-    if (matches_start_pattern(processed)) {
-        flush();
-        if (matches_bytes_head(processed)) return;
+void LogProcessor::append_block_line(std::string_view processed_line) {
+    if (cur->spans.empty()) {
+        cur->source_begin = line_begin;
+        cur->started      = ++blocks_started;
     }
+    cur->source_end = line_end;
+    cur->spans.push_back({static_cast<std::uint32_t>(cur->text.size()),
+                          static_cast<std::uint32_t>(processed_line.size())});
+    cur->text.append(processed_line);
+    validate_block_size(cur->text.size());
+}
 
-    auto rawLine = process_raw_line(processed);
-    if (trim_view(rawLine).empty()) return;
+const std::string& LogProcessor::canonical_line(std::string_view processed_line) const {
+    return frame_cache.canonical(processed_line, [this](std::string_view l, std::string& out) {
+        if (demangler.demangle_line(l, demangled)) l = demangled;
+        if (canon_rules.empty()) out.assign(l);
+        else                     canon_rules.apply(l, out);
+        canon_in_place(out);
+    });
+}
 
-    raw.append(rawLine).push_back('\n');
+const std::string& LogProcessor::scrubbed_line(std::string_view processed_line) const {
+    return frame_cache.scrubbed(processed_line, [this](std::string_view l, std::string& out) {
+        out.assign(l);
+        replace_patterns(out);
+    });
+}
 
-    const auto cl = canon(processed);
-    sig.append(cl).push_back('\n');
-    sigLines.push_back(cl);
+void LogProcessor::report_statistics() const {
+    if (!opt.monitor_memory) return;
+    report_frame_cache_stats(std::cerr, frame_cache.stats());
+    if (demangler.size() > 0) {
+        std::cerr << "Demangle cache: " << demangler.size() << " symbols, " << demangler.hits() << " hits\n";
+    }
 }
 
-std::string LogProcessor::process_raw_line(const std::string& processed_line) const {
-    if (!opt.scrub_raw) return processed_line;
-    return replace_patterns(processed_line);
+template <class Policy>
+void LogProcessor::render_raw_block() {
+    auto& raw = cur->raw;
+    raw.clear();
+    raw.reserve(cur->text.size() + cur->spans.size());
+    for (const auto& s : cur->spans) {
+        const std::string_view text = std::string_view{cur->text}.substr(s.offset, s.length);
+        if constexpr (Policy::scrub) raw.append(scrubbed_line(text));
+        else                         raw.append(text);
+        raw.push_back('\n');
+    }
 }
 
+template <class Policy>
 void LogProcessor::flush() {
-    if (raw.empty()) {
+    if (cur->spans.empty()) {
         clear_current_state();
         return;
     }
 
-    validate_block_size(raw.size());
+    if (!memcheck_segmentation<Policy>() || is_thread_kind(cur->kind)) thread_signature();
 
-    const std::string key = generate_signature_key();
-    if (seen.insert(key).second) {
-        if (opt.stream_mode) {
-            validate_pending_blocks_count(pending_blocks.size());
-            pending_blocks.emplace_back(raw + '\n');
-        } else {
-            std::cout << raw << '\n';
+    // `sig` is the signature key; the raw text is only scrubbed and copied when
+    // the key is new, so duplicate blocks cost little more than a hash lookup.
+    const std::uint64_t fp = fingerprint(cur->sig);
+    const auto [it, unique] = epoch->seen.try_emplace(fp, BlockStore::npos);
+    if (!unique) {
+        if (it->second != BlockStore::npos) store.add_occurrence(it->second, header_counts());
+    } else if (!suppression_set.empty() && suppressed()) {
+        // Seen but never recorded, so its duplicates are dropped as well.
+    } else {
+        it->second = record_block(fp);
+        switch (route) {
+            case Route::Print:
+                render_raw_block<Policy>();
+                std::cout << cur->raw << '\n';
+                break;
+            case Route::Record:
+                render_raw_block<Policy>();
+                write_record(it->second, cur->raw); // counts so far
+                break;
+            case Route::Pending:
+                // Records are held until the end of input, when their counts are final.
+                render_raw_block<Policy>();
+                add_pending_block(cur->raw);
+                break;
+            case Route::Range:
+                epoch->pending_ranges.push_back({cur->source_begin, cur->source_end - cur->source_begin, active->pid});
+                break;
+            case Route::Drop:
+                break;
         }
+        note_unique_block<Policy>();
     }
     clear_current_state();
 }
 
-std::string LogProcessor::generate_signature_key() const {
-    if (opt.depth <= 0) return sig;
+void LogProcessor::thread_signature() {
+    // Thread numbers differ between runs and between threads running the same code.
+    if (cur->kind == BlockKind::DataRace) race_signature();
+    cur->sig.resize(neutralize_thread_ids(cur->sig));
+}
+
+void LogProcessor::race_signature() {
+    // Helgrind words a race from whichever access came second, so the same pair
+    // shows up either way round: key on both sides (access and top frames), sorted.
+    std::array<std::string, 2> sides;
+    std::size_t found      = 0;
+    std::size_t side_lines = 0;
+    bool        in_stack   = false;
+    const std::string_view text{cur->text};
+    for (const auto& s : cur->spans) {
+        const std::string_view line = text.substr(s.offset, s.length);
+        if (found < sides.size() && race_access(line, sides[found])) {
+            sides[found++].push_back('\n');
+            side_lines = 1;
+            in_stack   = true;
+            continue;
+        }
+        if (!in_stack || line.starts_with("Locks held")) continue;
+        if (!line.starts_with("at ") && !line.starts_with("by ")) {
+            in_stack = false; // "Location 0x… is …", "Address …" and their stacks are not part of it
+            continue;
+        }
+        if (depth_limit == 0 || side_lines < depth_limit) {
+            sides[found - 1].append(canonical_line(line)).push_back('\n');
+            ++side_lines;
+        }
+    }
+    if (sides[1] < sides[0]) std::swap(sides[0], sides[1]);
+    cur->sig.assign(sides[0]).append("~\n").append(sides[1]);
+}
+
+bool LogProcessor::suppressed() {
+    // The block's own stack: frames up to the first other line after them.
+    stack_scratch.clear();
+    const std::string_view text{cur->text};
+    for (const auto& s : cur->spans) {
+        if (const auto f = parse_frame(text.substr(s.offset, s.length))) stack_scratch.push_back(*f);
+        else if (!stack_scratch.empty()) break;
+    }
+    return suppression_set.matches(tool, cur->kind, block_header(), stack_scratch);
+}
+
+std::string_view LogProcessor::block_header() const noexcept {
+    if (!cur->head.empty()) return cur->head;
+    return std::string_view{cur->text}.substr(0, cur->spans.front().length);
+}
+
+HeaderCounts LogProcessor::header_counts() const noexcept {
+    return header_counts_of(cur->kind, block_header());
+}
+
+std::uint32_t LogProcessor::record_block(std::uint64_t fp) {
+    const auto index = store.add(cur->kind, fp, block_header(), header_counts());
+    for (const auto& s : cur->spans) store.add_line(std::string_view{cur->text}.substr(s.offset, s.length));
+    return index;
+}
+
+template <class Policy>
+void LogProcessor::note_unique_block() {
+    // Only blocks that reach the output count: in a trimmed stream that means
+    // those after a marker.
+    if constexpr (Policy::watch_marker) {
+        if (!marker_found) return;
+    }
+    ++epoch->unique_blocks;
+
+    if ((opt.fail_on & kind_bit(cur->kind)) != 0) {
+        matched_kind   = cur->kind;
+        stop_requested = true;
+        std::cerr << "Info: --fail-on: found kind " << block_kind_name(cur->kind) << ", stopping\n";
+    }
+    if (opt.max_unique > 0 && epoch->unique_blocks >= opt.max_unique) stop_requested = true;
+}
 
-    std::string key;
-    key.reserve(256);
-    for (const auto& line : sigLines | std::views::take(static_cast<std::size_t>(opt.depth))) {
-        key.append(line).push_back('\n');
+template <class Policy>
+void LogProcessor::flush_all() {
+    // End of input: close every process's open block, oldest first.
+    std::vector<PidBlock*> open;
+    for (const auto& [pid, slot] : pid_blocks) {
+        if (!slot->state->spans.empty()) open.push_back(slot.get());
+    }
+    std::ranges::sort(open, {}, [](const PidBlock* b) { return b->state->started; });
+    for (PidBlock* b : open) {
+        select_pid(b->pid);
+        flush<Policy>();
     }
-    return key;
 }
 
 void LogProcessor::clear_current_state() noexcept {
-    raw.clear();
-    sig.clear();
-    sigLines.clear();
+    // Drop the containers before rewinding the arena they were carved from.
+    active->state.reset();
+    active->arena.release();
+    active->state.emplace(&active->arena);
+    cur = &*active->state;
+}
+
+void LogProcessor::clear_all_blocks() noexcept {
+    PidBlock* const keep = active;
+    for (const auto& [pid, slot] : pid_blocks) {
+        active = slot.get();
+        clear_current_state();
+    }
+    active = keep;
+    cur    = &*active->state;
 }
 
 void LogProcessor::reset_epoch() noexcept {
-    pending_blocks.clear();
-    seen.clear();
-    clear_current_state();
+    epoch.reset();
+    epoch_pool.release();
+    epoch.emplace(&epoch_pool);
+    spill.truncate();
+    store.clear();
+    next_budget_check = 0;
+    clear_all_blocks();
 }
 
 std::size_t LogProcessor::find_marker(const VecS& lines) const {
@@ -315,4 +1298,13 @@ std::size_t LogProcessor::find_marker(const VecS& lines) const {
         }
     }
     return 0;
+}
+
+std::size_t LogProcessor::find_marker(std::string_view data) const {
+    // Same answer as the line-based search: a marker spanning lines never matches
+    if (opt.marker.find('\n') != std::string::npos) return 0;
+    const auto at = data.rfind(opt.marker);
+    if (at == std::string_view::npos) return 0;
+    const auto nl = data.find('\n', at);
+    return nl == std::string_view::npos ? data.size() : nl + 1; // start *after* the marker line
 }
\ No newline at end of file
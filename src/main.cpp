@@ -5,10 +5,17 @@
 // the GNU General Public License v3.0 or later.
 // See the LICENSE file in the project root for details.
 
+#include "aggregation_server.h"
+#include "block_kind.h"
+#include "checkpoint.h"
+#include "file_follower.h"
 #include "file_utils.h"
+#include "log_index.h"
 #include "log_processor.h"
 #include "options.h"
 #include "path_validation.h"
+#include "resource_governor.h"
+#include "result_file.h"
 
 #include <algorithm>
 #include <charconv>
@@ -19,6 +26,7 @@
 #include <optional>
 #include <string>
 #include <string_view>
+#include <unistd.h>
 #include <vector>
 
 #ifndef VGLOG_FILTER_VERSION
@@ -32,8 +40,34 @@ namespace {
 
 inline constexpr int  MAX_DEPTH            = 1000;
 inline constexpr auto STDIN_SENTINEL       = std::string_view{"-"};
+inline constexpr auto SHOW_COMMAND         = std::string_view{"show"};
+inline constexpr auto INDEX_COMMAND        = std::string_view{"index"};
 inline constexpr auto VERSION_STRING       = std::string_view{TOSTRING(VGLOG_FILTER_VERSION)};
 inline constexpr int  MAX_MARKER_LENGTH    = 1024;
+inline constexpr int  MAX_CACHE_ENTRIES    = 1 << 24;
+inline constexpr int  MAX_MEMORY_MB        = 1 << 20;
+inline constexpr int  MAX_UNIQUE_BLOCKS    = std::numeric_limits<int>::max();
+inline constexpr int  EXIT_FAIL_ON_MATCH   = 2; // --fail-on found a block (1 is reserved for errors)
+
+// Long-only options use values outside the char range
+enum LongOnlyOption : int {
+    OPT_CANON_RULES = 256,
+    OPT_CACHE_SIZE,
+    OPT_MAX_MEMORY,
+    OPT_FOLLOW,
+    OPT_STATE,
+    OPT_MAX_UNIQUE,
+    OPT_FAIL_ON,
+    OPT_XML,
+    OPT_FORMAT,
+    OPT_RESULT_FILE,
+    OPT_GEN_SUPPRESSIONS,
+    OPT_SUPPRESSIONS,
+    OPT_TOP,
+    OPT_BY,
+    OPT_SERVE,
+    OPT_QUERY,
+};
 
 // getopt_long table
 // NOLINTNEXTLINE(modernize-avoid-c-arrays)
@@ -45,6 +79,22 @@ constinit option LONG_OPTS[] = {
     {"stream",          no_argument,       nullptr, 's'},
     {"progress",        no_argument,       nullptr, 'p'},
     {"memory",          no_argument,       nullptr, 'M'},
+    {"canon-rules",     required_argument, nullptr, OPT_CANON_RULES},
+    {"cache-size",      required_argument, nullptr, OPT_CACHE_SIZE},
+    {"max-memory",      required_argument, nullptr, OPT_MAX_MEMORY},
+    {"follow",          no_argument,       nullptr, OPT_FOLLOW},
+    {"state",           required_argument, nullptr, OPT_STATE},
+    {"max-unique",      required_argument, nullptr, OPT_MAX_UNIQUE},
+    {"fail-on",         required_argument, nullptr, OPT_FAIL_ON},
+    {"xml",             no_argument,       nullptr, OPT_XML},
+    {"format",          required_argument, nullptr, OPT_FORMAT},
+    {"result-file",     required_argument, nullptr, OPT_RESULT_FILE},
+    {"gen-suppressions", required_argument, nullptr, OPT_GEN_SUPPRESSIONS},
+    {"suppressions",    required_argument, nullptr, OPT_SUPPRESSIONS},
+    {"top",             required_argument, nullptr, OPT_TOP},
+    {"by",              required_argument, nullptr, OPT_BY},
+    {"serve",           required_argument, nullptr, OPT_SERVE},
+    {"query",           required_argument, nullptr, OPT_QUERY},
     {"version",         no_argument,       nullptr, 'V'},
     {"help",            no_argument,       nullptr, 'h'},
     {nullptr,           0,                 nullptr,  0 }
@@ -86,6 +136,12 @@ inline constexpr auto SHORT_OPTS = std::string_view{"kvd:m:spMVh"};
     return std::string{sv};
 }
 
+[[nodiscard]] RankBy parse_rank_by(std::string_view sv) {
+    if (sv == "count") return RankBy::Count;
+    if (sv == "bytes") return RankBy::Bytes;
+    throw std::runtime_error("Unknown ranking: '" + std::string(sv) + "' (expected count or bytes)");
+}
+
 // Returns std::nullopt when the program should exit early (help/version already printed).
 [[nodiscard]] std::optional<Options> parse_command_line(int argc, char* argv[]) {
     if (argc < 1 || argv == nullptr) {
@@ -108,6 +164,56 @@ inline constexpr auto SHORT_OPTS = std::string_view{"kvd:m:spMVh"};
             case 's': opt.stream_mode  = true;  break;
             case 'p': opt.show_progress = true; break;
             case 'M': opt.monitor_memory = true; break;
+            case OPT_CANON_RULES:
+                opt.canon_rules_file = path_validation::sanitize_path_for_file_access(optarg ? std::string_view{optarg} : std::string_view{});
+                break;
+            case OPT_CACHE_SIZE:
+                opt.frame_cache_entries = static_cast<size_t>(parse_nonneg_int(optarg ? std::string_view{optarg} : std::string_view{}, MAX_CACHE_ENTRIES));
+                break;
+            case OPT_MAX_MEMORY:
+                opt.max_memory_mb = static_cast<size_t>(parse_nonneg_int(optarg ? std::string_view{optarg} : std::string_view{}, MAX_MEMORY_MB));
+                break;
+            case OPT_FOLLOW:
+                opt.follow = true;
+                break;
+            case OPT_MAX_UNIQUE:
+                opt.max_unique = static_cast<size_t>(parse_nonneg_int(optarg ? std::string_view{optarg} : std::string_view{}, MAX_UNIQUE_BLOCKS));
+                break;
+            case OPT_FAIL_ON:
+                opt.fail_on = parse_block_kinds(optarg ? std::string_view{optarg} : std::string_view{});
+                break;
+            case OPT_TOP:
+                opt.top = static_cast<size_t>(parse_nonneg_int(optarg ? std::string_view{optarg} : std::string_view{}, MAX_UNIQUE_BLOCKS));
+                break;
+            case OPT_BY:
+                opt.rank_by = parse_rank_by(optarg ? std::string_view{optarg} : std::string_view{});
+                break;
+            case OPT_SERVE:
+                opt.serve_socket = optarg ? std::string{optarg} : std::string{};
+                if (opt.serve_socket.empty()) throw std::runtime_error("Socket path cannot be empty");
+                break;
+            case OPT_QUERY:
+                opt.query_socket = optarg ? std::string{optarg} : std::string{};
+                if (opt.query_socket.empty()) throw std::runtime_error("Socket path cannot be empty");
+                break;
+            case OPT_XML:
+                opt.xml_input = true;
+                break;
+            case OPT_FORMAT:
+                opt.format = parse_output_format(optarg ? std::string_view{optarg} : std::string_view{});
+                break;
+            case OPT_RESULT_FILE:
+                opt.result_file = path_validation::sanitize_path_for_file_access(optarg ? std::string_view{optarg} : std::string_view{});
+                break;
+            case OPT_GEN_SUPPRESSIONS:
+                opt.suppressions_file = path_validation::sanitize_path_for_file_access(optarg ? std::string_view{optarg} : std::string_view{});
+                break;
+            case OPT_SUPPRESSIONS:
+                opt.suppress_files.push_back(path_validation::sanitize_path_for_file_access(optarg ? std::string_view{optarg} : std::string_view{}));
+                break;
+            case OPT_STATE:
+                opt.state_file = path_validation::sanitize_path_for_file_access(optarg ? std::string_view{optarg} : std::string_view{});
+                break;
             case 'V':
                 std::cout << "vglog-filter version " << VERSION_STRING << '\n';
                 return std::nullopt;
@@ -123,6 +229,28 @@ inline constexpr auto SHORT_OPTS = std::string_view{"kvd:m:spMVh"};
     return opt;
 }
 
+// Picks in-memory, mapped or stream processing for a file input from its size
+// and the memory actually available to this process.
+void select_input_strategy(Options& opt) {
+    const auto size = regular_file_size(opt.filename);
+    if (!size) return; // in-memory reading reports the problem
+
+    const auto status   = ResourceGovernor{opt.system_root}.sample();
+    const auto strategy = choose_strategy(*size, status);
+    if (opt.monitor_memory) {
+        std::cerr << "Info: " << status.rss_bytes / (1024u * 1024u) << " MB resident";
+        if (const auto room = status.headroom()) std::cerr << ", " << *room / (1024u * 1024u) << " MB available";
+        std::cerr << "; using " << strategy_name(strategy) << " processing\n";
+    }
+    if (strategy == InputStrategy::InMemory) return;
+
+    const bool large = *size >= LARGE_FILE_THRESHOLD_MB * 1024u * 1024u;
+    std::cerr << "Info: " << (large ? "Large file detected" : "Low memory") << ", using "
+              << strategy_name(strategy) << " processing mode\n";
+    if (strategy == InputStrategy::Mapped) opt.map_input   = true;
+    else                                   opt.stream_mode = true;
+}
+
 void setup_input_source(Options& opt, int argc, char* argv[]) {
     if (optind >= argc) {
         opt.use_stdin = true;
@@ -141,40 +269,139 @@ void setup_input_source(Options& opt, int argc, char* argv[]) {
         }
     }
 
+    if (!opt.xml_input && !opt.use_stdin) opt.xml_input = is_xml_file(opt.filename);
+    if (opt.xml_input) {
+        // Elements are parsed as they arrive; the line-based modes do not apply.
+        if (opt.follow)              throw std::runtime_error("--follow does not support XML input");
+        if (!opt.state_file.empty()) throw std::runtime_error("--state does not support XML input");
+        opt.stream_mode = true;
+    }
+
+    if (opt.follow) {
+        if (opt.use_stdin) throw std::runtime_error("--follow requires a file argument");
+        // The document would never be closed; ndjson records stand alone.
+        if (opt.format == OutputFormat::Json || opt.format == OutputFormat::Sarif) {
+            throw std::runtime_error("--format json/sarif cannot be combined with --follow");
+        }
+        if (!opt.result_file.empty()) throw std::runtime_error("--result-file cannot be combined with --follow");
+        if (!opt.suppressions_file.empty()) throw std::runtime_error("--gen-suppressions cannot be combined with --follow");
+        if (opt.top > 0) throw std::runtime_error("--top cannot be combined with --follow");
+        opt.stream_mode = true; // the input never ends, so it is always streamed
+    }
+
+    if (!opt.state_file.empty()) {
+        if (opt.use_stdin) throw std::runtime_error("--state requires a file argument");
+        if (opt.follow)    throw std::runtime_error("--state cannot be combined with --follow");
+        opt.stream_mode = true; // resuming works on byte offsets
+    }
+
     // Auto-detect streaming when not explicitly requested
+    if (!opt.stream_mode && opt.max_memory_mb > 0) {
+        opt.stream_mode = true; // a memory budget only makes sense without loading the file
+    }
     if (!opt.stream_mode) {
-        opt.stream_mode = opt.use_stdin ? true : is_large_file(opt.filename);
-        if (opt.stream_mode && !opt.use_stdin) {
-            std::cerr << "Info: Large file detected, using stream processing mode\n";
-        }
+        if (opt.use_stdin) opt.stream_mode = true;
+        else               select_input_strategy(opt);
     }
 }
 
-void process_input(const Options& opt) {
+// Returns true when --fail-on found a block of a listed kind.
+[[nodiscard]] bool process_input(const Options& opt) {
     if (opt.monitor_memory) {
         report_memory_usage("starting processing", opt.filename);
     }
 
-    LogProcessor processor(opt);
-
-    if (opt.stream_mode) {
+    bool matched = false;
+    std::optional<bool> indexed;
+    if (!opt.use_stdin && !opt.xml_input && !opt.follow && opt.state_file.empty()) {
+        indexed = process_file_indexed(opt.filename, opt);
+    }
+    if (indexed) {
+        matched = *indexed;
+    } else if (opt.follow) {
+        matched = follow_file(opt.filename, opt);
+    } else if (!opt.state_file.empty()) {
+        matched = process_file_resumable(opt.filename, opt);
+    } else if (opt.stream_mode) {
         if (opt.use_stdin) {
-            processor.process_stream(std::cin);
+            LogProcessor processor(opt);
+            if (opt.xml_input || starts_like_xml(std::cin)) processor.process_xml(std::cin);
+            else                                            processor.process_stream(std::cin);
+            matched = processor.fail_on_match().has_value();
+            if (processor.stopped()) {
+                // Stop reading for good: the writer on the other end of the pipe
+                // gets SIGPIPE instead of producing output nobody reads.
+                ::close(STDIN_FILENO);
+            }
+        } else if (opt.xml_input) {
+            matched = process_file_xml(opt.filename, opt);
         } else {
-            process_file_stream(opt.filename, opt);
+            matched = process_file_stream(opt.filename, opt);
         }
+    } else if (opt.map_input) {
+        matched = process_file_mapped(opt.filename, opt);
     } else {
         const std::vector<std::string> lines = read_file_lines(opt.filename);
         if (lines.empty() && !opt.filename.empty() && opt.filename != STDIN_SENTINEL) {
             std::cerr << "Warning: Input file '" << opt.filename << "' is empty\n";
-            return;
+            return false;
         }
+        LogProcessor processor(opt);
         processor.process_lines(lines);
+        matched = processor.fail_on_match().has_value();
     }
 
     if (opt.monitor_memory) {
         report_memory_usage("completed processing", opt.filename);
     }
+    return matched;
+}
+
+// --serve SOCKET / --query SOCKET: input arrives over the socket, not as a file
+// argument. A stopped server prints the aggregate like a single run would.
+[[nodiscard]] int run_socket_mode(const Options& opt, int argc) {
+    if (!opt.serve_socket.empty() && !opt.query_socket.empty()) {
+        throw std::runtime_error("--serve and --query cannot be combined");
+    }
+    if (optind < argc) throw std::runtime_error("--serve and --query take no input file");
+    if (opt.follow || !opt.state_file.empty() || !opt.result_file.empty() || !opt.suppressions_file.empty() ||
+        opt.top > 0 || opt.max_unique > 0 || opt.fail_on != 0) {
+        throw std::runtime_error("--serve and --query cannot be combined with --follow, --state, --result-file, "
+                                 "--gen-suppressions, --top, --max-unique or --fail-on");
+    }
+    if (!opt.query_socket.empty()) {
+        query_server(opt.query_socket, opt.format, std::cout);
+        return 0;
+    }
+    AggregationServer server(opt.serve_socket, opt);
+    std::cerr << "Info: serving on " << opt.serve_socket << '\n';
+    server.run();
+    server.aggregate().write_report(std::cout, opt.format);
+    return 0;
+}
+
+// `show FILE [FINGERPRINT]`: renders a --result-file back to text output.
+[[nodiscard]] int run_show(int argc, char* argv[]) {
+    if (argc < 3 || argc > 4) throw std::runtime_error("Usage: vglog-filter show RESULT_FILE [FINGERPRINT]");
+    const std::string file = path_validation::sanitize_path_for_file_access(argv[2]);
+    std::optional<std::string_view> fp;
+    if (argc == 4) fp = std::string_view{argv[3]};
+    show_result_file(file, fp, std::cout);
+    return 0;
+}
+
+// `index [OPTIONS] LOG`: writes LOG.vgi for later runs over LOG; --canon-rules
+// and --marker are the ones those runs must use.
+[[nodiscard]] int run_index(int argc, char* argv[]) {
+    const auto parsed = parse_command_line(argc - 1, argv + 1);
+    if (!parsed) return 0;
+    if (optind + 1 != argc - 1) throw std::runtime_error("Usage: vglog-filter index [OPTIONS] LOG");
+    const std::string file = path_validation::sanitize_path_for_file_access(argv[optind + 1]);
+    if (is_xml_file(file)) throw std::runtime_error("XML logs cannot be indexed");
+    const std::size_t blocks = build_log_index(file, *parsed);
+    std::cerr << "Info: indexed " << blocks << " blocks of " << file << " into "
+              << index_path(file).filename().string() << '\n';
+    return 0;
 }
 
 } // namespace
@@ -185,10 +412,15 @@ int main(int argc, char* argv[]) {
     std::cin.tie(nullptr);
 
     try {
+        // Only a bare first argument names a subcommand: `-- show` and `./show`
+        // (or any option before it) filter a log file called show.
+        if (argc >= 2 && std::string_view{argv[1]} == SHOW_COMMAND) return run_show(argc, argv);
+        if (argc >= 2 && std::string_view{argv[1]} == INDEX_COMMAND) return run_index(argc, argv);
         if (auto parsed = parse_command_line(argc, argv)) {
             auto& opt = *parsed;
+            if (!opt.serve_socket.empty() || !opt.query_socket.empty()) return run_socket_mode(opt, argc);
             setup_input_source(opt, argc, argv);
-            process_input(opt);
+            if (process_input(opt)) return EXIT_FAIL_ON_MATCH;
         } else {
             // Help/version printed; normal exit.
             return 0;
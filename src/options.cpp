@@ -7,28 +7,101 @@
 
 #include "options.h"
 #include <sstream>
+#include <stdexcept>
+
+OutputFormat parse_output_format(std::string_view sv) {
+    if (sv == "text")   return OutputFormat::Text;
+    if (sv == "ndjson") return OutputFormat::Ndjson;
+    if (sv == "json")   return OutputFormat::Json;
+    if (sv == "sarif")  return OutputFormat::Sarif;
+    throw std::runtime_error("Unknown output format: '" + std::string(sv) + "' (expected text, ndjson, json or sarif)");
+}
+
+std::string_view output_format_name(OutputFormat format) noexcept {
+    switch (format) {
+        case OutputFormat::Text:   return "text";
+        case OutputFormat::Ndjson: return "ndjson";
+        case OutputFormat::Json:   return "json";
+        case OutputFormat::Sarif:  return "sarif";
+    }
+    return "text";
+}
 
 void usage(std::string_view prog) {
-    std::cout << "Usage: " << prog << " [options] [valgrind_log]\n\n"
+    std::cout << "Usage: " << prog << " [options] [valgrind_log]\n"
+       << "       " << prog << " show RESULT_FILE [FINGERPRINT]\n"
+       << "       " << prog << " index [--canon-rules FILE] [--marker S] valgrind_log\n"
+       << "       " << prog << " --serve SOCKET | --query SOCKET [options]\n\n"
        << "Input\n"
        << "  valgrind_log            Path to Valgrind log file (default: stdin if omitted)\n"
-       << "  -                       Read from stdin (explicit)\n\n"
+       << "  -                       Read from stdin (explicit)\n"
+       << "  -- FILE, ./FILE         A log named `show` or `index`: as a first argument those\n"
+       << "                          words start the subcommands, so write `-- show` or `./show`.\n\n"
        << "Options\n"
        << "  -k, --keep-debug-info   Keep everything; do not trim above last debug marker.\n"
        << "  -v, --verbose           Show completely raw blocks (no address / \"at:\" scrub).\n"
        << "  -d N, --depth N         Signature depth (default: " << DEFAULT_DEPTH << ", 0 = unlimited).\n"
        << "  -m S, --marker S        Marker string (default: \"" << DEFAULT_MARKER << "\").\n"
-       << "  -s, --stream            Force stream processing mode (auto-detected for files >5MB).\n"
+       << "  -s, --stream            Force stream processing mode (otherwise chosen from file size\n"
+       << "                          and free memory, including cgroup limits).\n"
        << "  -p, --progress          Show progress for large files.\n"
-       << "  -M, --memory            Monitor memory usage during processing.\n"
+       << "  --xml                   Input is Valgrind --xml=yes output (detected automatically when\n"
+       << "                          it starts with '<'); it is parsed as it streams in.\n"
+       << "  --format FMT            Output as text (default), ndjson (one JSON record per unique\n"
+       << "                          block), json (one array) or sarif (SARIF 2.1.0, one result\n"
+       << "                          per unique block). Records carry kind, fingerprint, frames,\n"
+       << "                          text and final occurrence/byte counts.\n"
+       << "  --result-file FILE      Also write the unique blocks, counts and fingerprints to FILE in\n"
+       << "                          a binary, mmap-able format with an O(1) fingerprint index.\n"
+       << "                          `show RESULT_FILE` prints it back as text output; with a hex\n"
+       << "                          FINGERPRINT (as in --format ndjson) only that block.\n"
+       << "  --gen-suppressions FILE Write a Valgrind suppression for each unique block to FILE, from\n"
+       << "                          the first --depth frames of its stack; details the signature\n"
+       << "                          ignores become wildcards and identical entries are merged.\n"
+       << "                          C++ frames need a log from valgrind --demangle=no to get\n"
+       << "                          exact fun: lines; demangled ones fall back to obj: or fun:*.\n"
+       << "  --suppressions FILE     Drop blocks matched by the Valgrind suppressions in FILE, as\n"
+       << "                          valgrind --suppressions would (repeatable).\n"
+       << "  --max-memory MB         Stream mode: keep at most MB of pending output in memory and\n"
+       << "                          spill the rest to an unlinked temp file (implies --stream).\n"
+       << "  --max-unique N          Stop reading after N unique blocks and print them.\n"
+       << "  --top K                 Output only the K highest-ranked unique blocks, best first, once\n"
+       << "                          the input has been read.\n"
+       << "  --by count|bytes        Rank --top by occurrences (default) or by bytes lost, which\n"
+       << "                          ranks leak records only.\n"
+       << "  --fail-on KINDS         Stop at the first block of a listed kind and exit with status 2.\n"
+       << "                          KINDS is a comma-separated list of: invalid-read, invalid-write,\n"
+       << "                          syscall-param, uninitialised, definitely-lost, indirectly-lost,\n"
+       << "                          possibly-lost, still-reachable, fatal, data-race, lock-order,\n"
+       << "                          thread-api, other, or any.\n"
+       << "  --state FILE            Resume from the checkpoint in FILE and update it on exit, so a\n"
+       << "                          growing log is only processed from where the last run stopped.\n"
+       << "  --follow                Keep watching FILE (inotify) and print each new unique block as\n"
+       << "                          it completes; handles truncation and rotation. Stop with Ctrl-C.\n"
+       << "  --serve SOCKET          Run as a daemon on Unix socket SOCKET: each connection is one log,\n"
+       << "                          filtered by a shared worker pool, and all of them are deduped into\n"
+       << "                          one aggregate. A connection sending `REPORT [FMT]` as its first\n"
+       << "                          line gets the aggregate back. Stop with Ctrl-C or SIGTERM; the\n"
+       << "                          aggregate is then printed.\n"
+       << "  --query SOCKET          Print the aggregate of the server on SOCKET (in --format).\n"
+       << "  -M, --memory            Monitor memory usage (and frame cache statistics) during processing.\n"
+       << "  --canon-rules FILE      Extra signature normalizations, one `PATTERN => REPLACEMENT` per line.\n"
+       << "  --cache-size N          Frame cache entries for canonical/scrubbed lines (default: "
+       << DEFAULT_FRAME_CACHE_ENTRIES << ", 0 = off).\n"
        << "  -V, --version           Show version information.\n"
        << "  -h, --help              Show this help.\n\n"
        << "Notes\n"
        << "  • In stream mode (including stdin), the tool outputs only the region after the *last*\n"
-       << "    marker encountered (if any). If no marker is found, the entire input is processed.\n\n"
+       << "    marker encountered (if any). If no marker is found, the entire input is processed.\n"
+       << "  • `index LOG` writes LOG.vgi with the blocks, canonical lines and marker positions of\n"
+       << "    a Memcheck text log. Later runs over LOG (same --canon-rules; same --marker when\n"
+       << "    trimming) read it instead of parsing the log, at any --depth; a stale one is ignored.\n"
+       << "  • --canon-rules patterns support literals, '.', [classes], \\d \\w \\s and * + ?;\n"
+       << "    e.g. `{lambda([^)]*)#\\d+} => {lambda}` or `Thread #\\d+ => Thread #N`.\n\n"
        << "Examples\n"
        << "  " << prog << " log.txt                 # Process file\n"
        << "  " << prog << " < log.txt               # Process from stdin\n"
        << "  " << prog << " - < log.txt             # Explicit stdin\n"
-       << "  valgrind ./prog 2>&1 | " << prog << "     # Direct pipe from valgrind\n";
+       << "  valgrind ./prog 2>&1 | " << prog << "     # Direct pipe from valgrind\n"
+       << "  valgrind ./prog 2>&1 | nc -UN vglog.sock   # Send a run to " << prog << " --serve vglog.sock\n";
 }
@@ -0,0 +1,153 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include "resource_governor.h"
+
+#include "options.h"
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <unistd.h>
+
+namespace {
+
+constinit inline std::size_t MB_TO_BYTES         = 1024u * 1024u;
+constinit inline std::size_t IN_MEMORY_OVERHEAD  = 4;  // line vector ≈ 4× the file size
+constinit inline std::size_t CGROUP_V1_UNLIMITED = std::size_t{1} << 62; // "no limit" is a huge page-rounded value
+
+[[nodiscard]] std::optional<std::size_t> parse_size(std::string_view sv) noexcept {
+    std::size_t value = 0;
+    const auto [end, ec] = std::from_chars(sv.data(), sv.data() + sv.size(), value);
+    if (ec != std::errc{} || end == sv.data()) return std::nullopt;
+    return value;
+}
+
+// First line of a small procfs/cgroupfs file; empty when unreadable.
+[[nodiscard]] std::string read_first_line(const std::filesystem::path& p) {
+    std::ifstream in(p);
+    std::string line;
+    std::getline(in, line);
+    return line;
+}
+
+[[nodiscard]] std::size_t read_cgroup_value(const std::filesystem::path& p) {
+    const std::string text = read_first_line(p);
+    const auto value = parse_size(text);  // "max" (v2) fails to parse: no limit
+    if (!value || *value >= CGROUP_V1_UNLIMITED) return 0;
+    return *value;
+}
+
+[[nodiscard]] std::size_t read_mem_available(const std::filesystem::path& meminfo) {
+    std::ifstream in(meminfo);
+    constexpr std::string_view key = "MemAvailable:";
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.starts_with(key)) continue;
+        std::string_view rest{line};
+        rest.remove_prefix(key.size());
+        rest.remove_prefix(std::min(rest.find_first_not_of(' '), rest.size()));
+        return parse_size(rest).value_or(0) * 1024u; // reported in kB
+    }
+    return 0;
+}
+
+} // namespace
+
+std::string_view strategy_name(InputStrategy s) noexcept {
+    switch (s) {
+        case InputStrategy::InMemory: return "in-memory";
+        case InputStrategy::Mapped:   return "memory-mapped";
+        case InputStrategy::Stream:   return "stream";
+    }
+    return "unknown";
+}
+
+std::optional<std::size_t> MemoryStatus::headroom() const noexcept {
+    std::optional<std::size_t> room;
+    if (available_bytes > 0) room = available_bytes;
+    if (cgroup_limit_bytes > 0) {
+        const std::size_t left = cgroup_limit_bytes > cgroup_usage_bytes ? cgroup_limit_bytes - cgroup_usage_bytes : 0;
+        room = room ? std::min(*room, left) : left;
+    }
+    return room;
+}
+
+ResourceGovernor::ResourceGovernor(std::filesystem::path root) : root_(std::move(root)) {
+    locate_cgroup();
+}
+
+void ResourceGovernor::locate_cgroup() {
+    const auto base = root_ / "sys/fs/cgroup";
+    const auto use_if_present = [&](const std::filesystem::path& dir, std::string_view limit, std::string_view usage) {
+        std::error_code ec;
+        if (!std::filesystem::exists(dir / limit, ec)) return false;
+        cgroup_limit_ = dir / limit;
+        cgroup_usage_ = dir / usage;
+        return true;
+    };
+
+    // Each line is "hierarchy-ID:controller-list:cgroup-path". A v1 memory
+    // controller wins over the v2 unified hierarchy on hybrid systems. Inside
+    // a container the path is often not visible, so fall back to the mount root.
+    std::ifstream in(root_ / "proc/self/cgroup");
+    std::string line;
+    while (std::getline(in, line)) {
+        const auto c1 = line.find(':');
+        const auto c2 = c1 == std::string::npos ? c1 : line.find(':', c1 + 1);
+        if (c2 == std::string::npos) continue;
+        const std::string_view controllers = std::string_view{line}.substr(c1 + 1, c2 - c1 - 1);
+        std::string_view rel = std::string_view{line}.substr(c2 + 1);
+        rel.remove_prefix(std::min(rel.find_first_not_of('/'), rel.size()));
+
+        if (controllers.empty()) {
+            if (cgroup_limit_.empty()) {
+                (void)(use_if_present(base / rel, "memory.max", "memory.current") ||
+                       use_if_present(base, "memory.max", "memory.current"));
+            }
+        } else if (("," + std::string{controllers} + ",").find(",memory,") != std::string::npos) {
+            if (use_if_present(base / "memory" / rel, "memory.limit_in_bytes", "memory.usage_in_bytes") ||
+                use_if_present(base / "memory", "memory.limit_in_bytes", "memory.usage_in_bytes")) {
+                return;
+            }
+        }
+    }
+}
+
+std::size_t ResourceGovernor::rss_bytes() const {
+    // statm: size resident shared text lib data dt, in pages
+    const std::string text = read_first_line(root_ / "proc/self/statm");
+    const auto sp = text.find(' ');
+    if (sp == std::string::npos) return 0;
+    const auto pages = parse_size(std::string_view{text}.substr(sp + 1));
+    return pages.value_or(0) * static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+}
+
+MemoryStatus ResourceGovernor::sample() const {
+    MemoryStatus st;
+    st.rss_bytes       = rss_bytes();
+    st.available_bytes = read_mem_available(root_ / "proc/meminfo");
+    if (!cgroup_limit_.empty()) {
+        st.cgroup_limit_bytes = read_cgroup_value(cgroup_limit_);
+        if (st.cgroup_limit_bytes > 0) st.cgroup_usage_bytes = read_cgroup_value(cgroup_usage_);
+    }
+    return st;
+}
+
+InputStrategy choose_strategy(std::uintmax_t file_size, const MemoryStatus& status) noexcept {
+    const auto room = status.headroom();
+    if (file_size < LARGE_FILE_THRESHOLD_MB * MB_TO_BYTES &&
+        (!room || file_size * IN_MEMORY_OVERHEAD <= *room / 2)) {
+        return InputStrategy::InMemory;
+    }
+    // Mapped pages are file-backed and can be dropped under pressure, but a
+    // cgroup charges them as page cache, so keep the same safety margin.
+    if (room && file_size <= *room / 2) return InputStrategy::Mapped;
+    return InputStrategy::Stream;
+}
@@ -0,0 +1,195 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include "result_file.h"
+
+#include "file_utils.h"
+#include "path_validation.h"
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <fcntl.h>
+#include <ostream>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr std::uint64_t align8(std::uint64_t n) noexcept { return (n + 7) & ~std::uint64_t{7}; }
+
+template <class T>
+void write_raw(std::ofstream& out, const T& v) {
+    out.write(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+void write_padding(std::ofstream& out, std::uint64_t from) {
+    constexpr char zeros[8]{};
+    out.write(zeros, static_cast<std::streamsize>(align8(from) - from));
+}
+
+[[noreturn]] void corrupt(std::string_view filename) {
+    throw std::runtime_error(create_error_message("result file load", filename, "file is truncated or corrupt"));
+}
+
+// Slot table for `records`: at most half full, so probes stay short.
+[[nodiscard]] std::vector<ResultSlot> build_slots(const std::vector<ResultRecord>& records) {
+    std::vector<ResultSlot> slots(std::bit_ceil(std::max<std::size_t>(records.size() * 2, 2)));
+    const std::size_t mask = slots.size() - 1;
+    for (std::size_t i = 0; i < records.size(); ++i) {
+        std::size_t s = static_cast<std::size_t>(records[i].fingerprint) & mask;
+        while (slots[s].record != 0) s = (s + 1) & mask;
+        slots[s] = {records[i].fingerprint, i + 1};
+    }
+    return slots;
+}
+
+} // namespace
+
+ResultFileWriter::ResultFileWriter(std::string_view filename)
+    : name_(filename), path_(path_validation::validate_and_canonicalize(filename)) {
+    tmp_ = path_;
+    tmp_ += ".tmp";
+    out_.open(tmp_, std::ios::binary | std::ios::trunc);
+    if (!out_) throw std::runtime_error(create_error_message("result file save", name_, "cannot create file"));
+    const ResultHeader placeholder{};
+    write_raw(out_, placeholder); // filled in by finish()
+}
+
+ResultFileWriter::~ResultFileWriter() {
+    if (finished_) return;
+    out_.close();
+    std::error_code ec;
+    std::filesystem::remove(tmp_, ec); // an incomplete run leaves no result file behind
+}
+
+void ResultFileWriter::add(const BlockStore& store, std::size_t index, std::string_view text) {
+    ResultRecord& r = records_.emplace_back();
+    r.fingerprint = store.fingerprint(index);
+    r.bytes       = store.bytes(index);
+    r.heap_blocks = store.heap_blocks(index);
+    r.text_offset = blob_size_;
+    r.text_length = static_cast<std::uint32_t>(text.size()); // blocks are at most 10 MB
+    r.occurrences = store.occurrences(index);
+    r.kind        = static_cast<std::uint8_t>(store.kind(index));
+    out_.write(text.data(), static_cast<std::streamsize>(text.size()));
+    blob_size_ += text.size();
+}
+
+void ResultFileWriter::finish() {
+    const std::vector<ResultSlot> slots = build_slots(records_);
+
+    ResultHeader h{};
+    std::memcpy(h.magic, RESULT_MAGIC.data(), sizeof(h.magic));
+    h.version        = RESULT_VERSION;
+    h.record_size    = sizeof(ResultRecord);
+    h.records        = records_.size();
+    h.slots          = slots.size();
+    h.blob_offset    = sizeof(ResultHeader);
+    h.blob_size      = blob_size_;
+    h.records_offset = align8(h.blob_offset + blob_size_);
+    h.slots_offset   = h.records_offset + records_.size() * sizeof(ResultRecord);
+
+    write_padding(out_, h.blob_offset + blob_size_);
+    out_.write(reinterpret_cast<const char*>(records_.data()),
+               static_cast<std::streamsize>(records_.size() * sizeof(ResultRecord)));
+    out_.write(reinterpret_cast<const char*>(slots.data()),
+               static_cast<std::streamsize>(slots.size() * sizeof(ResultSlot)));
+    out_.seekp(0);
+    write_raw(out_, h);
+    out_.close();
+    if (!out_) throw std::runtime_error(create_error_message("result file save", name_, "write failed"));
+    std::filesystem::rename(tmp_, path_);
+    finished_ = true;
+}
+
+ResultFile::ResultFile(std::string_view filename) {
+    const auto path = path_validation::validate_and_canonicalize(filename);
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) throw std::runtime_error(create_error_message("result file load", filename, std::strerror(errno)));
+    struct stat st{};
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error(create_error_message("result file load", filename, std::strerror(errno)));
+    }
+    size_ = static_cast<std::size_t>(st.st_size);
+    if (size_ < sizeof(ResultHeader)) {
+        ::close(fd);
+        corrupt(filename);
+    }
+    void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) throw std::runtime_error(create_error_message("result file load", filename, std::strerror(errno)));
+    data_ = static_cast<const char*>(data);
+
+    std::memcpy(&header_, data_, sizeof(header_));
+    const auto fits = [&](std::uint64_t offset, std::uint64_t count, std::uint64_t element) {
+        return offset <= size_ && count <= (size_ - offset) / element;
+    };
+    const bool valid = std::string_view{header_.magic, sizeof(header_.magic)} == RESULT_MAGIC &&
+                       header_.version == RESULT_VERSION && header_.record_size == sizeof(ResultRecord) &&
+                       fits(header_.blob_offset, header_.blob_size, 1) &&
+                       fits(header_.records_offset, header_.records, sizeof(ResultRecord)) &&
+                       fits(header_.slots_offset, header_.slots, sizeof(ResultSlot)) &&
+                       std::has_single_bit(header_.slots) && header_.slots >= header_.records;
+    if (!valid) {
+        ::munmap(data, size_);
+        corrupt(filename);
+    }
+}
+
+ResultFile::~ResultFile() {
+    ::munmap(const_cast<char*>(data_), size_);
+}
+
+ResultRecord ResultFile::record(std::size_t i) const noexcept {
+    ResultRecord r{};
+    std::memcpy(&r, data_ + header_.records_offset + i * sizeof(ResultRecord), sizeof(r));
+    return r;
+}
+
+std::string_view ResultFile::text(const ResultRecord& r) const {
+    if (r.text_offset > header_.blob_size || r.text_length > header_.blob_size - r.text_offset) {
+        throw std::runtime_error("Result file record points outside its text blob");
+    }
+    return {data_ + header_.blob_offset + r.text_offset, r.text_length};
+}
+
+std::optional<std::size_t> ResultFile::find(std::uint64_t fingerprint) const noexcept {
+    const std::uint64_t mask = header_.slots - 1;
+    for (std::uint64_t s = fingerprint & mask, probes = 0; probes < header_.slots; s = (s + 1) & mask, ++probes) {
+        ResultSlot slot{};
+        std::memcpy(&slot, data_ + header_.slots_offset + s * sizeof(ResultSlot), sizeof(slot));
+        if (slot.record == 0) break;
+        if (slot.fingerprint == fingerprint && slot.record <= header_.records) {
+            return static_cast<std::size_t>(slot.record - 1);
+        }
+    }
+    return std::nullopt;
+}
+
+void show_result_file(std::string_view filename, std::optional<std::string_view> fingerprint, std::ostream& os) {
+    const ResultFile file(filename);
+    if (!fingerprint) {
+        for (std::size_t i = 0; i < file.size(); ++i) os << file.text(file.record(i)) << "\n\n";
+        return;
+    }
+
+    std::uint64_t fp = 0;
+    const auto* end = fingerprint->data() + fingerprint->size();
+    const auto [ptr, ec] = std::from_chars(fingerprint->data(), end, fp, 16);
+    if (ec != std::errc{} || ptr != end || fingerprint->empty()) {
+        throw std::runtime_error("Invalid fingerprint: '" + std::string{*fingerprint} + "' (expected hex)");
+    }
+    const auto index = file.find(fp);
+    if (!index) throw std::runtime_error("No block with fingerprint " + std::string{*fingerprint} + " in " + std::string{filename});
+    os << file.text(file.record(*index)) << "\n\n";
+}
@@ -0,0 +1,128 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include "spill_file.h"
+
+#include "file_utils.h"
+
+#include <array>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+
+namespace {
+
+constinit inline std::size_t SPILL_BUFFER_BYTES = 64u * 1024u;
+
+[[nodiscard]] std::string spill_dir() {
+    const char* tmp = std::getenv("TMPDIR");
+    return (tmp != nullptr && *tmp != '\0') ? std::string{tmp} : std::string{"/tmp"};
+}
+
+[[noreturn]] void throw_io_error(std::string_view operation, std::string_view target = "spill file") {
+    throw std::runtime_error(create_error_message(operation, target, std::strerror(errno)));
+}
+
+} // namespace
+
+SpillFile::~SpillFile() {
+    if (fd_ >= 0) ::close(fd_);
+}
+
+void SpillFile::open_file() {
+    const std::string dir = spill_dir();
+#if defined(O_TMPFILE)
+    fd_ = ::open(dir.c_str(), O_TMPFILE | O_RDWR | O_EXCL | O_CLOEXEC, 0600);
+#endif
+    if (fd_ < 0) {
+        // Filesystems without O_TMPFILE: create a named file and unlink it at once
+        std::string templ = dir + "/vglog-filter-spill-XXXXXX";
+        fd_ = ::mkstemp(templ.data());
+        if (fd_ < 0) throw_io_error("spill file creation", dir);
+        ::unlink(templ.c_str());
+    }
+    buffer_.reserve(SPILL_BUFFER_BYTES);
+}
+
+void SpillFile::append(std::string_view data) {
+    if (fd_ < 0) open_file();
+    bytes_ += data.size();
+    if (buffer_.size() + data.size() > SPILL_BUFFER_BYTES) flush_buffer();
+    if (data.size() >= SPILL_BUFFER_BYTES) {
+        write_all(data);
+    } else {
+        buffer_.append(data);
+    }
+}
+
+void SpillFile::flush_buffer() {
+    write_all(buffer_);
+    buffer_.clear();
+}
+
+void SpillFile::write_all(std::string_view data) {
+    std::size_t done = 0;
+    while (done < data.size()) {
+        const auto n = ::write(fd_, data.data() + done, data.size() - done);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw_io_error("spill write");
+        }
+        done += static_cast<std::size_t>(n);
+    }
+}
+
+void SpillFile::truncate() noexcept {
+    buffer_.clear();
+    bytes_ = 0;
+    if (fd_ < 0) return;
+    if (::ftruncate(fd_, 0) != 0 || ::lseek(fd_, 0, SEEK_SET) != 0) {
+        // Start over with a fresh file on the next append
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+void SpillFile::copy_to(std::ostream& os) {
+    if (fd_ < 0 || bytes_ == 0) return;
+    flush_buffer();
+
+    std::array<char, 64 * 1024> chunk{};
+    off_t offset = 0;
+    for (;;) {
+        const auto n = ::pread(fd_, chunk.data(), chunk.size(), offset);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw_io_error("spill read");
+        }
+        if (n == 0) break;
+        os.write(chunk.data(), n);
+        offset += n;
+    }
+}
+
+void SpillFile::read(std::size_t offset, std::size_t length, std::string& out) {
+    if (offset + length > bytes_) throw std::runtime_error("Spill read past the end");
+    if (!buffer_.empty()) flush_buffer();
+
+    out.resize(length);
+    std::size_t done = 0;
+    while (done < length) {
+        const auto n = ::pread(fd_, out.data() + done, length - done, static_cast<off_t>(offset + done));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw_io_error("spill read");
+        }
+        if (n == 0) throw std::runtime_error("Spill file truncated");
+        done += static_cast<std::size_t>(n);
+    }
+}
@@ -0,0 +1,470 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include "suppressions.h"
+
+#include "canonicalization.h"
+#include "checkpoint.h"
+#include "file_utils.h"
+#include "path_validation.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+// Access and value sizes Valgrind has suppression kinds for (Addr1 … Addr32).
+[[nodiscard]] std::optional<std::string> sized(std::string_view prefix, std::string_view header) {
+    const std::uint64_t n = parse_header_counts(header).bytes;
+    if (n == 0 || n > 32 || (n & (n - 1)) != 0) return std::nullopt;
+    std::string kind{prefix};
+    kind.append(std::to_string(n));
+    return kind;
+}
+
+[[nodiscard]] std::string leak(std::string_view kinds) {
+    std::string kind{"Memcheck:Leak\nmatch-leak-kinds: "};
+    kind.append(kinds);
+    return kind;
+}
+
+// "Syscall param write(buf) points to uninitialised byte(s)" → "write(buf)"
+[[nodiscard]] std::optional<std::string> syscall_param(std::string_view header) {
+    constexpr std::string_view PREFIX = "Syscall param ";
+    if (!header.starts_with(PREFIX)) return std::nullopt;
+    header.remove_prefix(PREFIX.size());
+    std::string kind{"Memcheck:Param\n"};
+    kind.append(header.substr(0, header.find(' ')));
+    return kind;
+}
+
+[[nodiscard]] std::optional<std::string> memcheck_kind(BlockKind kind, std::string_view header) {
+    switch (kind) {
+        case BlockKind::InvalidRead:
+        case BlockKind::InvalidWrite:   return sized("Memcheck:Addr", header);
+        case BlockKind::SyscallParam:   return syscall_param(header);
+        case BlockKind::Uninitialised:
+            if (header.starts_with("Conditional jump")) return "Memcheck:Cond";
+            return sized("Memcheck:Value", header);
+        case BlockKind::DefinitelyLost: return leak("definite");
+        case BlockKind::IndirectlyLost: return leak("indirect");
+        case BlockKind::PossiblyLost:   return leak("possible");
+        case BlockKind::StillReachable: return leak("reachable");
+        case BlockKind::Other:
+            if (header.starts_with("Invalid free") || header.starts_with("Mismatched free")) return "Memcheck:Free";
+            if (header.starts_with("Source and destination overlap")) return "Memcheck:Overlap";
+            if (header.starts_with("Jump to the invalid address")) return "Memcheck:Jump";
+            return std::nullopt;
+        default:
+            return std::nullopt;
+    }
+}
+
+[[nodiscard]] std::optional<std::string> helgrind_kind(BlockKind kind, std::string_view header) {
+    switch (kind) {
+        case BlockKind::DataRace:  return "Helgrind:Race";
+        case BlockKind::LockOrder: return "Helgrind:LockOrder";
+        case BlockKind::ThreadApi:
+            if (header.find("unlocked a not-locked lock") != std::string_view::npos) return "Helgrind:UnlockUnlocked";
+            if (header.find("currently held by") != std::string_view::npos)          return "Helgrind:UnlockForeign";
+            if (header.find("unlocked an invalid lock") != std::string_view::npos)   return "Helgrind:UnlockBogus";
+            if (header.find("pthread_") != std::string_view::npos)                   return "Helgrind:PthAPIerror";
+            return "Helgrind:Misc";
+        default:
+            return std::nullopt;
+    }
+}
+
+constexpr std::string_view LEAK_KIND = "Memcheck:Leak";
+constexpr BlockKindMask    ANY_KIND  = ~BlockKindMask{0};
+constexpr BlockKindMask    LEAK_KINDS = kind_bit(BlockKind::DefinitelyLost) | kind_bit(BlockKind::IndirectlyLost) |
+                                        kind_bit(BlockKind::PossiblyLost) | kind_bit(BlockKind::StillReachable);
+
+[[nodiscard]] std::runtime_error supp_error(std::string_view origin, std::size_t line_no, std::string_view what) {
+    std::string msg{"Suppressions file "};
+    msg.append(origin).append(" line ").append(std::to_string(line_no)).append(": ").append(what);
+    return std::runtime_error(msg);
+}
+
+// "definite,possible", "all" or "none"
+[[nodiscard]] std::optional<BlockKindMask> parse_leak_kinds(std::string_view list) {
+    BlockKindMask mask = 0;
+    while (!list.empty()) {
+        const auto comma = list.find(',');
+        const auto name  = canonicalization::trim_view(list.substr(0, comma));
+        if      (name == "all")       mask |= LEAK_KINDS;
+        else if (name == "definite")  mask |= kind_bit(BlockKind::DefinitelyLost);
+        else if (name == "indirect")  mask |= kind_bit(BlockKind::IndirectlyLost);
+        else if (name == "possible")  mask |= kind_bit(BlockKind::PossiblyLost);
+        else if (name == "reachable") mask |= kind_bit(BlockKind::StillReachable);
+        else if (name != "none")      return std::nullopt;
+        list.remove_prefix(comma == std::string_view::npos ? list.size() : comma + 1);
+    }
+    return mask;
+}
+
+[[nodiscard]] bool is_frame_pattern(std::string_view line) noexcept {
+    return line == "..." || line.starts_with("fun:") || line.starts_with("obj:") || line.starts_with("src:");
+}
+
+[[nodiscard]] bool is_glob(std::string_view pattern) noexcept {
+    return pattern.find_first_of("*?") != std::string_view::npos;
+}
+
+// Valgrind's wildcards: '*' matches any run of characters, '?' any one.
+[[nodiscard]] bool glob_match(std::string_view pattern, std::string_view text) noexcept {
+    std::size_t p = 0;
+    std::size_t t = 0;
+    std::size_t star   = std::string_view::npos; // last '*' seen, retried with one more character
+    std::size_t resume = 0;
+    while (t < text.size()) {
+        if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == text[t])) {
+            ++p;
+            ++t;
+        } else if (p < pattern.size() && pattern[p] == '*') {
+            star   = p++;
+            resume = t;
+        } else if (star != std::string_view::npos) {
+            p = star + 1;
+            t = ++resume;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '*') ++p;
+    return p == pattern.size();
+}
+
+// `body` with its literal first `prefix` and last `suffix` characters against
+// `text`; only the part between them needs the glob.
+[[nodiscard]] bool glob_match(std::string_view body, std::size_t prefix, std::size_t suffix,
+                              std::string_view text) noexcept {
+    if (text.size() < prefix + suffix || !text.starts_with(body.substr(0, prefix)) ||
+        !text.ends_with(body.substr(body.size() - suffix))) {
+        return false;
+    }
+    return glob_match(body.substr(prefix, body.size() - prefix - suffix),
+                      text.substr(prefix, text.size() - prefix - suffix));
+}
+
+// A name as it appears in the symbol table: plain C, or a mangled C++ name
+// with its clone suffix ("_ZN3Foo3barEv.cold"). Demangled C++ has spaces,
+// "::", "<>" or "()".
+[[nodiscard]] bool is_symbol(std::string_view name) noexcept {
+    return std::ranges::all_of(name, [](char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+               c == '_' || c == '.' || c == '$' || c == '@';
+    });
+}
+
+// Field a glob pattern matches: 0 = fun:, 1 = obj:, 2 = src:.
+[[nodiscard]] std::size_t glob_field(std::string_view pattern) noexcept {
+    if (pattern.starts_with("fun:")) return 0;
+    if (pattern.starts_with("obj:")) return 1;
+    return 2;
+}
+
+} // namespace
+
+std::optional<std::string> suppression_kind(ValgrindTool tool, BlockKind kind, std::string_view header) {
+    switch (tool) {
+        case ValgrindTool::Memcheck: return memcheck_kind(kind, header);
+        case ValgrindTool::Helgrind: return helgrind_kind(kind, header);
+        case ValgrindTool::Drd:
+            // DRD's API errors map to many kinds by wording; races are unambiguous.
+            if (kind == BlockKind::DataRace) return "drd:ConflictingAccess";
+            return std::nullopt;
+    }
+    return std::nullopt;
+}
+
+std::string wildcard_pattern(std::string_view raw, std::string_view canonical) {
+    std::string out;
+    out.reserve(raw.size());
+    const auto star = [&out] {
+        if (!out.ends_with('*')) out.push_back('*');
+    };
+    std::size_t i = 0;
+    for (std::size_t j = 0; j < canonical.size() && i < raw.size(); ++j) {
+        if (raw[i] == canonical[j]) {
+            out.push_back(raw[i++]);
+            continue;
+        }
+        // Raw text was erased up to the next character both share; a canonical
+        // character with no counterpart was inserted (a placeholder).
+        star();
+        if (const auto k = raw.find(canonical[j], i); k != std::string_view::npos) {
+            i = k;
+            out.push_back(raw[i++]);
+        }
+    }
+    if (i < raw.size()) star();
+    return out;
+}
+
+SuppressionWriter::SuppressionWriter(std::string_view filename, std::size_t depth,
+                                     const canonicalization::RuleSet& rules)
+    : name_(filename), depth_(depth), rules_(rules) {
+    out_.open(path_validation::validate_and_canonicalize(filename), std::ios::trunc);
+    if (!out_) throw std::runtime_error(create_error_message("suppression file save", name_, "cannot create file"));
+}
+
+std::string SuppressionWriter::frame_line(std::string_view function, std::string_view object) {
+    if (!function.empty() && function != "???" && is_symbol(function)) {
+        std::string line{"fun:"};
+        if (function.starts_with("_Z") && demangler_.demangle(function) != function) {
+            // Valgrind matches fun: against the mangled name: keep it exact.
+            line.append(function);
+            return line;
+        }
+        if (rules_.empty()) canonical_.assign(function);
+        else                rules_.apply(function, canonical_);
+        canonicalization::canon_in_place(canonical_);
+        line.append(wildcard_pattern(function, canonical_));
+        return line;
+    }
+    // A demangled C++ name would never match Valgrind's mangled one.
+    if (!object.empty()) {
+        std::string line{"obj:"};
+        line.append(object);
+        return line;
+    }
+    return "fun:*";
+}
+
+void SuppressionWriter::add(const BlockStore& store, std::size_t index, ValgrindTool tool) {
+    const auto kind = suppression_kind(tool, store.kind(index), store.header(index));
+    const auto stack = store.stack(index);
+    // Without frames a suppression would hide every error of its kind.
+    if (!kind || stack.empty()) return;
+
+    body_.clear();
+    for (std::string_view lines{*kind}; !lines.empty();) {
+        const auto nl = lines.find('\n');
+        body_.append("   ").append(lines.substr(0, nl)).push_back('\n');
+        lines.remove_prefix(nl == std::string_view::npos ? lines.size() : nl + 1);
+    }
+    const StringTable& names = store.strings();
+    const std::size_t  n     = depth_ == 0 ? stack.size() : std::min(depth_, stack.size());
+    bool               any   = false; // a frame other than fun:*, which matches everything
+    for (const Frame& f : stack.first(n)) {
+        const std::string line = frame_line(names[f.function], names[f.object]);
+        any |= line != "fun:*";
+        body_.append("   ").append(line).push_back('\n');
+    }
+    if (!any) return;
+    if (!seen_.insert(fingerprint(body_)).second) return; // same suppression as an earlier block
+
+    std::array<char, 16> hex{};
+    const auto end = std::to_chars(hex.data(), hex.data() + hex.size(), store.fingerprint(index), 16).ptr;
+    out_ << "{\n   vglog-filter/" << block_kind_name(store.kind(index)) << '/'
+         << std::string_view{hex.data(), static_cast<std::size_t>(end - hex.data())} << '\n'
+         << body_ << "}\n";
+}
+
+void SuppressionWriter::finish() {
+    out_.flush();
+    if (!out_) throw std::runtime_error(create_error_message("suppression file save", name_, "write failed"));
+}
+
+void SuppressionSet::parse(std::string_view text, std::string_view origin) {
+    if (nodes_.empty()) nodes_.emplace_back(); // node 0 only stands for "no child"
+
+    enum class Expect : std::uint8_t { Open, Name, Kind, Param, Frames };
+    Expect                        expect  = Expect::Open;
+    std::size_t                   line_no = 0;
+    std::size_t                   opened  = 0;
+    std::vector<std::string>      kinds;  // root keys of the entry: one per tool it names
+    std::vector<std::string_view> frames;
+    BlockKindMask                 accept = ANY_KIND;
+    bool                          leak   = false;
+
+    while (!text.empty()) {
+        const auto nl   = text.find('\n');
+        const auto line = canonicalization::trim_view(text.substr(0, nl));
+        text.remove_prefix(nl == std::string_view::npos ? text.size() : nl + 1);
+        ++line_no;
+        if (line.empty() || line.starts_with('#')) continue;
+
+        switch (expect) {
+            case Expect::Open:
+                if (line != "{") throw supp_error(origin, line_no, "expected '{'");
+                kinds.clear();
+                frames.clear();
+                accept = ANY_KIND;
+                leak   = false;
+                opened = line_no;
+                expect = Expect::Name;
+                break;
+            case Expect::Name:
+                if (line == "}") throw supp_error(origin, line_no, "entry has no kind");
+                expect = Expect::Kind;
+                break;
+            case Expect::Kind: {
+                // "Memcheck:Addr4", or several tools sharing one kind: "Memcheck,Helgrind:Misc"
+                const auto colon = line.find(':');
+                if (colon == 0 || colon == std::string_view::npos || colon + 1 == line.size()) {
+                    throw supp_error(origin, line_no, "expected TOOL:KIND");
+                }
+                const std::string_view kind = line.substr(colon + 1);
+                for (std::string_view tools = line.substr(0, colon); !tools.empty();) {
+                    const auto comma = tools.find(',');
+                    kinds.emplace_back(tools.substr(0, comma)).append(":").append(kind);
+                    tools.remove_prefix(comma == std::string_view::npos ? tools.size() : comma + 1);
+                }
+                leak   = line.ends_with(":Leak");
+                accept = leak ? LEAK_KINDS : ANY_KIND;
+                expect = kind == "Param" ? Expect::Param : Expect::Frames;
+                break;
+            }
+            case Expect::Param:
+                // The syscall argument is part of the kind: "write(buf)"
+                for (auto& k : kinds) k.append("\n").append(line);
+                expect = Expect::Frames;
+                break;
+            case Expect::Frames:
+                if (line == "}") {
+                    if (frames.empty()) throw supp_error(origin, line_no, "entry has no frames");
+                    for (const auto& k : kinds) {
+                        const auto [root, added] = roots_.try_emplace(k, static_cast<std::uint32_t>(nodes_.size()));
+                        if (added) nodes_.emplace_back();
+                        std::uint32_t node = root->second;
+                        for (const auto pattern : frames) node = child(node, pattern);
+                        nodes_[node].accept |= accept;
+                    }
+                    ++entries_;
+                    expect = Expect::Open;
+                } else if (leak && frames.empty() && line.starts_with("match-leak-kinds:")) {
+                    const auto mask = parse_leak_kinds(line.substr(17));
+                    if (!mask) throw supp_error(origin, line_no, "unknown leak kind");
+                    accept = *mask;
+                } else if (is_frame_pattern(line)) {
+                    frames.push_back(line);
+                } else {
+                    throw supp_error(origin, line_no, "expected fun:, obj:, src: or '...'");
+                }
+                break;
+        }
+    }
+    if (expect != Expect::Open) throw supp_error(origin, opened, "unterminated entry");
+}
+
+void SuppressionSet::load(std::string_view filename) {
+    auto ifs = path_validation::safe_ifstream(filename);
+    std::ostringstream ss;
+    ss << ifs.rdbuf();
+    parse(ss.str(), filename);
+}
+
+std::uint32_t SuppressionSet::child(std::uint32_t node, std::string_view pattern) {
+    const auto next = static_cast<std::uint32_t>(nodes_.size());
+    if (pattern == "...") {
+        if (nodes_[node].ellipsis != 0) return nodes_[node].ellipsis;
+        nodes_[node].ellipsis = next;
+    } else if (const std::string_view body = pattern.substr(4); is_glob(body)) {
+        if (!nodes_[node].globs) nodes_[node].globs = std::make_unique<Globs>();
+        Globs&            globs  = *nodes_[node].globs;
+        const std::size_t field  = glob_field(pattern);
+        const auto        prefix = static_cast<std::uint32_t>(body.find_first_of("*?"));
+        const auto        suffix = static_cast<std::uint32_t>(body.size() - 1 - body.find_last_of("*?"));
+        auto& bucket = globs.by_prefix[field][std::string{body.substr(0, prefix)}];
+        for (const std::uint32_t i : bucket) {
+            if (globs.all[i].pattern == pattern) return globs.all[i].child;
+        }
+        if (bucket.empty()) {
+            auto& lengths = globs.prefix_lengths[field];
+            if (const auto at = std::ranges::lower_bound(lengths, prefix); at == lengths.end() || *at != prefix) {
+                lengths.insert(at, prefix);
+            }
+        }
+        bucket.push_back(static_cast<std::uint32_t>(globs.all.size()));
+        globs.all.push_back({std::string{pattern}, next, prefix, suffix});
+    } else {
+        const auto [it, added] = nodes_[node].literal.try_emplace(std::string{pattern}, next);
+        if (!added) return it->second;
+    }
+    nodes_.emplace_back();
+    return next;
+}
+
+bool SuppressionSet::matches(ValgrindTool tool, BlockKind kind, std::string_view header,
+                             std::span<const FrameText> stack) const {
+    auto key = suppression_kind(tool, kind, header);
+    if (!key) return false;
+    if (key->starts_with(LEAK_KIND)) key->resize(LEAK_KIND.size()); // leak kinds are checked per entry
+    const auto root = roots_.find(*key);
+    if (root == roots_.end()) return false;
+    if (!failed_.empty()) failed_.clear();
+    return match(root->second, stack, 0, kind_bit(kind));
+}
+
+bool SuppressionSet::match(std::uint32_t node, std::span<const FrameText> stack, std::size_t pos,
+                           BlockKindMask kind) const {
+    const Node& n = nodes_[node];
+    // An entry matches once its frames are used up; deeper frames do not matter.
+    if ((n.accept & kind) != 0) return true;
+    if (n.ellipsis != 0) {
+        // "..." stands for any number of frames, none included. Every later
+        // "..." would retry the same frames again, so a failed one is noted.
+        for (std::size_t skip = pos; skip <= stack.size(); ++skip) {
+            const std::uint64_t state = (std::uint64_t{n.ellipsis} << 32) | skip;
+            if (failed_.contains(state)) continue;
+            if (match(n.ellipsis, stack, skip, kind)) return true;
+            failed_.insert(state);
+        }
+    }
+    if (pos == stack.size()) return false;
+
+    const FrameText& f = stack[pos];
+    const auto find = [&](std::string_view tag, std::string_view field, std::uint32_t line) -> std::uint32_t {
+        if (field.empty() || n.literal.empty()) return 0;
+        key_.assign(tag).append(field);
+        if (line != 0) key_.append(":").append(std::to_string(line));
+        const auto it = n.literal.find(key_);
+        return it == n.literal.end() ? 0 : it->second;
+    };
+    // Looked up before recursing, which reuses key_.
+    const std::array<std::uint32_t, 4> literal{find("fun:", f.function, 0), find("obj:", f.object, 0),
+                                               find("src:", f.file, 0), f.line != 0 ? find("src:", f.file, f.line) : 0};
+    for (const std::uint32_t c : literal) {
+        if (c != 0 && match(c, stack, pos + 1, kind)) return true;
+    }
+    return n.globs && match_globs(*n.globs, stack, pos, kind);
+}
+
+bool SuppressionSet::match_globs(const Globs& globs, std::span<const FrameText> stack, std::size_t pos,
+                                 BlockKindMask kind) const {
+    const FrameText& f = stack[pos];
+    // src: globs match FILE or FILE:LINE; any prefix of FILE also starts FILE:LINE.
+    std::string located;
+    if (!f.file.empty() && !globs.prefix_lengths[2].empty()) {
+        located.assign(f.file).append(":").append(std::to_string(f.line));
+    }
+    const std::array<std::string_view, GLOB_FIELDS> fields{f.function, f.object, located};
+    for (std::size_t field = 0; field < GLOB_FIELDS; ++field) {
+        const std::string_view text = fields[field];
+        if (field == 2 && text.empty()) continue; // no source location
+        for (const std::uint32_t length : globs.prefix_lengths[field]) {
+            if (length > text.size()) break;
+            const auto bucket = globs.by_prefix[field].find(text.substr(0, length));
+            if (bucket == globs.by_prefix[field].end()) continue;
+            for (const std::uint32_t i : bucket->second) {
+                const Glob&            g    = globs.all[i];
+                const std::string_view body = std::string_view{g.pattern}.substr(4);
+                ++glob_checks_;
+                const bool hit = field == 2 ? glob_match(body, g.prefix, g.suffix, f.file) ||
+                                                  glob_match(body, g.prefix, g.suffix, text)
+                                            : glob_match(body, g.prefix, g.suffix, text);
+                if (hit && match(g.child, stack, pos + 1, kind)) return true;
+            }
+        }
+    }
+    return false;
+}
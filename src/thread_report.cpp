@@ -0,0 +1,125 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include "thread_report.h"
+
+#include <array>
+
+namespace {
+
+constexpr bool is_digit(char c) noexcept { return c >= '0' && c <= '9'; }
+
+// Rest of `sv` after a run of digits at its start; nullopt when there is none.
+[[nodiscard]] std::optional<std::string_view> after_number(std::string_view sv) noexcept {
+    std::size_t i = 0;
+    while (i < sv.size() && is_digit(sv[i])) ++i;
+    if (i == 0) return std::nullopt;
+    return sv.substr(i);
+}
+
+// DRD's thread API and lock errors all open with one of these.
+constexpr std::array<std::string_view, 20> DRD_API_ERRORS{
+    "Mutex not locked", "Mutex reinitialization", "Destroying locked mutex", "The object at address",
+    "Recursive locking not allowed", "Lock on mutex", "Lock on reader-writer lock", "Lock on rwlock",
+    "Reader-writer lock", "Writer lock", "Probably a race condition", "Inconsistent association",
+    "pthread_", "Semaphore reinitialization", "Invalid semaphore", "Destruction of",
+    "Barrier reinitialization", "Invalid barrier", "Invalid thread ID", "Attempt to",
+};
+
+[[nodiscard]] ThreadLine classify_helgrind(std::string_view line) noexcept {
+    if (line.starts_with("Possible data race")) return {LineRole::Start, BlockKind::DataRace};
+    if (!line.starts_with("Thread #")) return {};
+    const auto rest = after_number(line.substr(8));
+    if (!rest) return {};
+    if (rest->starts_with(": lock order")) return {LineRole::Start, BlockKind::LockOrder};
+    if (rest->starts_with(": ") || rest->starts_with(" unlocked")) return {LineRole::Start, BlockKind::ThreadApi};
+    // Thread announcements: their own blocks, so they never join a report.
+    if (rest->starts_with(" was created") || rest->starts_with(" is the program's root thread")) {
+        return {LineRole::Start, BlockKind::Other};
+    }
+    return {};
+}
+
+[[nodiscard]] ThreadLine classify_drd(std::string_view line) noexcept {
+    if (line.starts_with("Conflicting load") || line.starts_with("Conflicting store")) {
+        return {LineRole::Start, BlockKind::DataRace};
+    }
+    if (line.starts_with("Thread ")) {
+        // "Thread 2:" names the thread of the report that follows.
+        if (const auto rest = after_number(line.substr(7)); rest && *rest == ":") return {LineRole::Separator};
+        return {};
+    }
+    for (const auto key : DRD_API_ERRORS) {
+        if (line.starts_with(key)) return {LineRole::Start, BlockKind::ThreadApi};
+    }
+    return {};
+}
+
+} // namespace
+
+std::optional<ValgrindTool> detect_tool(std::string_view line) noexcept {
+    if (line.starts_with("Memcheck, ")) return ValgrindTool::Memcheck;
+    if (line.starts_with("Helgrind, ")) return ValgrindTool::Helgrind;
+    if (line.starts_with("drd, ") || line.starts_with("DRD, ")) return ValgrindTool::Drd;
+    return std::nullopt;
+}
+
+ThreadLine classify_thread_line(ValgrindTool tool, std::string_view line) noexcept {
+    if (line.starts_with("---")) return {LineRole::Separator};
+    if (line.starts_with("Process terminating")) return {LineRole::Start, BlockKind::Fatal};
+    return tool == ValgrindTool::Drd ? classify_drd(line) : classify_helgrind(line);
+}
+
+bool race_access(std::string_view line, std::string& out) {
+    constexpr std::string_view RACE      = "Possible data race during ";
+    constexpr std::string_view CONFLICT  = "This conflicts with a previous ";
+    constexpr std::string_view DRD_RACE  = "Conflicting ";
+
+    if (line.starts_with(RACE)) {
+        line.remove_prefix(RACE.size());
+        out.append(line.substr(0, line.find(" at ")));
+        return true;
+    }
+    if (line.starts_with(CONFLICT)) {
+        line.remove_prefix(CONFLICT.size());
+        out.append(line.substr(0, line.find(" by thread")));
+        return true;
+    }
+    if (line.starts_with(DRD_RACE)) {
+        line.remove_prefix(DRD_RACE.size());
+        const auto by = line.find(" by thread");
+        if (by == std::string_view::npos) return false;
+        out.append(line.substr(0, by));
+        if (const auto size = line.rfind(" size "); size != std::string_view::npos && size > by) {
+            out.append(line.substr(size));
+        }
+        return true;
+    }
+    return false;
+}
+
+std::size_t neutralize_thread_ids(std::span<char> text) noexcept {
+    constexpr std::string_view WORD = "hread "; // "Thread " / "thread "
+    const std::size_t n = text.size();
+    std::size_t out = 0;
+    std::size_t i   = 0;
+    while (i < n) {
+        const char c = text[i++];
+        text[out++] = c;
+        if (c != ' ' || out <= WORD.size()) continue;
+        const std::string_view tail{text.data() + out - WORD.size(), WORD.size()};
+        const char t = text[out - WORD.size() - 1];
+        if (tail != WORD || (t != 't' && t != 'T')) continue;
+
+        if (i < n && text[i] == '#') text[out++] = text[i++];
+        if (i < n && is_digit(text[i])) {
+            while (i < n && is_digit(text[i])) ++i;
+            text[out++] = 'N';
+        }
+    }
+    return out;
+}
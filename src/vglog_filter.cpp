@@ -0,0 +1,135 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include "vglog_filter.h"
+
+#include "log_processor.h"
+#include "options.h"
+#include "path_validation.h"
+
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#ifndef VGLOG_FILTER_VERSION
+#define VGLOG_FILTER_VERSION "0.0.0"
+#endif
+
+// Owns the options LogProcessor refers to and turns its records into vglog_block.
+struct vglog_filter {
+    vglog_filter(const Options& opt, vglog_block_callback cb, void* user)
+        : options(opt), callback(cb), user_data(user),
+          processor(options, [this](std::size_t index, std::string_view text) { deliver(index, text); }) {}
+
+    void deliver(std::size_t index, std::string_view text) const {
+        const BlockStore& store = processor.blocks();
+        const vglog_block block{text.data(), text.size(), block_kind_name(store.kind(index)).data(),
+                                store.fingerprint(index), store.occurrences(index), store.bytes(index),
+                                store.heap_blocks(index)};
+        callback(&block, user_data);
+    }
+
+    Options              options;
+    vglog_block_callback callback;
+    void*                user_data;
+    LogProcessor         processor;
+};
+
+namespace {
+
+thread_local std::string last_error;
+
+void set_error(const char* what) noexcept {
+    try {
+        last_error = what;
+    } catch (...) {
+        last_error.clear();
+    }
+}
+
+// Runs `fn`, turning exceptions into -1 and vglog_last_error().
+template <class Fn>
+int guarded(Fn&& fn) noexcept {
+    try {
+        fn();
+        last_error.clear();
+        return 0;
+    } catch (const std::exception& e) {
+        set_error(e.what());
+    } catch (...) {
+        set_error("unknown error");
+    }
+    return -1;
+}
+
+[[nodiscard]] Options to_options(const vglog_options& in) {
+    Options opt;
+    opt.depth       = in.depth;
+    opt.trim        = in.keep_debug_info == 0;
+    opt.scrub_raw   = in.raw == 0;
+    opt.stream_mode = true; // fed in chunks; a trimmed run waits for the marker
+    if (in.marker != nullptr && *in.marker != '\0') opt.marker = in.marker;
+    if (in.canon_rules_file != nullptr) {
+        opt.canon_rules_file = path_validation::sanitize_path_for_file_access(in.canon_rules_file);
+    }
+    if (in.suppressions_file != nullptr) {
+        opt.suppress_files.push_back(path_validation::sanitize_path_for_file_access(in.suppressions_file));
+    }
+    return opt;
+}
+
+} // namespace
+
+extern "C" {
+
+void vglog_options_init(vglog_options* options) {
+    if (options == nullptr) return;
+    const Options defaults;
+    *options                 = vglog_options{};
+    options->depth           = defaults.depth;
+    options->keep_debug_info = defaults.trim ? 0 : 1;
+    options->raw             = defaults.scrub_raw ? 0 : 1;
+}
+
+vglog_filter* vglog_filter_new(const vglog_options* options, vglog_block_callback callback, void* user_data) {
+    vglog_filter* filter = nullptr;
+    const int rc = guarded([&] {
+        if (options == nullptr || callback == nullptr) throw std::invalid_argument("options and callback are required");
+        if (options->depth < 0) throw std::invalid_argument("depth must not be negative");
+        filter = new vglog_filter(to_options(*options), callback, user_data);
+    });
+    return rc == 0 ? filter : nullptr;
+}
+
+int vglog_filter_feed(vglog_filter* filter, const char* data, size_t length) {
+    return guarded([&] {
+        if (filter == nullptr || (data == nullptr && length != 0)) throw std::invalid_argument("null argument");
+        filter->processor.feed(std::string_view{data, length});
+    });
+}
+
+int vglog_filter_finish(vglog_filter* filter) {
+    return guarded([&] {
+        if (filter == nullptr) throw std::invalid_argument("null filter");
+        filter->processor.finish();
+    });
+}
+
+void vglog_filter_free(vglog_filter* filter) {
+    delete filter;
+}
+
+const char* vglog_last_error(void) {
+    return last_error.c_str();
+}
+
+const char* vglog_version(void) {
+    return VGLOG_FILTER_VERSION;
+}
+
+} // extern "C"
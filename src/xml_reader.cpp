@@ -0,0 +1,317 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include "xml_reader.h"
+
+#include <charconv>
+#include <cstring>
+#include <istream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+constinit inline std::size_t MAX_XML_TOKEN_BYTES = 1024u * 1024u; // longest tag or text run
+
+[[noreturn]] void malformed(std::string_view what) {
+    throw std::runtime_error("Malformed XML input: " + std::string{what});
+}
+
+void append_utf8(std::uint32_t cp, std::string& out) {
+    if (cp < 0x80) {
+        out.push_back(static_cast<char>(cp));
+    } else if (cp < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x110000) {
+        out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else {
+        malformed("character reference out of range");
+    }
+}
+
+// Appends `raw` to `out` with the predefined entities and character references decoded.
+void decode_entities(std::string_view raw, std::string& out) {
+    while (!raw.empty()) {
+        const auto amp = raw.find('&');
+        out.append(raw.substr(0, amp));
+        if (amp == std::string_view::npos) return;
+        raw.remove_prefix(amp);
+        const auto semi = raw.find(';');
+        if (semi == std::string_view::npos) malformed("unterminated entity");
+        const std::string_view ent = raw.substr(1, semi - 1);
+        if      (ent == "lt")   out.push_back('<');
+        else if (ent == "gt")   out.push_back('>');
+        else if (ent == "amp")  out.push_back('&');
+        else if (ent == "quot") out.push_back('"');
+        else if (ent == "apos") out.push_back('\'');
+        else if (ent.size() > 1 && ent[0] == '#') {
+            const bool hex = ent[1] == 'x' || ent[1] == 'X';
+            const std::string_view digits = ent.substr(hex ? 2 : 1);
+            std::uint32_t cp = 0;
+            const auto [end, ec] = std::from_chars(digits.data(), digits.data() + digits.size(), cp, hex ? 16 : 10);
+            if (ec != std::errc{} || end != digits.data() + digits.size()) malformed("bad character reference");
+            append_utf8(cp, out);
+        } else {
+            malformed("unknown entity '&" + std::string{ent} + ";'");
+        }
+        raw.remove_prefix(semi + 1);
+    }
+}
+
+// Reads the input in chunks into one window. A token (tag or text run) is
+// always contiguous: a refill keeps the unconsumed tail and moves it to the
+// front, so the window only grows past one chunk for a token that long.
+class Parser {
+public:
+    Parser(std::istream& in, XmlHandler& handler, std::size_t chunk_bytes)
+        : in_(in), handler_(handler), chunk_(chunk_bytes > 0 ? chunk_bytes : 1) {}
+
+    void run() {
+        for (;;) {
+            const auto lt = find("<", 0);
+            if (lt == std::string_view::npos) {
+                text(avail());
+                return;
+            }
+            if (lt > 0) text(avail().substr(0, lt));
+            pos_ += lt;
+
+            if (starts("<!--")) {
+                skip_past("-->", 4, "unterminated comment");
+            } else if (starts("<![CDATA[")) {
+                const auto end = find("]]>", 9);
+                if (end == std::string_view::npos) malformed("unterminated CDATA section");
+                handler_.characters(avail().substr(9, end - 9));
+                pos_ += end + 3;
+            } else {
+                const auto gt = find(">", 1);
+                if (gt == std::string_view::npos) malformed("unterminated tag");
+                const std::string_view body = avail().substr(1, gt - 1);
+                pos_ += gt + 1;
+                tag(body);
+                if (handler_.done()) return;
+            }
+        }
+    }
+
+private:
+    [[nodiscard]] std::string_view avail() const noexcept { return {buf_.data() + pos_, end_ - pos_}; }
+
+    // Moves the unconsumed bytes to the front and reads one more chunk.
+    bool refill() {
+        if (pos_ > 0) {
+            std::memmove(buf_.data(), buf_.data() + pos_, end_ - pos_);
+            end_ -= pos_;
+            pos_ = 0;
+        }
+        if (end_ > MAX_XML_TOKEN_BYTES) malformed("tag or text longer than 1 MB");
+        if (buf_.size() < end_ + chunk_) buf_.resize(end_ + chunk_);
+        in_.read(buf_.data() + end_, static_cast<std::streamsize>(chunk_));
+        const auto got = static_cast<std::size_t>(in_.gcount());
+        end_ += got;
+        return got > 0;
+    }
+
+    // Offset of `delim` from pos_, searching from `from`; npos at end of input.
+    std::size_t find(std::string_view delim, std::size_t from) {
+        for (;;) {
+            if (const auto at = avail().find(delim, from); at != std::string_view::npos) return at;
+            const std::size_t have = end_ - pos_;
+            from = have >= delim.size() ? have - delim.size() + 1 : 0;
+            if (!refill()) return std::string_view::npos;
+        }
+    }
+
+    bool starts(std::string_view prefix) {
+        while (end_ - pos_ < prefix.size()) {
+            if (!refill()) break;
+        }
+        return avail().starts_with(prefix);
+    }
+
+    void skip_past(std::string_view delim, std::size_t from, std::string_view error) {
+        const auto at = find(delim, from);
+        if (at == std::string_view::npos) malformed(error);
+        pos_ += at + delim.size();
+    }
+
+    void text(std::string_view raw) {
+        if (raw.find('&') == std::string_view::npos) {
+            handler_.characters(raw);
+            return;
+        }
+        decoded_.clear();
+        decode_entities(raw, decoded_);
+        handler_.characters(decoded_);
+    }
+
+    void tag(std::string_view body) {
+        if (body.empty()) malformed("empty tag");
+        if (body[0] == '?' || body[0] == '!') return; // declaration, DOCTYPE
+        if (body[0] == '/') {
+            body.remove_prefix(1);
+            handler_.end_element(body.substr(0, body.find_first_of(" \t\r\n")));
+            return;
+        }
+        const bool empty_element = body.back() == '/';
+        const std::string_view name = body.substr(0, body.find_first_of(" \t\r\n/"));
+        if (name.empty()) malformed("tag without a name");
+        handler_.start_element(name);
+        if (empty_element) handler_.end_element(name);
+    }
+
+    std::istream&     in_;
+    XmlHandler&       handler_;
+    std::size_t       chunk_;
+    std::vector<char> buf_;
+    std::size_t       pos_{0};
+    std::size_t       end_{0};
+    std::string       decoded_;
+};
+
+// Turns the elements of a Valgrind XML document into text-log style blocks.
+class ValgrindXml final : public XmlHandler {
+public:
+    explicit ValgrindXml(XmlBlockSink& sink) : sink_(sink) {}
+
+    void start_element(std::string_view name) override {
+        open_.emplace_back(name);
+        text_.clear();
+        if (name == "error" || name == "fatal_signal") {
+            in_block_ = true;
+            begun_    = false;
+            kind_     = name == "error" ? BlockKind::Other : BlockKind::Fatal;
+            signo_.clear();
+            signame_.clear();
+            event_.clear();
+            siaddr_.clear();
+        } else if (in_block_ && name == "stack") {
+            if (kind_ == BlockKind::Fatal) fatal_header();
+            frame_index_ = 0;
+        } else if (in_block_ && name == "frame") {
+            ip_.clear();
+            obj_.clear();
+            fn_.clear();
+            file_.clear();
+            line_.clear();
+        }
+    }
+
+    void end_element(std::string_view name) override {
+        if (open_.empty() || open_.back() != name) malformed("mismatched </" + std::string{name} + ">");
+        const std::string_view parent = open_.size() >= 2 ? std::string_view{open_[open_.size() - 2]} : std::string_view{};
+
+        if (!in_block_) {
+            if (name == "pid" && parent == "valgrindoutput") pid_ = parse_u32(text_);
+        } else if (parent == "frame") {
+            if      (name == "ip")   ip_   = text_;
+            else if (name == "obj")  obj_  = text_;
+            else if (name == "fn")   fn_   = text_;
+            else if (name == "file") file_ = text_;
+            else if (name == "line") line_ = text_;
+        } else if (name == "frame") {
+            frame_line();
+        } else if (name == "kind" && parent == "error") {
+            kind_ = classify_xml_kind(text_);
+        } else if ((name == "what" || name == "auxwhat") && parent == "error") {
+            emit(text_);
+        } else if (name == "text" && (parent == "xwhat" || parent == "xauxwhat")) {
+            emit(text_);
+        } else if (parent == "fatal_signal") {
+            if      (name == "signo")   signo_   = text_;
+            else if (name == "signame") signame_ = text_;
+            else if (name == "event")   event_   = text_;
+            else if (name == "siaddr")  siaddr_  = text_;
+        }
+
+        if (name == "error" || name == "fatal_signal") {
+            if (kind_ == BlockKind::Fatal) fatal_header(); // no stack
+            if (begun_) sink_.end_block();
+            in_block_ = false;
+        }
+        open_.pop_back();
+        text_.clear();
+    }
+
+    void characters(std::string_view text) override { text_.append(text); }
+
+    [[nodiscard]] bool done() const noexcept override { return sink_.done(); }
+
+private:
+    [[nodiscard]] static std::uint32_t parse_u32(std::string_view sv) noexcept {
+        std::uint32_t v = 0;
+        (void)std::from_chars(sv.data(), sv.data() + sv.size(), v);
+        return v;
+    }
+
+    void emit(std::string_view line) {
+        if (!begun_) {
+            sink_.begin_block(pid_, kind_);
+            begun_ = true;
+        }
+        sink_.line(line);
+    }
+
+    // "Process terminating with default action of signal 11 (SIGSEGV)" and the
+    // access line, as the text log words them; written once per fatal_signal.
+    void fatal_header() {
+        if (begun_) return;
+        scratch_.assign("Process terminating with default action of signal ").append(signo_);
+        if (!signame_.empty()) scratch_.append(" (").append(signame_).append(")");
+        emit(scratch_);
+        if (!event_.empty()) {
+            scratch_.assign(event_);
+            if (!siaddr_.empty()) scratch_.append(" at address ").append(siaddr_);
+            emit(scratch_);
+        }
+    }
+
+    void frame_line() {
+        scratch_.assign(frame_index_++ == 0 ? "at " : "by ");
+        scratch_.append(ip_.empty() ? std::string_view{"0x0"} : std::string_view{ip_}).append(": ");
+        scratch_.append(fn_.empty() ? std::string_view{"???"} : std::string_view{fn_});
+        if (!file_.empty()) {
+            scratch_.append(" (").append(file_);
+            if (!line_.empty()) scratch_.append(":").append(line_);
+            scratch_.push_back(')');
+        } else if (!obj_.empty()) {
+            scratch_.append(" (in ").append(obj_).push_back(')');
+        }
+        emit(scratch_);
+    }
+
+    XmlBlockSink&            sink_;
+    std::vector<std::string> open_;    // element path; Valgrind nests about six deep
+    std::string              text_;    // character data of the innermost element
+    std::string              scratch_;
+    std::uint32_t            pid_{0};
+    bool                     in_block_{false};
+    bool                     begun_{false};
+    BlockKind                kind_{BlockKind::Other};
+    std::size_t              frame_index_{0};
+    std::string              ip_, obj_, fn_, file_, line_;
+    std::string              signo_, signame_, event_, siaddr_;
+};
+
+} // namespace
+
+void parse_xml(std::istream& in, XmlHandler& handler, std::size_t chunk_bytes) {
+    Parser(in, handler, chunk_bytes).run();
+}
+
+void read_valgrind_xml(std::istream& in, XmlBlockSink& sink, std::size_t chunk_bytes) {
+    ValgrindXml handler(sink);
+    parse_xml(in, handler, chunk_bytes);
+}
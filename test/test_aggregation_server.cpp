@@ -0,0 +1,240 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include <barrier>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "test_helpers.h"
+#include <aggregation_server.h>
+#include <log_processor.h>
+
+namespace {
+
+const std::string SOCKET = "test_aggregation_server.sock";
+
+// One test process: a read every client reports, a leak, and a block of its own.
+std::string client_log(int n) {
+    return "==4242== Invalid read of size 4\n"
+           "==4242==    at 0x401234: main (a.cpp:10)\n"
+           "==4242== \n"
+           "==4242== Invalid read of size 4\n"
+           "==4242==    at 0x401999: main (a.cpp:10)\n"
+           "==4242== \n"
+           "==4242== 16 bytes in 1 blocks are definitely lost in loss record 1 of 1\n"
+           "==4242==    at 0x4C2AB80: malloc (in /usr/lib/valgrind/vgpreload_memcheck-amd64-linux.so)\n"
+           "==4242==    by 0x401300: make (b.cpp:20)\n"
+           "==4242== \n"
+           "==4242== Invalid write of size " + std::to_string(n + 1) + "\n"
+           "==4242==    at 0x401500: test_" + std::to_string(n) + " (t.cpp:5)\n";
+}
+
+int connect_to_server() {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    SOCKET.copy(addr.sun_path, SOCKET.size());
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+        throw std::runtime_error("connect failed");
+    }
+    return fd;
+}
+
+void send_in_pieces(int fd, std::string_view data) {
+    while (!data.empty()) {
+        const auto n = ::send(fd, data.data(), std::min<std::size_t>(data.size(), 7), MSG_NOSIGNAL);
+        if (n <= 0) break;
+        data.remove_prefix(static_cast<std::size_t>(n));
+    }
+}
+
+// Closes the sending side and returns the reply.
+std::string finish_exchange(int fd) {
+    ::shutdown(fd, SHUT_WR);
+    std::string reply;
+    char        buf[4096];
+    for (ssize_t n; (n = ::read(fd, buf, sizeof(buf))) > 0;) reply.append(buf, static_cast<std::size_t>(n));
+    ::close(fd);
+    return reply;
+}
+
+// Sends `data`, closes the sending side and returns the reply.
+std::string exchange(std::string_view data) {
+    const int fd = connect_to_server();
+    send_in_pieces(fd, data);
+    return finish_exchange(fd);
+}
+
+std::size_t count(const std::string& haystack, std::string_view needle) {
+    std::size_t n = 0;
+    for (auto pos = haystack.find(needle); pos != std::string::npos; pos = haystack.find(needle, pos + 1)) ++n;
+    return n;
+}
+
+std::vector<std::string> lines_of(const std::string& text) {
+    std::vector<std::string> lines;
+    std::istringstream in(text);
+    for (std::string l; std::getline(in, l);) lines.push_back(l);
+    return lines;
+}
+
+} // namespace
+
+bool test_block_aggregate() {
+    std::cout << "\n=== Testing the block aggregate ===" << std::endl;
+
+    Options opt;
+    opt.trim = false;
+    std::vector<std::unique_ptr<LogProcessor>> runs;
+    BlockAggregate aggregate(3); // rounded up to 4 shards
+    for (int n = 0; n < 2; ++n) {
+        auto& p = runs.emplace_back();
+        p = std::make_unique<LogProcessor>(opt, [&aggregate, &runs, n](std::size_t index, std::string_view text) {
+            aggregate.merge(runs[static_cast<std::size_t>(n)]->blocks(), index, text);
+        });
+        p->process_lines(lines_of(client_log(n)));
+    }
+    TEST_ASSERT(aggregate.size() == 4, "Shared blocks merged, own blocks kept");
+
+    std::ostringstream text;
+    aggregate.write_report(text, OutputFormat::Text);
+    TEST_ASSERT(text.str().starts_with("Invalid read of size 4\nmain (a.cpp:10)\n\n16 bytes in 1 blocks") ||
+                text.str().starts_with("Invalid read of size 4\nmain (a.cpp:10)\n\nmalloc"), "First-merge order");
+    TEST_ASSERT(count(text.str(), "Invalid write of size 2\ntest_1 (t.cpp:5)") == 1 && count(text.str(), "\n\n") == 4, "Text report");
+
+    std::ostringstream records;
+    aggregate.write_report(records, OutputFormat::Ndjson);
+    TEST_ASSERT(count(records.str(), "\"count\":4,\"bytes\":16") == 1, "Reads summed over runs");
+    TEST_ASSERT(count(records.str(), "\"kind\":\"definitely-lost\"") == 1 &&
+                records.str().find("\"count\":2,\"bytes\":32,\"blocks\":2") != std::string::npos, "Leak summed");
+    TEST_ASSERT(records.str().find("{\"fn\":\"make\",\"file\":\"b.cpp\",\"line\":20}") != std::string::npos,
+                "Frames copied from the run's store");
+
+    TEST_PASS("Block aggregate tests completed");
+    return true;
+}
+
+bool test_server() {
+    std::cout << "\n=== Testing --serve ===" << std::endl;
+
+    std::remove(SOCKET.c_str());
+    Options opt;
+    opt.trim = false;
+    AggregationServer server(SOCKET, opt, 4);
+    std::thread serving([&server] { server.run(); });
+    struct Stop {
+        AggregationServer& server;
+        std::thread&       serving;
+        ~Stop() {
+            server.stop();
+            if (serving.joinable()) serving.join();
+        }
+    } stop_on_return{server, serving};
+
+    constexpr int CLIENTS = 16;
+    std::vector<std::thread> clients;
+    for (int n = 0; n < CLIENTS; ++n) clients.emplace_back([n] { (void)exchange(client_log(n % 8)); });
+    for (auto& c : clients) c.join();
+    TEST_ASSERT(server.aggregate().size() == 2 + 8, "Deduped across connections");
+
+    const std::string records = exchange("REPORT ndjson\n");
+    TEST_ASSERT(count(records, "\n") == 10 && count(records, "\"count\":32,") == 1, "Reads of all clients counted");
+    TEST_ASSERT(count(records, "\"kind\":\"invalid-write\",\"fingerprint\":") == 8 && count(records, "\"count\":2,") == 8,
+                "Per-test blocks from two clients each");
+    TEST_ASSERT(exchange("REPORT\n").starts_with("Invalid read of size 4\nmain (a.cpp:10)\n\n"), "Server --format");
+
+    std::ostringstream queried;
+    query_server(SOCKET, OutputFormat::Json, queried);
+    TEST_ASSERT(queried.str().starts_with("[\n{\"kind\":\"invalid-read\"") && queried.str().ends_with("]\n"), "--query");
+    TEST_ASSERT(exchange("REPORT yaml\n").starts_with("ERROR Unknown output format"), "Bad report format");
+
+    bool refused = false;
+    try {
+        AggregationServer second(SOCKET, opt, 1);
+    } catch (const std::runtime_error&) {
+        refused = true;
+    }
+    TEST_ASSERT(refused, "A live socket is not taken over");
+
+    server.stop();
+    serving.join();
+    TEST_ASSERT(::access(SOCKET.c_str(), F_OK) == 0, "Socket kept until the server is destroyed");
+
+    TEST_PASS("--serve tests completed");
+    return true;
+}
+
+bool test_shared_workers() {
+    std::cout << "\n=== Testing more clients than workers ===" << std::endl;
+
+    std::remove(SOCKET.c_str());
+    Options opt;
+    opt.trim = false;
+    AggregationServer server(SOCKET, opt, 2);
+    std::thread serving([&server] { server.run(); });
+    struct Stop {
+        AggregationServer& server;
+        std::thread&       serving;
+        ~Stop() {
+            server.stop();
+            if (serving.joinable()) serving.join();
+        }
+    } stop_on_return{server, serving};
+
+    // Every client sends half of its log, then waits until all of them got
+    // that far (and a report was answered) before sending the rest. A worker
+    // held by one connection until it closes would never see the others.
+    constexpr int CLIENTS = 12;
+    std::barrier halfway(CLIENTS + 1);
+    std::vector<std::thread> clients;
+    for (int n = 0; n < CLIENTS; ++n) {
+        clients.emplace_back([n, &halfway] {
+            const std::string log = client_log(n);
+            const int fd = connect_to_server();
+            send_in_pieces(fd, std::string_view{log}.substr(0, log.size() / 2));
+            halfway.arrive_and_wait();
+            send_in_pieces(fd, std::string_view{log}.substr(log.size() / 2));
+            (void)finish_exchange(fd);
+        });
+    }
+    const std::string report = exchange("REPORT json\n");
+    halfway.arrive_and_wait();
+    for (auto& c : clients) c.join();
+    TEST_ASSERT(report.starts_with("["), "Report answered while every run is open");
+
+    const std::string records = exchange("REPORT ndjson\n");
+    TEST_ASSERT(server.aggregate().size() == 2 + CLIENTS, "Every run merged");
+    TEST_ASSERT(count(records, "\"count\":24,") == 1, "Reads of all clients counted");
+
+    TEST_PASS("Shared worker tests completed");
+    return true;
+}
+
+int main() {
+    std::cout << "Running aggregation server tests..." << std::endl;
+
+    bool all_passed = true;
+
+    all_passed &= test_block_aggregate();
+    all_passed &= test_server();
+    all_passed &= test_shared_workers();
+
+    if (all_passed) {
+        std::cout << "\n✅ All aggregation server tests passed!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "\n❌ Some aggregation server tests failed!" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,143 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "test_helpers.h"
+#include <block_kind.h>
+#include <log_processor.h>
+
+namespace {
+
+const std::vector<std::string> LOG{
+    "==4242== Invalid read of size 4",
+    "==4242==    at 0x401234: main (a.cpp:10)",
+    "==4242== Invalid read of size 4",
+    "==4242==    at 0x401234: main (a.cpp:10)",
+    "==4242== Invalid write of size 8",
+    "==4242==    at 0x401300: helper (b.cpp:20)",
+    "==4242== 16 bytes in 1 blocks are definitely lost in loss record 1 of 1",
+    "==4242==    at 0x4C2AB80: malloc (vg_replace_malloc.c:299)",
+    "==4242== Conditional jump or move depends on uninitialised value(s)",
+    "==4242==    at 0x401500: check (c.cpp:5)",
+};
+
+struct Run {
+    std::string output;
+    bool        stopped;
+    bool        matched;
+};
+
+Run run(const Options& opt) {
+    LogProcessor p(opt);
+    std::string output = capture_stdout([&] { p.process_lines(LOG); });
+    return {std::move(output), p.stopped(), p.fail_on_match().has_value()};
+}
+
+bool parse_throws(std::string_view list) {
+    try {
+        (void)parse_block_kinds(list);
+    } catch (const std::runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+} // namespace
+
+bool test_classification() {
+    std::cout << "\n=== Testing block classification ===" << std::endl;
+
+    TEST_ASSERT(classify_block("Invalid read of size 4") == BlockKind::InvalidRead, "Invalid read");
+    TEST_ASSERT(classify_block("Invalid write of size 1") == BlockKind::InvalidWrite, "Invalid write");
+    TEST_ASSERT(classify_block("Syscall param write(buf) points to uninitialised byte(s)") == BlockKind::SyscallParam,
+                "Syscall param wins over 'uninitialised'");
+    TEST_ASSERT(classify_block("Conditional jump or move depends on uninitialised value(s)") == BlockKind::Uninitialised,
+                "Conditional jump");
+    TEST_ASSERT(classify_block("8 bytes in 1 blocks are definitely lost in loss record 2 of 9") == BlockKind::DefinitelyLost,
+                "Leak record");
+    TEST_ASSERT(classify_block("8 bytes in 1 blocks are still reachable in loss record 1 of 9") == BlockKind::StillReachable,
+                "Reachable record");
+    TEST_ASSERT(classify_block("Process terminating with default action of signal 11 (SIGSEGV)") == BlockKind::Fatal,
+                "Fatal signal");
+    TEST_ASSERT(classify_block("something else") == BlockKind::Other, "Unknown start line");
+    TEST_ASSERT(classify_xml_kind("Leak_PossiblyLost") == BlockKind::PossiblyLost &&
+                classify_xml_kind("UninitCondition") == BlockKind::Uninitialised &&
+                classify_xml_kind("Race") == BlockKind::DataRace &&
+                classify_xml_kind("InvalidFree") == BlockKind::Other, "XML <kind> values");
+    TEST_ASSERT(block_kind_name(BlockKind::DefinitelyLost) == "definitely-lost", "Kind names");
+
+    TEST_PASS("Block classification tests completed");
+    return true;
+}
+
+bool test_kind_lists() {
+    std::cout << "\n=== Testing --fail-on kind lists ===" << std::endl;
+
+    TEST_ASSERT(parse_block_kinds("invalid-write") == kind_bit(BlockKind::InvalidWrite), "Single kind");
+    TEST_ASSERT(parse_block_kinds("definitely-lost,invalid-write") ==
+                (kind_bit(BlockKind::DefinitelyLost) | kind_bit(BlockKind::InvalidWrite)), "Kind list");
+    const auto any = parse_block_kinds("any");
+    TEST_ASSERT((any & kind_bit(BlockKind::Fatal)) != 0 && (any & kind_bit(BlockKind::ThreadApi)) != 0 &&
+                (any & kind_bit(BlockKind::Other)) == 0,
+                "'any' covers every real kind");
+    TEST_ASSERT(parse_throws("invalid-jump"), "Unknown kind rejected");
+    TEST_ASSERT(parse_throws(""), "Empty list rejected");
+
+    TEST_PASS("Kind list tests completed");
+    return true;
+}
+
+bool test_early_exit() {
+    std::cout << "\n=== Testing early exit ===" << std::endl;
+
+    Options opt;
+    opt.trim  = false;
+    opt.depth = 0;
+    const auto full = run(opt);
+    TEST_ASSERT(!full.stopped && !full.matched, "No limits: whole input processed");
+
+    opt.max_unique = 2;
+    const auto two = run(opt);
+    TEST_ASSERT(two.stopped && !two.matched, "--max-unique stops");
+    TEST_ASSERT(two.output == "Invalid read of size 4\nmain (a.cpp:10)\n\nInvalid write of size 8\nhelper (b.cpp:20)\n\n",
+                "Exactly two unique blocks printed, nothing of the next block");
+
+    opt.max_unique = 0;
+    opt.fail_on    = parse_block_kinds("definitely-lost");
+    const auto leak = run(opt);
+    TEST_ASSERT(leak.stopped && leak.matched, "--fail-on matches a leak record");
+    TEST_ASSERT(leak.output.ends_with("malloc (vg_replace_malloc.c:299)\n\n"), "Matching block is printed last");
+
+    opt.fail_on = parse_block_kinds("fatal");
+    const auto none = run(opt);
+    TEST_ASSERT(!none.stopped && !none.matched && none.output == full.output, "Absent kind: full output, no match");
+
+    TEST_PASS("Early exit tests completed");
+    return true;
+}
+
+int main() {
+    std::cout << "Running block kind tests..." << std::endl;
+
+    bool all_passed = true;
+
+    all_passed &= test_classification();
+    all_passed &= test_kind_lists();
+    all_passed &= test_early_exit();
+
+    if (all_passed) {
+        std::cout << "\n✅ All block kind tests passed!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "\n❌ Some block kind tests failed!" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,221 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "test_helpers.h"
+#include <block_store.h>
+#include <log_processor.h>
+
+namespace {
+
+const std::vector<std::string> LOG{
+    "==4242== Invalid read of size 4",
+    "==4242==    at 0x401234: main (a.cpp:10)",
+    "==4242== 1024 bytes in 3 blocks are definitely lost in loss record 2 of 2",
+    "==4242==    at 0x4C2AB80: malloc (in /usr/lib/valgrind/vgpreload_memcheck-amd64-linux.so)",
+    "==4242==    by 0x401300: std::function<void (int)>::operator()(int) const (b.cpp:20)",
+    "==4242== Invalid read of size 4",
+    "==4242==    at 0x401999: main (a.cpp:10)",
+    "==4242== 512 bytes in 1 blocks are definitely lost in loss record 1 of 2",
+    "==4242==    at 0x4C2AB80: malloc (in /usr/lib/valgrind/vgpreload_memcheck-amd64-linux.so)",
+    "==4242==    by 0x401300: std::function<void (int)>::operator()(int) const (b.cpp:20)",
+};
+
+const std::vector<std::string> RANKED_LOG{
+    "==4242== Invalid read of size 4",
+    "==4242==    at 0x401234: main (a.cpp:10)",
+    "==4242== 100 bytes in 1 blocks are definitely lost in loss record 1 of 2",
+    "==4242==    at 0x401300: f (b.cpp:20)",
+    "==4242== Conditional jump or move depends on uninitialised value(s)",
+    "==4242==    at 0x401400: h (c.cpp:7)",
+    "==4242== Invalid read of size 4",
+    "==4242==    at 0x401234: main (a.cpp:10)",
+    "==4242== 5,000 bytes in 2 blocks are possibly lost in loss record 2 of 2",
+    "==4242==    at 0x401500: g (d.cpp:1)",
+    "==4242== Conditional jump or move depends on uninitialised value(s)",
+    "==4242==    at 0x401400: h (c.cpp:7)",
+    "==4242== Invalid read of size 4",
+    "==4242==    at 0x401234: main (a.cpp:10)",
+};
+
+std::string run_ranked(Options opt) {
+    opt.trim = false;
+    return opt.stream_mode ? run_stream(opt, RANKED_LOG) : run_lines(opt, RANKED_LOG);
+}
+
+} // namespace
+
+bool test_frame_parsing() {
+    std::cout << "\n=== Testing frame parsing ===" << std::endl;
+
+    const auto src = parse_frame("   at 0x401234: main (a.cpp:10)");
+    TEST_ASSERT(src && src->function == "main" && src->file == "a.cpp" && src->line == 10 && src->object.empty(),
+                "Source location");
+    const auto obj = parse_frame("by 0x4C2AB80: malloc (in /usr/lib/libc.so.6)");
+    TEST_ASSERT(obj && obj->function == "malloc" && obj->object == "/usr/lib/libc.so.6" && obj->file.empty(),
+                "Object location");
+    const auto nested = parse_frame("by 0x1: (below main) (libc-start.c:308)");
+    TEST_ASSERT(nested && nested->function == "(below main)" && nested->line == 308, "Parentheses in the name");
+    const auto bare = parse_frame("at 0x4C2AB80: ???");
+    TEST_ASSERT(bare && bare->function == "???" && bare->file.empty(), "Frame without location");
+    TEST_ASSERT(!parse_frame("Address 0x1 is 0 bytes inside a block of size 8 alloc'd"), "Not a frame");
+
+    TEST_PASS("Frame parsing tests completed");
+    return true;
+}
+
+bool test_header_counts() {
+    std::cout << "\n=== Testing header counts ===" << std::endl;
+
+    const auto access = parse_header_counts("Invalid write of size 8");
+    TEST_ASSERT(access.bytes == 8 && access.heap_blocks == 0, "Access size");
+    const auto leak = parse_header_counts("1,024 (16 direct, 1,008 indirect) bytes in 3 blocks are definitely lost");
+    TEST_ASSERT(leak.bytes == 1024 && leak.heap_blocks == 3, "Leak record with separators");
+    const auto none = parse_header_counts("Conditional jump or move depends on uninitialised value(s)");
+    TEST_ASSERT(none.bytes == 0 && none.heap_blocks == 0, "No figures");
+
+    TEST_PASS("Header count tests completed");
+    return true;
+}
+
+bool test_records_from_processing() {
+    std::cout << "\n=== Testing block records ===" << std::endl;
+
+    Options opt;
+    opt.trim = false;
+    LogProcessor p(opt);
+    (void)capture_stdout([&] { p.process_lines(LOG); });
+
+    const BlockStore& store = p.blocks();
+    TEST_ASSERT(store.size() == 2, "One record per unique block");
+    TEST_ASSERT(store.kind(0) == BlockKind::InvalidRead && store.header(0) == "Invalid read of size 4", "Kind and header");
+    TEST_ASSERT(store.occurrences(0) == 2 && store.bytes(0) == 8, "Duplicates add to the record");
+
+    TEST_ASSERT(store.kind(1) == BlockKind::DefinitelyLost, "Leak kind");
+    TEST_ASSERT(store.occurrences(1) == 2 && store.bytes(1) == 1536 && store.heap_blocks(1) == 4,
+                "Leaked bytes and blocks are summed");
+    const auto frames = store.frames(1);
+    TEST_ASSERT(frames.size() == 2, "Both frames kept");
+    const auto& names = store.strings();
+    TEST_ASSERT(names[frames[0].function] == "malloc" && names[frames[0].file].empty() &&
+                names[frames[0].object] == "/usr/lib/valgrind/vgpreload_memcheck-amd64-linux.so",
+                "Frame fields are interned");
+    TEST_ASSERT(names[frames[1].function] == "std::function<void (int)>::operator()(int) const" &&
+                names[frames[1].file] == "b.cpp" && frames[1].line == 20, "Source frame");
+    TEST_ASSERT(store.frames(0).size() == 1 && names[store.frames(0)[0].function] == "main", "Frames per record");
+
+    TEST_PASS("Block record tests completed");
+    return true;
+}
+
+bool test_other_stacks() {
+    std::cout << "\n=== Testing stacks after the block's own ===" << std::endl;
+
+    BlockStore store;
+    (void)store.add(BlockKind::DataRace, 1, "Possible data race during read of size 4 at 0x5 by thread #1", {});
+    for (const std::string_view line : {
+             "Possible data race during read of size 4 at 0x5 by thread #1",
+             "Locks held: none",
+             "   at 0x1: reader (r.cpp:5)",
+             "   by 0x2: start (t.cpp:9)",
+             "This conflicts with a previous write of size 4 by thread #2",
+             "Locks held: 1, at address 0x6",
+             "   at 0x3: writer (w.cpp:7)",
+             "Address 0x5 is 0 bytes inside data symbol \"shared\"",
+         }) {
+        store.add_line(line);
+    }
+    const auto& names = store.strings();
+    TEST_ASSERT(store.stack(0).size() == 2 && store.frames(0).size() == 3, "Own stack ends at the next line");
+    const auto others = store.other_stacks(0);
+    TEST_ASSERT(others.size() == 1 && names[others[0].message] ==
+                "This conflicts with a previous write of size 4 by thread #2", "Named by the line after the frames");
+    TEST_ASSERT(store.frames(others[0]).size() == 1 && names[store.frames(others[0])[0].function] == "writer",
+                "Frames of the other stack");
+
+    BlockStore merged;
+    (void)merged.add(BlockKind::InvalidRead, 2, "Invalid read of size 4", {});
+    merged.add_line("   at 0x9: main (m.cpp:1)");
+    (void)merged.append(store, 0);
+    const auto copied = merged.other_stacks(1);
+    TEST_ASSERT(merged.other_stacks(0).empty() && copied.size() == 1, "Other stacks per record");
+    TEST_ASSERT(merged.strings()[merged.frames(copied[0])[0].function] == "writer" &&
+                merged.strings()[copied[0].message] == names[others[0].message], "append() copies them");
+
+    TEST_PASS("Other stack tests completed");
+    return true;
+}
+
+bool test_top_ranking() {
+    std::cout << "\n=== Testing --top ranking ===" << std::endl;
+
+    const std::string read  = "Invalid read of size 4\nmain (a.cpp:10)\n\n";
+    const std::string cond  = "Conditional jump or move depends on uninitialised value(s)\nh (c.cpp:7)\n\n";
+    const std::string small = "f (b.cpp:20)\n\n";
+    const std::string large = "5,000 bytes in 2 blocks are possibly lost in loss record 2 of 2\ng (d.cpp:1)\n\n";
+
+    Options opt;
+    opt.top = 2;
+    TEST_ASSERT(run_ranked(opt) == read + cond, "Top blocks by count");
+    opt.rank_by = RankBy::Bytes;
+    TEST_ASSERT(run_ranked(opt) == large + small, "Top leaks by bytes");
+
+    opt.top     = 10;
+    opt.rank_by = RankBy::Count;
+    TEST_ASSERT(run_ranked(opt) == read + cond + small + large, "Ties keep output order");
+    opt.stream_mode = true;
+    TEST_ASSERT(run_ranked(opt) == read + cond + small + large, "Stream mode re-reads the ranked blocks");
+
+    opt.top         = 1;
+    opt.stream_mode = false;
+    opt.format      = OutputFormat::Ndjson;
+    const std::string record = run_ranked(opt);
+    TEST_ASSERT(record.find("\"count\":3") != std::string::npos && record.find('\n') == record.size() - 1,
+                "Records are ranked too");
+
+    TEST_PASS("--top ranking tests completed");
+    return true;
+}
+
+bool test_interning() {
+    std::cout << "\n=== Testing string interning ===" << std::endl;
+
+    StringTable t;
+    const auto a = t.intern("main");
+    TEST_ASSERT(a != 0 && t.intern("main") == a && t.intern("helper") != a, "Equal strings share an ID");
+    TEST_ASSERT(t.intern("") == 0 && t[0].empty(), "ID 0 is the empty string");
+    TEST_ASSERT(t.size() == 2 && t[a] == "main", "Lookup by ID");
+    t.clear();
+    TEST_ASSERT(t.size() == 0 && t.intern("x") == 1, "Cleared table starts over");
+
+    TEST_PASS("String interning tests completed");
+    return true;
+}
+
+int main() {
+    std::cout << "Running block store tests..." << std::endl;
+
+    bool all_passed = true;
+
+    all_passed &= test_frame_parsing();
+    all_passed &= test_header_counts();
+    all_passed &= test_records_from_processing();
+    all_passed &= test_other_stacks();
+    all_passed &= test_top_ranking();
+    all_passed &= test_interning();
+
+    if (all_passed) {
+        std::cout << "\n✅ All block store tests passed!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "\n❌ Some block store tests failed!" << std::endl;
+        return 1;
+    }
+}
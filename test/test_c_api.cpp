@@ -0,0 +1,150 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "test_helpers.h"
+#include <log_processor.h>
+#include <vglog_filter.h>
+
+namespace {
+
+const std::string LOG =
+    "==4242== Invalid read of size 4\n"
+    "==4242==    at 0x401234: main (a.cpp:10)\n"
+    "==4242== \n"
+    "==4242== 1024 bytes in 3 blocks are definitely lost in loss record 2 of 2\n"
+    "==4242==    at 0x4C2AB80: malloc (in /usr/lib/valgrind/vgpreload_memcheck-amd64-linux.so)\n"
+    "==4242==    by 0x401300: make (b.cpp:20)\n"
+    "==4242== \n"
+    "==4242== Invalid read of size 4\n"
+    "==4242==    at 0x401999: main (a.cpp:10)\n"
+    "==4242== \n"
+    "==4242== Conditional jump or move depends on uninitialised value(s)\n"
+    "==4242==    at 0x401400: check (c.cpp:7)"; // no final newline
+
+struct Collected {
+    std::vector<std::string> texts;
+    std::vector<std::string> kinds;
+    std::vector<vglog_block> blocks;
+};
+
+void collect(const vglog_block* block, void* user_data) {
+    auto* c = static_cast<Collected*>(user_data);
+    c->texts.emplace_back(block->text, block->length);
+    c->kinds.emplace_back(block->kind);
+    c->blocks.push_back(*block);
+}
+
+std::vector<std::string> lines_of(const std::string& text) {
+    std::vector<std::string> lines;
+    std::istringstream in(text);
+    for (std::string l; std::getline(in, l);) lines.push_back(l);
+    return lines;
+}
+
+} // namespace
+
+bool test_c_stream() {
+    std::cout << "\n=== Testing the C API ===" << std::endl;
+
+    vglog_options opt;
+    vglog_options_init(&opt);
+    TEST_ASSERT(opt.depth == 1 && opt.keep_debug_info == 0 && opt.raw == 0 && opt.marker == nullptr, "Defaults");
+    opt.keep_debug_info = 1;
+
+    Collected     got;
+    vglog_filter* f = vglog_filter_new(&opt, collect, &got);
+    TEST_ASSERT(f != nullptr, "Filter created");
+    // Odd chunk sizes: lines are split across calls
+    for (std::size_t i = 0; i < LOG.size(); i += 7) {
+        TEST_ASSERT(vglog_filter_feed(f, LOG.data() + i, std::min<std::size_t>(7, LOG.size() - i)) == 0, "Feed");
+    }
+    TEST_ASSERT(got.texts.size() == 2, "Blocks are delivered as they complete");
+    TEST_ASSERT(vglog_filter_finish(f) == 0 && got.texts.size() == 3, "finish() flushes the open block");
+    vglog_filter_free(f);
+
+    TEST_ASSERT(got.texts[0] == "Invalid read of size 4\nmain (a.cpp:10)" && got.kinds[0] == "invalid-read" &&
+                got.blocks[0].occurrences == 1 && got.blocks[0].bytes == 4, "First block");
+    TEST_ASSERT(got.texts[1] == "malloc (in /usr/lib/valgrind/vgpreload_memcheck-amd64-linux.so)\nmake (b.cpp:20)" &&
+                got.kinds[1] == "definitely-lost" && got.blocks[1].bytes == 1024 && got.blocks[1].heap_blocks == 3,
+                "Leak record");
+    TEST_ASSERT(got.kinds[2] == "uninitialised" && got.texts[2] == "Conditional jump or move depends on "
+                "uninitialised value(s)\ncheck (c.cpp:7)", "Unterminated last line");
+
+    // Same blocks as the executable prints
+    Options cli;
+    cli.trim = false;
+    TEST_ASSERT(run_lines(cli, lines_of(LOG)) == got.texts[0] + "\n\n" + got.texts[1] + "\n\n" + got.texts[2] + "\n\n",
+                "Matches text output");
+
+    TEST_PASS("C API tests completed");
+    return true;
+}
+
+bool test_c_errors() {
+    std::cout << "\n=== Testing C API errors ===" << std::endl;
+
+    vglog_options opt;
+    vglog_options_init(&opt);
+    Collected got;
+    TEST_ASSERT(vglog_filter_new(&opt, nullptr, nullptr) == nullptr && *vglog_last_error() != '\0', "No callback");
+    opt.canon_rules_file = "does-not-exist.rules";
+    TEST_ASSERT(vglog_filter_new(&opt, collect, &got) == nullptr && *vglog_last_error() != '\0', "Bad rules file");
+    TEST_ASSERT(vglog_filter_feed(nullptr, "x", 1) == -1, "Null filter");
+    TEST_ASSERT(*vglog_version() != '\0', "Version");
+
+    // A trimmed filter waits for the marker
+    vglog_options_init(&opt);
+    opt.marker    = "START";
+    vglog_filter* f = vglog_filter_new(&opt, collect, &got);
+    const std::string log = LOG + "\nSTART\n==4242== Invalid write of size 8\n==4242==    at 0x1: w (w.cpp:1)\n";
+    TEST_ASSERT(f != nullptr && vglog_filter_feed(f, log.data(), log.size()) == 0 && vglog_filter_finish(f) == 0,
+                "Trimmed run");
+    vglog_filter_free(f);
+    TEST_ASSERT(got.texts.size() == 1 && got.kinds[0] == "invalid-write", "Only blocks after the marker");
+
+    TEST_PASS("C API error tests completed");
+    return true;
+}
+
+bool test_cpp_callback() {
+    std::cout << "\n=== Testing the LogProcessor callback ===" << std::endl;
+
+    Options opt;
+    opt.trim = false;
+    std::vector<std::pair<std::size_t, std::string>> got;
+    LogProcessor p(opt, [&](std::size_t index, std::string_view text) { got.emplace_back(index, text); });
+    const std::string output = capture_stdout([&] { p.process_lines(lines_of(LOG)); });
+
+    TEST_ASSERT(output.empty(), "Nothing goes to std::cout");
+    TEST_ASSERT(got.size() == 3 && got[0].first == 0 && got[2].first == 2, "Record indices in output order");
+    TEST_ASSERT(p.blocks().occurrences(got[0].first) == 2, "Final counts at the end of input");
+
+    TEST_PASS("LogProcessor callback tests completed");
+    return true;
+}
+
+int main() {
+    std::cout << "Running C API tests..." << std::endl;
+
+    bool all_passed = true;
+
+    all_passed &= test_c_stream();
+    all_passed &= test_c_errors();
+    all_passed &= test_cpp_callback();
+
+    if (all_passed) {
+        std::cout << "\n✅ All C API tests passed!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "\n❌ Some C API tests failed!" << std::endl;
+        return 1;
+    }
+}
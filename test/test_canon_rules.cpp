@@ -0,0 +1,147 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include "test_helpers.h"
+#include <canon_rules.h>
+
+using canonicalization::RuleSet;
+
+namespace {
+
+bool throws_on_parse(const std::string& text) {
+    try {
+        (void)RuleSet::parse(text);
+    } catch (const std::runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+} // namespace
+
+bool test_rule_parsing() {
+    std::cout << "\n=== Testing rule file parsing ===" << std::endl;
+
+    const auto empty = RuleSet::parse("# only a comment\n\n   \n");
+    TEST_ASSERT(empty.empty(), "Comments and blank lines yield no rules");
+    TEST_ASSERT(empty.apply("unchanged 123") == "unchanged 123", "Empty rule set leaves text alone");
+
+    const auto two = RuleSet::parse("foo => bar\r\n# comment\nbaz=>\n");
+    TEST_ASSERT(two.size() == 2, "Two rules parsed (CRLF tolerated)");
+    TEST_ASSERT(two.apply("foo baz foo") == "bar  bar", "Empty replacement deletes the match");
+
+    TEST_ASSERT(throws_on_parse("no arrow here"), "Missing '=>' is rejected");
+    TEST_ASSERT(throws_on_parse(" => x"), "Empty pattern is rejected");
+    TEST_ASSERT(throws_on_parse("[abc => x"), "Unterminated class is rejected");
+    TEST_ASSERT(throws_on_parse("*a => x"), "Leading repetition is rejected");
+    TEST_ASSERT(throws_on_parse("a* => x"), "Pattern matching empty string is rejected");
+    TEST_ASSERT(throws_on_parse("[z-a] => x"), "Reversed range is rejected");
+
+    TEST_PASS("Rule file parsing tests completed");
+    return true;
+}
+
+bool test_pattern_language() {
+    std::cout << "\n=== Testing pattern language ===" << std::endl;
+
+    TEST_ASSERT(RuleSet::parse("Thread #\\d+ => Thread #N").apply("Thread #12 and Thread #3")
+                == "Thread #N and Thread #N", "\\d+ collapses thread ids");
+    TEST_ASSERT(RuleSet::parse("{lambda([^)]*)#\\d+} => {lambda}").apply("Foo::{lambda(int)#3}::operator()")
+                == "Foo::{lambda}::operator()", "Lambda names collapse");
+    TEST_ASSERT(RuleSet::parse("(anonymous namespace):: =>").apply("(anonymous namespace)::helper")
+                == "helper", "Anonymous namespace is stripped");
+    TEST_ASSERT(RuleSet::parse("/build/[^/ ]+/ => BUILD/").apply("(/build/x86_64-a1b2/src/f.cpp:10)")
+                == "(BUILD/src/f.cpp:10)", "Build prefix collapses");
+    TEST_ASSERT(RuleSet::parse("a.c => X").apply("abc a.c") == "X X", "'.' matches any character");
+    TEST_ASSERT(RuleSet::parse("a\\.c => X").apply("abc a.c") == "abc X", "Escaped '.' is literal");
+    TEST_ASSERT(RuleSet::parse("colou?r => C").apply("color colour") == "C C", "'?' makes an atom optional");
+    TEST_ASSERT(RuleSet::parse("\\w+@\\w+ => MAIL").apply("x user@host y") == "x MAIL y", "\\w classes");
+
+    TEST_PASS("Pattern language tests completed");
+    return true;
+}
+
+bool test_match_priority() {
+    std::cout << "\n=== Testing match priority ===" << std::endl;
+
+    // Longest match wins regardless of rule order
+    const auto longest = RuleSet::parse("ab => 1\nabc => 2\n");
+    TEST_ASSERT(longest.apply("abcd ab") == "2d 1", "Longest match wins");
+
+    // Equal length: the earlier rule wins
+    const auto tie = RuleSet::parse("a[0-9] => first\n[a-z]1 => second\n");
+    TEST_ASSERT(tie.apply("a1 b1") == "first second", "Earlier rule wins ties");
+
+    // Replacement output is not rescanned
+    const auto once = RuleSet::parse("x => xx");
+    TEST_ASSERT(once.apply("xyx") == "xxyxx", "Replacements are not re-matched");
+
+    TEST_PASS("Match priority tests completed");
+    return true;
+}
+
+bool test_many_rules() {
+    std::cout << "\n=== Testing many rules in one DFA ===" << std::endl;
+
+    std::string text;
+    for (int i = 0; i < 200; ++i) {
+        text += "sym" + std::to_string(i) + "_[0-9]+ => S" + std::to_string(i) + "\n";
+    }
+    const auto rules = RuleSet::parse(text);
+    TEST_ASSERT(rules.size() == 200, "All rules parsed");
+    TEST_ASSERT(rules.apply("sym7_42 sym199_1 sym12") == "S7 S199 sym12", "Combined DFA applies the right rule");
+
+    TEST_PASS("Many-rule tests completed");
+    return true;
+}
+
+bool test_long_lines_are_linear() {
+    std::cout << "\n=== Testing rule matching cost on long lines ===" << std::endl;
+
+    constexpr std::size_t length = 200000;
+
+    // Every position starts a prefix of `a.*Z`, but no Z ever follows: the
+    // backward pass rules all of them out, so no forward step is taken.
+    const auto never = RuleSet::parse("a.*Z => X\n");
+    const std::string as(length, 'a');
+    TEST_ASSERT(never.apply(as) == as, "Long non-matching line is left unchanged");
+    TEST_ASSERT(never.forward_steps() == 0, "Non-matching line takes no forward steps");
+
+    // `x.*Q` could extend every match to the end of the line; the forward scan
+    // must still give up one byte after each match instead of scanning ahead.
+    const auto greedy = RuleSet::parse("x => Y\nx.*Q => W\n");
+    const std::string xs(length, 'x');
+    TEST_ASSERT(greedy.apply(xs) == std::string(length, 'Y'), "Every byte is rewritten by the short rule");
+    TEST_ASSERT(greedy.forward_steps() < 2 * length, "Forward steps stay under twice the line length");
+
+    TEST_PASS("Long-line tests completed");
+    return true;
+}
+
+int main() {
+    std::cout << "Running canonicalization rule tests..." << std::endl;
+
+    bool all_passed = true;
+
+    all_passed &= test_rule_parsing();
+    all_passed &= test_pattern_language();
+    all_passed &= test_match_priority();
+    all_passed &= test_many_rules();
+    all_passed &= test_long_lines_are_linear();
+
+    if (all_passed) {
+        std::cout << "\n✅ All canonicalization rule tests passed!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "\n❌ Some canonicalization rule tests failed!" << std::endl;
+        return 1;
+    }
+}
@@ -85,6 +85,20 @@ bool test_canon_function() {
     std::string expected8 = "at : main by : func"; // 'at :' and 'by :' are not canonicalized by canon()
     TEST_ASSERT(canon(input8) == expected8, "Canon: at and by");
 
+    // Test case 9: Nested template argument lists collapse as a whole
+    const auto canon_sv = [](std::string_view s) { return canonicalization::canon(s); };
+    TEST_ASSERT(canon_sv("std::map<int, std::vector<Foo>>::at(int)") == "std::map<T>::at(int)" &&
+                canon_sv("std::map<int, std::vector<Bar> >::at(int)") == "std::map<T>::at(int)",
+                "Canon: nested templates");
+    TEST_ASSERT(canon_sv("f<a<b>, c>() g<d>()") == "f<T>() g<T>()", "Canon: lists after a nested one");
+
+    // Test case 10: Operators and unbalanced brackets are not template lists
+    TEST_ASSERT(canon_sv("std::ostream::operator<<(int)") == "std::ostream::operator<<(int)", "Canon: operator<<");
+    TEST_ASSERT(canon_sv("operator<< <char, std::char_traits<char>>(x)") == "operator<< <T>(x)",
+                "Canon: operator template");
+    TEST_ASSERT(canon_sv("a<b<c>") == "a<b<T>", "Canon: unbalanced list");
+    TEST_ASSERT(canon_sv("it->second<x>") == "it->second<T>", "Canon: arrow");
+
     TEST_PASS("canon() function tests completed");
     return true;
 }
@@ -0,0 +1,238 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include "test_helpers.h"
+#include <checkpoint.h>
+#include <log_processor.h>
+
+namespace {
+
+const char* const STATE_FILE = "test_checkpoint_state.bin";
+
+const std::string LOG =
+    "==4242== Invalid read of size 4\n"
+    "==4242==    at 0x401234: main (a.cpp:10)\n"
+    "==4242== \n"
+    "==4242== Invalid write of size 8\n"
+    "==4242==    at 0x401300: helper (b.cpp:20)\n"
+    "==4242==    by 0x401400: main (b.cpp:30)\n"
+    "==4242== \n"
+    "==4242== Invalid read of size 4\n"
+    "==4242==    at 0x401999: main (a.cpp:10)\n"
+    "==4242== \n"
+    "==4242== ERROR SUMMARY: 3 errors from 2 contexts\n";
+
+// Two processes writing to one log (--trace-children=yes --log-fd=...)
+const std::string INTERLEAVED =
+    "==1111== Invalid read of size 4\n"
+    "==2222== Invalid write of size 8\n"
+    "==1111==    at 0x401234: main (a.cpp:10)\n"
+    "==2222==    at 0x401300: helper (b.cpp:20)\n"
+    "==2222==    by 0x401400: main (b.cpp:30)\n"
+    "==1111== \n"
+    "==1111== ERROR SUMMARY: 1 errors from 1 contexts\n"
+    "==2222== \n"
+    "==2222== Invalid read of size 4\n"
+    "==2222==    at 0x401234: main (a.cpp:10)\n"
+    "==2222== \n"
+    "==2222== ERROR SUMMARY: 2 errors from 2 contexts\n";
+
+// Runs one stream pass over `log` truncated to `size` bytes, starting from `cp`
+// when given, and returns the output and the new checkpoint.
+std::pair<std::string, Checkpoint> run(const Options& opt, std::size_t size, const Checkpoint* cp,
+                                       const std::string& log = LOG) {
+    std::istringstream in(log.substr(0, size));
+    LogProcessor p(opt);
+    if (cp != nullptr) {
+        p.restore(*cp);
+        in.seekg(static_cast<std::streamoff>(cp->offset));
+    }
+    std::string output = capture_stdout([&] { p.process_stream(in); });
+    return {std::move(output), p.checkpoint()};
+}
+
+} // namespace
+
+bool test_fingerprint() {
+    std::cout << "\n=== Testing fingerprints ===" << std::endl;
+
+    TEST_ASSERT(fingerprint("") == 0xcbf29ce484222325ull, "Empty input gives the FNV offset basis");
+    TEST_ASSERT(fingerprint("a") == 0xaf63dc4c8601ec8cull, "Matches the FNV-1a reference value");
+    TEST_ASSERT(fingerprint("bc", fingerprint("a")) == fingerprint("abc"), "Fingerprints chain");
+
+    TEST_PASS("Fingerprint tests completed");
+    return true;
+}
+
+bool test_settings_follow_file_contents() {
+    std::cout << "\n=== Testing settings of rule and suppression files ===" << std::endl;
+
+    const auto write = [](const char* name, std::string_view text) { std::ofstream(name) << text; };
+    Options opt;
+    opt.canon_rules_file = "test_checkpoint_rules.txt";
+    opt.suppress_files.push_back("test_checkpoint_supp.txt");
+    write("test_checkpoint_rules.txt", "s/Foo/Bar/\n");
+    write("test_checkpoint_supp.txt", "{\n   a\n   Memcheck:Addr4\n   fun:main\n}\n");
+    const auto signature = signature_settings(opt);
+    const auto settings  = checkpoint_settings(opt);
+
+    write("test_checkpoint_supp.txt", "{\n   a\n   Memcheck:Addr8\n   fun:main\n}\n");
+    const bool supp_edit = checkpoint_settings(opt) != settings && signature_settings(opt) == signature;
+    write("test_checkpoint_rules.txt", "s/Foo/Baz/\n");
+    const bool rules_edit = signature_settings(opt) != signature;
+
+    // The same contents under other names are the same settings.
+    write("test_checkpoint_rules2.txt", "s/Foo/Bar/\n");
+    write("test_checkpoint_supp2.txt", "{\n   a\n   Memcheck:Addr4\n   fun:main\n}\n");
+    Options renamed = opt;
+    renamed.canon_rules_file  = "test_checkpoint_rules2.txt";
+    renamed.suppress_files[0] = "test_checkpoint_supp2.txt";
+    const bool rename = signature_settings(renamed) == signature && checkpoint_settings(renamed) == settings;
+
+    for (const char* f : {"test_checkpoint_rules.txt", "test_checkpoint_supp.txt", "test_checkpoint_rules2.txt",
+                          "test_checkpoint_supp2.txt"}) {
+        std::remove(f);
+    }
+    TEST_ASSERT(supp_edit, "Editing a suppression file changes only the checkpoint settings");
+    TEST_ASSERT(rules_edit, "Editing the rules file changes the signature settings");
+    TEST_ASSERT(rename, "File names are not part of the settings");
+
+    TEST_PASS("Settings tests completed");
+    return true;
+}
+
+bool test_state_file_round_trip() {
+    std::cout << "\n=== Testing state file round trip ===" << std::endl;
+
+    std::remove(STATE_FILE);
+    TEST_ASSERT(!load_checkpoint(STATE_FILE).has_value(), "Missing state file means a fresh start");
+
+    Checkpoint cp;
+    cp.settings     = 1;
+    cp.device       = 2;
+    cp.inode        = 3;
+    cp.offset       = 12345;
+    cp.marker_found = true;
+    cp.tool         = 1;
+    cp.seen         = {7, 8, 9};
+    Checkpoint::OpenBlock open;
+    open.pid          = 4242;
+    open.kind         = 1;
+    open.begin        = 100;
+    open.end          = 150;
+    open.sig_lines    = 2;
+    open.head         = "16 bytes in 1 blocks are definitely lost in loss record 1 of 1";
+    open.sig          = "Invalid read\nmain\n";
+    open.text         = "Invalid read of size 4main (a.cpp:10)";
+    open.line_lengths = {22, 15};
+    cp.open_blocks.push_back(open);
+    cp.open_blocks.emplace_back().pid = 7;
+    save_checkpoint(STATE_FILE, cp);
+
+    const auto loaded = load_checkpoint(STATE_FILE);
+    TEST_ASSERT(loaded.has_value(), "State file loads");
+    TEST_ASSERT(loaded->settings == 1 && loaded->device == 2 && loaded->inode == 3 && loaded->offset == 12345,
+                "Identity and offset survive");
+    TEST_ASSERT(loaded->marker_found && loaded->seen == cp.seen && loaded->tool == 1, "Epoch state survives");
+    TEST_ASSERT(loaded->open_blocks.size() == 2 && loaded->open_blocks[1].pid == 7, "Every open block survives");
+    const auto& b = loaded->open_blocks[0];
+    TEST_ASSERT(b.pid == 4242 && b.kind == 1 && b.sig == open.sig && b.text == open.text &&
+                b.line_lengths == open.line_lengths && b.begin == 100 && b.end == 150 && b.sig_lines == 2 &&
+                b.head == open.head,
+                "Open block contents survive");
+
+    { std::ofstream(STATE_FILE, std::ios::binary | std::ios::trunc) << "VGLFSTAT\x01"; }
+    bool threw = false;
+    try {
+        (void)load_checkpoint(STATE_FILE);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    TEST_ASSERT(threw, "Truncated state file is rejected");
+
+    std::remove(STATE_FILE);
+    TEST_PASS("State file round trip tests completed");
+    return true;
+}
+
+bool test_resume_matches_single_run() {
+    std::cout << "\n=== Testing resumed processing ===" << std::endl;
+
+    Options opt;
+    opt.trim        = false;
+    opt.stream_mode = true;
+    opt.state_file  = STATE_FILE; // only enables resumable stops; nothing is written here
+
+    const auto whole = run(opt, LOG.size(), nullptr).first;
+
+    // Cut mid-line inside the second block, then again after its last frame
+    const std::size_t cut1 = LOG.find("helper") + 3;
+    const std::size_t cut2 = LOG.find("==4242== \n", cut1) + 1;
+    auto [out1, cp1] = run(opt, cut1, nullptr);
+    TEST_ASSERT(cp1.offset == LOG.rfind('\n', cut1) + 1, "Offset stops at the last complete line");
+    auto [out2, cp2] = run(opt, cut2, &cp1);
+    auto [out3, cp3] = run(opt, LOG.size(), &cp2);
+
+    TEST_ASSERT(out1 + out2 + out3 == whole, "Resumed runs print what a single run prints");
+    TEST_ASSERT(cp3.offset == LOG.size() && cp3.open_blocks.empty(), "ERROR SUMMARY closes the last block");
+    TEST_ASSERT(cp3.seen.size() == 2, "Both unique signatures are remembered");
+
+    TEST_PASS("Resumed processing tests completed");
+    return true;
+}
+
+bool test_interleaved_pids() {
+    std::cout << "\n=== Testing interleaved processes ===" << std::endl;
+
+    Options opt;
+    opt.trim        = false;
+    opt.stream_mode = true;
+
+    const auto whole = run(opt, INTERLEAVED.size(), nullptr, INTERLEAVED).first;
+    // 1111's block completes at its ERROR SUMMARY, 2222's first one when its second starts
+    TEST_ASSERT(whole == "Invalid read of size 4\nmain (a.cpp:10)\nERROR SUMMARY: 1 errors from 1 contexts\n\n"
+                         "Invalid write of size 8\nhelper (b.cpp:20)\nmain (b.cpp:30)\n\n",
+                "Each process's block is kept whole and the repeat from the other PID is dropped");
+
+    // Stop while both processes have a block open
+    opt.state_file = STATE_FILE;
+    const std::size_t cut = INTERLEAVED.find("==2222==    by");
+    auto [out1, cp1] = run(opt, cut, nullptr, INTERLEAVED);
+    TEST_ASSERT(cp1.open_blocks.size() == 2 && cp1.open_blocks[0].pid == 1111 && cp1.open_blocks[1].pid == 2222,
+                "Both open blocks are saved, oldest first");
+    auto [out2, cp2] = run(opt, INTERLEAVED.size(), &cp1, INTERLEAVED);
+    TEST_ASSERT(out1 + out2 == whole, "Resumed runs keep the processes apart");
+
+    TEST_PASS("Interleaved process tests completed");
+    return true;
+}
+
+int main() {
+    std::cout << "Running checkpoint tests..." << std::endl;
+
+    bool all_passed = true;
+
+    all_passed &= test_fingerprint();
+    all_passed &= test_settings_follow_file_contents();
+    all_passed &= test_state_file_round_trip();
+    all_passed &= test_resume_matches_single_run();
+    all_passed &= test_interleaved_pids();
+
+    if (all_passed) {
+        std::cout << "\n✅ All checkpoint tests passed!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "\n❌ Some checkpoint tests failed!" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,89 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "test_helpers.h"
+#include <demangle.h>
+#include <log_processor.h>
+
+bool test_symbols() {
+    std::cout << "\n=== Testing symbol demangling ===" << std::endl;
+
+    DemangleCache cache;
+    TEST_ASSERT(cache.demangle("_ZN3foo3barEv") == "foo::bar()", "Nested name");
+    TEST_ASSERT(cache.demangle("_ZNSt6vectorIiSaIiEE9push_backERKi") ==
+                "std::vector<int, std::allocator<int> >::push_back(int const&)", "Template arguments");
+    TEST_ASSERT(cache.demangle("_Zfoo") == "_Zfoo", "Invalid names are kept");
+    TEST_ASSERT(cache.size() == 3 && cache.hits() == 0, "One entry per symbol");
+    TEST_ASSERT(cache.demangle("_ZN3foo3barEv") == "foo::bar()" && cache.demangle("_Zfoo") == "_Zfoo" &&
+                cache.hits() == 2 && cache.size() == 3, "Repeats are cache hits");
+
+    TEST_PASS("Symbol demangling tests completed");
+    return true;
+}
+
+bool test_lines() {
+    std::cout << "\n=== Testing line demangling ===" << std::endl;
+
+    DemangleCache cache;
+    std::string   out = "unchanged";
+    TEST_ASSERT(!cache.demangle_line("at 0x401234: main (a.cpp:10)", out) && out == "unchanged", "No symbol");
+    TEST_ASSERT(!cache.demangle_line("at 0x401234: x_ZN3foo3barEv (_Zfile.cpp:10)", out), "Inside a word, invalid");
+    TEST_ASSERT(cache.demangle_line("at 0x401234: _ZN3foo3barEv (a.cpp:10)", out) &&
+                out == "at 0x401234: foo::bar() (a.cpp:10)", "Symbol in a frame");
+    TEST_ASSERT(cache.demangle_line("by 0x1: _ZN3foo3bazEi (in /lib/libfoo.so) _ZN3foo3barEv", out) &&
+                out == "by 0x1: foo::baz(int) (in /lib/libfoo.so) foo::bar()", "Several symbols");
+
+    TEST_PASS("Line demangling tests completed");
+    return true;
+}
+
+bool test_signatures() {
+    std::cout << "\n=== Testing mangled signatures ===" << std::endl;
+
+    // The same error logged with and without valgrind --demangle=no
+    const std::vector<std::string> log{
+        "==4242== Invalid read of size 4",
+        "==4242==    at 0x401234: Map<int, std::vector<Foo>>::at(int) (map.h:10)",
+        "==4242==    by 0x401300: main (a.cpp:20)",
+        "==4242== Invalid read of size 4",
+        "==4242==    at 0x401234: _ZN3MapIiSt6vectorI3FooSaIS1_EEE2atEi (map.h:10)",
+        "==4242==    by 0x401300: main (a.cpp:20)",
+    };
+    Options opt;
+    opt.trim  = false;
+    opt.depth = 0;
+    LogProcessor p(opt);
+    const std::string output = capture_stdout([&] { p.process_lines(log); });
+
+    TEST_ASSERT(p.blocks().size() == 1 && p.blocks().occurrences(0) == 2, "Mangled frame dedupes with demangled");
+    TEST_ASSERT(output.find("_ZN") == std::string::npos, "Output keeps the first block's text");
+
+    TEST_PASS("Mangled signature tests completed");
+    return true;
+}
+
+int main() {
+    std::cout << "Running demangle tests..." << std::endl;
+
+    bool all_passed = true;
+
+    all_passed &= test_symbols();
+    all_passed &= test_lines();
+    all_passed &= test_signatures();
+
+    if (all_passed) {
+        std::cout << "\n✅ All demangle tests passed!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "\n❌ Some demangle tests failed!" << std::endl;
+        return 1;
+    }
+}
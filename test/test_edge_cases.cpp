@@ -371,6 +371,47 @@ bool test_stream_processing_edge_cases() {
     return true;
 }
 
+// One whole Valgrind run of process `pid` reporting `error`, as logs of
+// several runs are concatenated (`cat run-*.log`).
+std::string run_log(std::string_view pid, std::string_view error) {
+    const std::string_view lines[]{"Memcheck, a memory error detector", "Command: ./t", "", error,
+                                   "   at 0x401234: main (a.cpp:10)", "", "HEAP SUMMARY:", "",
+                                   "ERROR SUMMARY: 1 errors from 1 contexts (suppressed: 0 from 0)"};
+    std::string log;
+    for (const auto line : lines) log.append("==").append(pid).append("== ").append(line).push_back('\n');
+    return log;
+}
+
+bool test_concatenated_runs() {
+    std::cout << "\n=== Testing concatenated runs ===" << std::endl;
+
+    Options opt;
+    opt.trim        = false;
+    opt.stream_mode = true;
+    opt.depth       = 0;
+
+    // ERROR SUMMARY is a process's last line, so it ends the block for any
+    // input: the next run's banner never joins the previous run's last block.
+    const std::string first = run_log("4242", "Invalid read of size 4");
+    const auto once = run_stream(opt, first);
+    TEST_ASSERT(once.ends_with("ERROR SUMMARY: 1 errors from 1 contexts (suppressed: 0 from 0)\n\n"),
+                "Summary closes the last block");
+    const std::string same_pid = first + first;
+    TEST_ASSERT(run_stream(opt, same_pid) == once,
+                "A repeated run (same PID) only has duplicates, its summary block included");
+    const std::string next_pid = first + run_log("4243", "Invalid read of size 4");
+    TEST_ASSERT(run_stream(opt, next_pid) == once, "... and from the next PID");
+
+    // A run with errors of its own: they follow the first run's blocks in log order.
+    const std::string other = first + run_log("4243", "Invalid write of size 8");
+    const auto both = run_stream(opt, other);
+    TEST_ASSERT(both.starts_with(once) && both.find("Invalid write of size 8\nmain (a.cpp:10)") == once.size(),
+                "The first run is complete before the second starts");
+
+    TEST_PASS("Concatenated run tests completed");
+    return true;
+}
+
 bool test_concurrent_access_simulation() {
     // Test with multiple files that might be accessed concurrently
     std::vector<std::string> files;
@@ -548,6 +589,7 @@ int main() {
     all_passed &= test_file_system_error_scenarios();
     all_passed &= test_marker_trimming_edge_cases();
     all_passed &= test_stream_processing_edge_cases();
+    all_passed &= test_concatenated_runs();
     all_passed &= test_concurrent_access_simulation();
     all_passed &= test_memory_efficiency();
     all_passed &= test_large_file_processing();
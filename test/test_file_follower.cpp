@@ -0,0 +1,170 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "test_helpers.h"
+#include <file_follower.h>
+#include <log_processor.h>
+
+namespace {
+
+const std::string LOG =
+    "==4242== Invalid read of size 4\n"
+    "==4242==    at 0x401234: main (a.cpp:10)\n"
+    "==4242== \n"
+    "==4242== Invalid read of size 4\n"
+    "==4242==    at 0x401999: main (a.cpp:10)\n"
+    "==4242== \n"
+    "==4242== Invalid write of size 8\n"
+    "==4242==    at 0x401300: helper (b.cpp:20)\n";
+
+// Captures std::cout for the lifetime of the object.
+class CoutCapture {
+public:
+    CoutCapture() : old_(std::cout.rdbuf(buf_.rdbuf())) {}
+    ~CoutCapture() { stop(); }
+    void stop() {
+        if (old_ != nullptr) std::cout.rdbuf(old_);
+        old_ = nullptr;
+    }
+    std::string take() {
+        std::string s = buf_.str();
+        buf_.str({});
+        return s;
+    }
+
+private:
+    std::ostringstream buf_;
+    std::streambuf*    old_;
+};
+
+Options live_options() {
+    Options opt;
+    opt.trim        = false;
+    opt.stream_mode = true;
+    opt.filename    = "follow.log";
+    return opt;
+}
+
+void append_to(const std::string& path, const std::string& text) {
+    std::ofstream out(path, std::ios::app);
+    out << text;
+}
+
+} // namespace
+
+bool test_feed_matches_whole_input() {
+    std::cout << "\n=== Testing feed() chunking ===" << std::endl;
+
+    std::string whole;
+    std::string chunked;
+    {
+        CoutCapture cap;
+        const Options opt = live_options();
+        LogProcessor p(opt);
+        p.feed(LOG);
+        p.finish();
+        whole = cap.take();
+    }
+    {
+        CoutCapture cap;
+        const Options opt = live_options();
+        LogProcessor p(opt);
+        for (std::size_t i = 0; i < LOG.size(); i += 7) p.feed(std::string_view{LOG}.substr(i, 7));
+        p.finish();
+        chunked = cap.take();
+    }
+
+    TEST_ASSERT(whole == "Invalid read of size 4\nmain (a.cpp:10)\n\nInvalid write of size 8\nhelper (b.cpp:20)\n\n",
+                "Duplicate block is dropped and the open block is flushed by finish()");
+    TEST_ASSERT(chunked == whole, "Lines split across chunks give the same output");
+
+    TEST_PASS("feed() chunking tests completed");
+    return true;
+}
+
+bool test_blocks_print_when_complete() {
+    std::cout << "\n=== Testing live output ===" << std::endl;
+
+    CoutCapture cap;
+    const Options opt = live_options();
+    LogProcessor p(opt);
+    p.feed("==4242== Invalid read of size 4\n==4242==    at 0x1: f (a.cpp:1)\n");
+    TEST_ASSERT(cap.take().empty(), "Open block is not printed yet");
+    p.feed("==4242== Invalid write of size 1\n");
+    TEST_ASSERT(cap.take() == "Invalid read of size 4\nf (a.cpp:1)\n\n", "Block printed when the next one starts");
+
+    cap.stop();
+    TEST_PASS("Live output tests completed");
+    return true;
+}
+
+bool test_follow_append_truncate_rotate() {
+    std::cout << "\n=== Testing file following ===" << std::endl;
+
+    const std::string path    = "/tmp/vglog_follow_test.log";
+    const std::string rotated = path + ".1";
+    std::remove(path.c_str());
+    std::remove(rotated.c_str());
+    append_to(path, "==4242== Invalid read of size 4\n==4242==    at 0x1: f (a.cpp:1)\n");
+
+    CoutCapture cap;
+    const Options opt = live_options();
+    LogProcessor p(opt);
+    FileFollower follower(path, p);
+    TEST_ASSERT(cap.take().empty(), "Existing content read, block still open");
+
+    append_to(path, "==4242== Invalid write of size 1\n==4242==    at 0x2: g (b.cpp:2)\n");
+    TEST_ASSERT(follower.wait(1000), "Wait returns after a change");
+    TEST_ASSERT(cap.take() == "Invalid read of size 4\nf (a.cpp:1)\n\n", "Appended data completes the first block");
+
+    // copytruncate-style rotation: the same file starts over
+    { std::ofstream trunc(path, std::ios::trunc); }
+    TEST_ASSERT(follower.wait(1000), "Wait returns after truncation");
+    TEST_ASSERT(cap.take() == "Invalid write of size 1\ng (b.cpp:2)\n\n", "Truncation flushes the open block");
+    append_to(path, "==4242== Invalid read of size 4\n==4242==    at 0x9: f (a.cpp:1)\n");
+    TEST_ASSERT(follower.wait(1000), "Wait returns after new data");
+
+    // rename-style rotation: a new file appears under the same name
+    TEST_ASSERT(std::rename(path.c_str(), rotated.c_str()) == 0, "Log rotated");
+    append_to(path, "==4242== Syscall param write(buf) points to uninitialised byte(s)\n==4242==    at 0x3: h (c.cpp:3)\n");
+    for (int i = 0; i < 3; ++i) (void)follower.wait(200);
+    TEST_ASSERT(cap.take().empty(), "Duplicate block from the truncated file is suppressed");
+
+    append_to(path, "==4242== Invalid read of size 4\n");
+    for (int i = 0; i < 3; ++i) (void)follower.wait(200);
+    TEST_ASSERT(cap.take() == "Syscall param write(buf) points to uninitialised byte(s)\nh (c.cpp:3)\n\n",
+                "Data in the replacement file is followed");
+
+    cap.stop();
+    std::remove(path.c_str());
+    std::remove(rotated.c_str());
+    TEST_PASS("File following tests completed");
+    return true;
+}
+
+int main() {
+    std::cout << "Running file follower tests..." << std::endl;
+
+    bool all_passed = true;
+
+    all_passed &= test_feed_matches_whole_input();
+    all_passed &= test_blocks_print_when_complete();
+    all_passed &= test_follow_append_truncate_rotate();
+
+    if (all_passed) {
+        std::cout << "\n✅ All file follower tests passed!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "\n❌ Some file follower tests failed!" << std::endl;
+        return 1;
+    }
+}
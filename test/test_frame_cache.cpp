@@ -0,0 +1,127 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include "test_helpers.h"
+#include <frame_cache.h>
+
+namespace {
+
+struct CountingTransform {
+    int* calls;
+    void operator()(std::string_view s, std::string& out) const {
+        ++*calls;
+        out = "T(" + std::string{s} + ")";
+    }
+};
+
+} // namespace
+
+bool test_hits_skip_transform() {
+    std::cout << "\n=== Testing cache hits ===" << std::endl;
+
+    FrameCache cache(8);
+    int calls = 0;
+    const std::string frame = "at 0x4C2AB80: malloc (vg_replace_malloc.c:299)";
+
+    for (int i = 0; i < 100; ++i) {
+        TEST_ASSERT(cache.canonical(frame, CountingTransform{&calls}) == "T(" + frame + ")",
+                    "Cached value matches the transform output");
+    }
+    TEST_ASSERT(calls == 1, "Transform runs once for a repeated frame");
+
+    const auto st = cache.stats();
+    TEST_ASSERT(st.canon_hits == 99 && st.canon_misses == 1, "Hit/miss counters are exact");
+    TEST_ASSERT(st.entries == 1 && st.capacity == 8, "One entry in use");
+    TEST_ASSERT(st.bytes > 0, "Memory use is reported");
+
+    TEST_PASS("Cache hit tests completed");
+    return true;
+}
+
+bool test_canon_and_scrub_are_independent() {
+    std::cout << "\n=== Testing canonical/scrubbed slots ===" << std::endl;
+
+    FrameCache cache(4);
+    int canon_calls = 0;
+    int scrub_calls = 0;
+
+    (void)cache.canonical("line", CountingTransform{&canon_calls});
+    TEST_ASSERT(cache.scrubbed("line", [&](std::string_view, std::string& out) { ++scrub_calls; out.assign(1, 'S'); }) == "S",
+                "Scrubbed form computed separately");
+    TEST_ASSERT(cache.scrubbed("line", [&](std::string_view, std::string& out) { ++scrub_calls; out.assign(1, 'X'); }) == "S",
+                "Scrubbed form is served from the cache");
+    TEST_ASSERT(cache.canonical("line", CountingTransform{&canon_calls}) == "T(line)", "Canonical form kept");
+    TEST_ASSERT(canon_calls == 1 && scrub_calls == 1, "Each transform ran once");
+
+    TEST_PASS("Canonical/scrubbed slot tests completed");
+    return true;
+}
+
+bool test_clock_eviction() {
+    std::cout << "\n=== Testing CLOCK eviction ===" << std::endl;
+
+    FrameCache cache(2);
+    int calls = 0;
+
+    (void)cache.canonical("a", CountingTransform{&calls});
+    (void)cache.canonical("b", CountingTransform{&calls});
+    (void)cache.canonical("a", CountingTransform{&calls}); // marks "a" referenced
+    (void)cache.canonical("c", CountingTransform{&calls}); // evicts "b", the unreferenced slot
+    TEST_ASSERT(calls == 3, "Three distinct frames computed");
+
+    (void)cache.canonical("a", CountingTransform{&calls});
+    TEST_ASSERT(calls == 3, "Recently used frame survived eviction");
+    (void)cache.canonical("b", CountingTransform{&calls});
+    TEST_ASSERT(calls == 4, "Unreferenced frame was evicted");
+
+    const auto st = cache.stats();
+    TEST_ASSERT(st.entries == 2, "Cache stays bounded");
+    TEST_ASSERT(st.evictions == 2, "Evictions are counted");
+
+    TEST_PASS("CLOCK eviction tests completed");
+    return true;
+}
+
+bool test_disabled_cache() {
+    std::cout << "\n=== Testing disabled cache ===" << std::endl;
+
+    FrameCache cache(0);
+    int calls = 0;
+    TEST_ASSERT(cache.canonical("x", CountingTransform{&calls}) == "T(x)", "Disabled cache still transforms");
+    TEST_ASSERT(cache.canonical("x", CountingTransform{&calls}) == "T(x)", "Disabled cache recomputes");
+    TEST_ASSERT(calls == 2, "Every lookup runs the transform");
+
+    std::ostringstream os;
+    report_frame_cache_stats(os, cache.stats());
+    TEST_ASSERT(os.str() == "Frame cache: disabled\n", "Report says disabled");
+
+    TEST_PASS("Disabled cache tests completed");
+    return true;
+}
+
+int main() {
+    std::cout << "Running frame cache tests..." << std::endl;
+
+    bool all_passed = true;
+
+    all_passed &= test_hits_skip_transform();
+    all_passed &= test_canon_and_scrub_are_independent();
+    all_passed &= test_clock_eviction();
+    all_passed &= test_disabled_cache();
+
+    if (all_passed) {
+        std::cout << "\n✅ All frame cache tests passed!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "\n❌ Some frame cache tests failed!" << std::endl;
+        return 1;
+    }
+}
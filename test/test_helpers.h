@@ -8,8 +8,11 @@
 #include <string_view>
 #include <regex>
 #include <canonicalization.h>
+#include <log_processor.h>
 #include <fstream>
 #include <filesystem>
+#include <sstream>
+#include <vector>
 
 #define TEST_ASSERT(condition, message) \
     do { \
@@ -54,4 +57,45 @@ public:
 private:
     std::string path_;
     std::ofstream stream_;
-};
\ No newline at end of file
+};
+
+// What `run` writes to std::cout, which is restored even if it throws.
+template <class Run>
+std::string capture_stdout(Run&& run) {
+    std::ostringstream captured;
+    struct Restore {
+        std::streambuf* old;
+        ~Restore() { std::cout.rdbuf(old); }
+    } restore{std::cout.rdbuf(captured.rdbuf())};
+    run();
+    return captured.str();
+}
+
+// Output of a LogProcessor for `opt` over `lines`, as process_lines() writes it.
+inline std::string run_lines(const Options& opt, const std::vector<std::string>& lines) {
+    return capture_stdout([&] {
+        LogProcessor p(opt);
+        p.process_lines(lines);
+    });
+}
+
+// Output of a LogProcessor for `opt` over `log`, as process_stream() writes it.
+inline std::string run_stream(const Options& opt, const std::string& log) {
+    return capture_stdout([&] {
+        std::istringstream in(log);
+        LogProcessor p(opt);
+        p.process_stream(in);
+    });
+}
+// ... and as process_buffer() writes it for the same input held in memory.
+inline std::string run_buffer(const Options& opt, std::string_view data) {
+    return capture_stdout([&] {
+        LogProcessor p(opt);
+        p.process_buffer(data);
+    });
+}
+inline std::string run_stream(const Options& opt, const std::vector<std::string>& lines) {
+    std::string log;
+    for (const auto& l : lines) log.append(l).push_back('\n');
+    return run_stream(opt, log);
+}
@@ -162,6 +162,60 @@ bool test_error_conditions() {
     return true;
 }
 
+namespace {
+
+// Output of a stream-mode run over the file at `path`, opened the way main()
+// opens a named input (seekable) or read as a pipe (opt.use_stdin).
+std::string run_file(const Options& opt, const char* path) {
+    return capture_stdout([&] {
+        std::ifstream in(path, std::ios::binary);
+        LogProcessor p(opt);
+        p.process_stream(in);
+    });
+}
+
+} // namespace
+
+bool test_byte_ranges_match_pipe() {
+    // Stream mode keeps a seekable file's pending blocks as byte ranges and
+    // re-reads them at EOF; a pipe keeps their text. Both must print the same.
+    TempFile test_log("test_ranges.tmp");
+    std::ofstream& log = test_log.get_stream();
+    log << "==100== Invalid read of size 4\n";
+    log << "==100==    at 0x401234: stale (old.cpp:1)\n";
+    log << "==100== \n";
+    log << "==100== " << DEFAULT_MARKER << " symbols\n";
+    for (int i = 0; i < 50; ++i) {
+        const std::string pid = i % 2 == 0 ? "==100== " : "==200== ";
+        log << pid << (i % 3 == 0 ? "Invalid write of size 8\n" : "Invalid read of size 4\n");
+        log << pid << "   at 0x" << std::hex << 0x401000 + i << std::dec << ": f" << i % 7
+            << " (a.cpp:" << i % 7 << ")\r\n";
+        log << pid << "   by 0x402000: main (main.cpp:9)\n";
+        log << pid << " Address 0x5204" << i << " is 0 bytes after a block of size 4 alloc'd\n";
+        log << pid << "   at 0x4C2AB80: malloc (in /usr/lib/valgrind/vgpreload_memcheck-amd64-linux.so)\n";
+        log << pid << " \n";
+    }
+    log << "==100== ERROR SUMMARY: 50 errors from 14 contexts (suppressed: 0 from 0)\n";
+    test_log.close();
+
+    for (const bool trim : {true, false}) {
+        for (const auto format : {OutputFormat::Text, OutputFormat::Ndjson}) {
+            Options opt;
+            opt.stream_mode = true;
+            opt.trim        = trim;
+            opt.format      = format;
+            const std::string ranges = run_file(opt, test_log.path());
+            opt.use_stdin = true;
+            const std::string piped = run_file(opt, test_log.path());
+            TEST_ASSERT(!ranges.empty() && ranges == piped, "Byte-range output matches the piped run byte for byte");
+            TEST_ASSERT((ranges.find("stale") == std::string::npos) == trim, "Blocks before the marker follow --trim");
+        }
+    }
+
+    TEST_PASS("Byte-range stream output tests work");
+    return true;
+}
+
 int main() {
     std::cout << "Running integration tests for vglog-filter..." << std::endl;
     
@@ -171,6 +225,7 @@ int main() {
     all_passed &= test_deduplication_logic();
     all_passed &= test_marker_trimming();
     all_passed &= test_stream_processing_simulation();
+    all_passed &= test_byte_ranges_match_pipe();
     all_passed &= test_error_conditions();
     
     if (all_passed) {
@@ -0,0 +1,416 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "test_helpers.h"
+#include <json_writer.h>
+#include <log_processor.h>
+
+namespace {
+
+const std::vector<std::string> LOG{
+    "==4242== Invalid read of size 4",
+    "==4242==    at 0x401234: main (a.cpp:10)",
+    "==4242== 1024 bytes in 3 blocks are definitely lost in loss record 2 of 2",
+    "==4242==    at 0x4C2AB80: malloc (in /usr/lib/valgrind/vgpreload_memcheck-amd64-linux.so)",
+    "==4242==    by 0x401300: print(\"x\\ty\") (b.cpp:20)",
+    "==4242== Invalid read of size 4",
+    "==4242==    at 0x401999: main (a.cpp:10)",
+    "==4242== 512 bytes in 1 blocks are definitely lost in loss record 1 of 2",
+    "==4242==    at 0x4C2AB80: malloc (in /usr/lib/valgrind/vgpreload_memcheck-amd64-linux.so)",
+    "==4242==    by 0x401300: print(\"x\\ty\") (b.cpp:20)",
+};
+
+std::string joined(const std::vector<std::string>& lines) {
+    std::string s;
+    for (const auto& l : lines) s.append(l).push_back('\n');
+    return s;
+}
+
+std::size_t count(const std::string& haystack, std::string_view needle) {
+    std::size_t n = 0;
+    for (auto pos = haystack.find(needle); pos != std::string::npos; pos = haystack.find(needle, pos + 1)) ++n;
+    return n;
+}
+
+std::vector<std::string> split_lines(const std::string& s) {
+    std::vector<std::string> out;
+    std::istringstream in(s);
+    for (std::string l; std::getline(in, l);) out.push_back(l);
+    return out;
+}
+
+// Strict RFC 8259 check of one JSON text, including that it is UTF-8.
+class JsonChecker {
+public:
+    explicit JsonChecker(std::string_view text) : s_(text) {}
+
+    bool valid() {
+        skip_space();
+        if (!value()) return false;
+        skip_space();
+        return i_ == s_.size();
+    }
+
+private:
+    [[nodiscard]] bool at(char c) const { return i_ < s_.size() && s_[i_] == c; }
+    void skip_space() {
+        while (i_ < s_.size() && (s_[i_] == ' ' || s_[i_] == '\t' || s_[i_] == '\n' || s_[i_] == '\r')) ++i_;
+    }
+    bool literal(std::string_view word) {
+        if (s_.substr(i_, word.size()) != word) return false;
+        i_ += word.size();
+        return true;
+    }
+
+    bool value() {
+        if (at('{')) return members('}', true);
+        if (at('[')) return members(']', false);
+        if (at('"')) return string();
+        if (at('t')) return literal("true");
+        if (at('f')) return literal("false");
+        if (at('n')) return literal("null");
+        return number();
+    }
+
+    bool members(char close, bool object) {
+        ++i_;
+        skip_space();
+        if (at(close)) return ++i_, true;
+        for (;;) {
+            skip_space();
+            if (object) {
+                if (!at('"') || !string()) return false;
+                skip_space();
+                if (!at(':')) return false;
+                ++i_;
+                skip_space();
+            }
+            if (!value()) return false;
+            skip_space();
+            if (at(close)) return ++i_, true;
+            if (!at(',')) return false;
+            ++i_;
+        }
+    }
+
+    bool number() {
+        const std::size_t start = i_;
+        if (at('-')) ++i_;
+        while (i_ < s_.size() && ((s_[i_] >= '0' && s_[i_] <= '9') || s_[i_] == '.' || s_[i_] == 'e' ||
+                                  s_[i_] == 'E' || s_[i_] == '+' || s_[i_] == '-')) {
+            ++i_;
+        }
+        return i_ > start;
+    }
+
+    bool string() {
+        for (++i_; i_ < s_.size();) {
+            const auto c = static_cast<unsigned char>(s_[i_]);
+            if (c == '"') return ++i_, true;
+            if (c < 0x20) return false;
+            if (c == '\\') {
+                if (++i_ >= s_.size()) return false;
+                if (s_[i_] == 'u') {
+                    if (s_.substr(i_ + 1, 4).find_first_not_of("0123456789abcdefABCDEF") != std::string_view::npos ||
+                        i_ + 5 > s_.size()) {
+                        return false;
+                    }
+                    i_ += 5;
+                } else if (std::string_view{"\"\\/bfnrt"}.find(s_[i_]) != std::string_view::npos) {
+                    ++i_;
+                } else {
+                    return false;
+                }
+            } else if (c < 0x80) {
+                ++i_;
+            } else if (!utf8()) {
+                return false;
+            }
+        }
+        return false;
+    }
+
+    bool utf8() {
+        const auto lead = static_cast<unsigned char>(s_[i_]);
+        std::uint32_t cp = 0;
+        std::size_t   n  = 0;
+        if (lead >= 0xC0 && lead < 0xE0)      cp = lead & 0x1F, n = 1;
+        else if (lead >= 0xE0 && lead < 0xF0) cp = lead & 0x0F, n = 2;
+        else if (lead >= 0xF0 && lead < 0xF8) cp = lead & 0x07, n = 3;
+        else return false;
+        if (i_ + n >= s_.size()) return false;
+        for (std::size_t k = 1; k <= n; ++k) {
+            const auto c = static_cast<unsigned char>(s_[i_ + k]);
+            if ((c & 0xC0) != 0x80) return false;
+            cp = (cp << 6) | (c & 0x3F);
+        }
+        constexpr std::uint32_t MIN[] = {0, 0x80, 0x800, 0x10000};
+        if (cp < MIN[n] || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) return false;
+        i_ += n + 1;
+        return true;
+    }
+
+    std::string_view s_;
+    std::size_t      i_{0};
+};
+
+bool is_json(std::string_view text) { return JsonChecker(text).valid(); }
+
+} // namespace
+
+bool test_string_escaping() {
+    std::cout << "\n=== Testing JSON string escaping ===" << std::endl;
+
+    std::string out;
+    append_json_string(out, "plain text");
+    TEST_ASSERT(out == "plain text", "Nothing to escape");
+
+    out.clear();
+    append_json_string(out, "a\"b\\c\nd\te\x01\x1f");
+    TEST_ASSERT(out == "a\\\"b\\\\c\\nd\\te\\u0001\\u001f", "Quotes, backslashes and control characters");
+
+    out.clear();
+    append_json_string(out, "operator\xc3\xa9()/");
+    TEST_ASSERT(out == "operator\xc3\xa9()/", "UTF-8 and slashes pass through");
+
+    TEST_PASS("String escaping tests completed");
+    return true;
+}
+
+bool test_invalid_utf8() {
+    std::cout << "\n=== Testing ill-formed UTF-8 ===" << std::endl;
+
+    const auto escaped = [](std::string_view s) {
+        std::string out;
+        append_json_string(out, s);
+        return out;
+    };
+    TEST_ASSERT(escaped("\xf0\x9f\x90\x9b bug") == "\xf0\x9f\x90\x9b bug", "Four-byte sequence passes through");
+    TEST_ASSERT(escaped("a\xff" "b") == "a\\ufffdb", "Byte that never occurs in UTF-8");
+    TEST_ASSERT(escaped("\xe2\x82x") == "\\ufffdx", "Truncated sequence is one replacement");
+    TEST_ASSERT(escaped("\xe2\x82") == "\\ufffd", "... also at the end");
+    TEST_ASSERT(escaped("\xc0\xaf") == "\\ufffd\\ufffd", "Overlong form");
+    TEST_ASSERT(escaped("\xed\xa0\x80") == "\\ufffd\\ufffd\\ufffd", "Surrogate");
+    TEST_ASSERT(escaped("\xf4\x90\x80\x80") == "\\ufffd\\ufffd\\ufffd\\ufffd", "Past U+10FFFF");
+    TEST_ASSERT(escaped("\x80\"") == "\\ufffd\\\"", "Stray continuation byte, then an escape");
+
+    // Latin-1 and cut-off multibyte names as a program with a broken locale prints them.
+    const std::vector<std::string> log{
+        "==4242== Invalid read of size 4",
+        "==4242==    at 0x401234: caf\xe9\xff (\xe2\x82.cpp:10)",
+        "==4242==    by 0x401300: na\xc3\xafve_\xed\xa0\x80 (/src/\xc0\xaf\x80.cpp:20)",
+        "==4242== Invalid write of size 1",
+        "==4242==    at 0x401500: \xf4\x90\x80\x80 (t.cpp:5)",
+    };
+    Options opt;
+    opt.trim  = false;
+    opt.depth = 0;
+    for (const auto format : {OutputFormat::Ndjson, OutputFormat::Json, OutputFormat::Sarif}) {
+        opt.format = format;
+        const std::string out = run_lines(opt, log);
+        if (format == OutputFormat::Ndjson) {
+            const auto records = split_lines(out);
+            TEST_ASSERT(records.size() == 2 && is_json(records[0]) && is_json(records[1]), "NDJSON records parse");
+            TEST_ASSERT(out.find("\"fn\":\"na\xc3\xafve_\\ufffd\\ufffd\\ufffd\"") != std::string::npos,
+                        "Well-formed bytes of a frame kept");
+        } else {
+            TEST_ASSERT(is_json(out), (format == OutputFormat::Json ? "JSON array parses" : "SARIF log parses"));
+        }
+    }
+    TEST_ASSERT(!is_json("[\"\xff\"]") && !is_json("{\"a\":}") && is_json("{\"a\":[1,-2.5e3,true,null]}"),
+                "The checker itself");
+
+    TEST_PASS("Ill-formed UTF-8 tests completed");
+    return true;
+}
+
+bool test_record_shape() {
+    std::cout << "\n=== Testing ndjson records ===" << std::endl;
+
+    Options opt;
+    opt.trim   = false;
+    opt.format = OutputFormat::Ndjson;
+    const auto records = split_lines(run_lines(opt, LOG));
+    TEST_ASSERT(records.size() == 2, "One line per unique block");
+
+    const std::string& read = records[0];
+    TEST_ASSERT(read.starts_with("{\"kind\":\"invalid-read\",\"fingerprint\":\"") && read.ends_with("}"),
+                "Kind first, one object per line");
+    TEST_ASSERT(read.find("\"count\":2,\"bytes\":8,\"blocks\":0,\"header\":\"Invalid read of size 4\"") !=
+                std::string::npos, "Counts include the duplicate");
+    TEST_ASSERT(read.find("\"frames\":[{\"fn\":\"main\",\"file\":\"a.cpp\",\"line\":10}]") != std::string::npos,
+                "Source frame");
+    TEST_ASSERT(read.find("\"text\":\"Invalid read of size 4\\nmain (a.cpp:10)\"}") != std::string::npos,
+                "Text as printed, scrubbed, without the trailing blank line");
+
+    const std::string& leak = records[1];
+    TEST_ASSERT(leak.find("\"kind\":\"definitely-lost\"") != std::string::npos &&
+                leak.find("\"count\":2,\"bytes\":1536,\"blocks\":4") != std::string::npos, "Leak totals");
+    TEST_ASSERT(leak.find("{\"fn\":\"malloc\",\"obj\":\"/usr/lib/valgrind/vgpreload_memcheck-amd64-linux.so\"}") !=
+                std::string::npos, "Object frame");
+    TEST_ASSERT(leak.find("{\"fn\":\"print(\\\"x\\\\ty\\\")\",\"file\":\"b.cpp\",\"line\":20}") != std::string::npos,
+                "Frame names are escaped");
+
+    TEST_PASS("Record shape tests completed");
+    return true;
+}
+
+bool test_json_array() {
+    std::cout << "\n=== Testing json arrays ===" << std::endl;
+
+    Options opt;
+    opt.trim   = false;
+    opt.format = OutputFormat::Ndjson;
+    const auto records = split_lines(run_lines(opt, LOG));
+
+    opt.format = OutputFormat::Json;
+    const std::string array = run_lines(opt, LOG);
+    TEST_ASSERT(array == "[\n" + records[0] + ",\n" + records[1] + "\n]\n", "Same records, in one array");
+
+    opt.trim = true; // no marker: nothing is output
+    TEST_ASSERT(run_lines(opt, LOG) == "[]\n", "Empty run is an empty array");
+    opt.format = OutputFormat::Ndjson;
+    TEST_ASSERT(run_lines(opt, LOG).empty(), "Empty run is no lines");
+
+    TEST_PASS("Json array tests completed");
+    return true;
+}
+
+bool test_sarif_document() {
+    std::cout << "\n=== Testing SARIF output ===" << std::endl;
+
+    Options opt;
+    opt.trim   = false;
+    opt.format = OutputFormat::Ndjson;
+    const auto records = split_lines(run_lines(opt, LOG));
+    opt.format = OutputFormat::Sarif;
+    const std::string sarif = run_lines(opt, LOG);
+
+    TEST_ASSERT(sarif.starts_with("{\"version\":\"2.1.0\"") && sarif.ends_with("\n]}]}\n"), "One SARIF log");
+    TEST_ASSERT(count(sarif, "\"defaultConfiguration\"") == BLOCK_KIND_COUNT, "A rule per block kind");
+    TEST_ASSERT(count(sarif, "\"ruleId\"") == 2, "A result per unique block");
+
+    const auto result = sarif.find("{\"ruleId\":\"invalid-read\",\"ruleIndex\":1,\"level\":\"error\"");
+    TEST_ASSERT(result != std::string::npos, "Rule is the block kind");
+    const std::string fp = records[0].substr(records[0].find("\"fingerprint\":\"") + 15, 16);
+    TEST_ASSERT(sarif.find("\"partialFingerprints\":{\"vglogFilterSignature/v1\":\"" + fp + "\"},\"occurrenceCount\":2",
+                           result) != std::string::npos, "Dedupe key and count");
+    TEST_ASSERT(sarif.find("\"locations\":[{\"physicalLocation\":{\"artifactLocation\":{\"uri\":\"a.cpp\"},"
+                           "\"region\":{\"startLine\":10}}", result) != std::string::npos, "Source location");
+
+    // The leak's top frame has no source line: the location is the first one that does.
+    const auto leak = sarif.find("{\"ruleId\":\"definitely-lost\"");
+    TEST_ASSERT(leak != std::string::npos &&
+                sarif.find("\"locations\":[{\"physicalLocation\":{\"artifactLocation\":{\"uri\":\"b.cpp\"}", leak) !=
+                    std::string::npos, "Frames without a source line are skipped");
+    TEST_ASSERT(sarif.find("{\"uri\":\"file:///usr/lib/valgrind/vgpreload_memcheck-amd64-linux.so\"}", leak) !=
+                std::string::npos, "Objects in the stack as file URIs");
+
+    opt.trim = true;
+    const std::string empty = run_lines(opt, LOG);
+    TEST_ASSERT(empty.ends_with("\"results\":[]}]}\n"), "Empty run has no results");
+
+    TEST_PASS("SARIF tests completed");
+    return true;
+}
+
+bool test_sarif_stacks() {
+    std::cout << "\n=== Testing SARIF stacks ===" << std::endl;
+
+    const std::vector<std::string> log{
+        "==4242== Invalid read of size 4",
+        "==4242==    at 0x401234: reader (r.cpp:5)",
+        "==4242==    by 0x401300: main (m.cpp:9)",
+        "==4242==  Address 0x5204040 is 0 bytes inside a block of size 4 free'd",
+        "==4242==    at 0x4C2BDEC: free (in /usr/lib/valgrind/vgpreload_memcheck-amd64-linux.so)",
+        "==4242==    by 0x401100: release (f.cpp:7)",
+        "==4242==  Block was alloc'd at",
+        "==4242==    at 0x4C2AB80: malloc (in /usr/lib/valgrind/vgpreload_memcheck-amd64-linux.so)",
+        "==4242==    by 0x401000: make (a.cpp:3)",
+    };
+    Options opt;
+    opt.trim   = false;
+    opt.format = OutputFormat::Sarif;
+    const std::string sarif = run_lines(opt, log);
+    TEST_ASSERT(is_json(sarif), "Valid JSON");
+
+    const auto own   = sarif.find("\"stacks\":[{\"message\":{\"text\":\"Invalid read of size 4\"}");
+    const auto freed = sarif.find("{\"message\":{\"text\":\"Address 0x5204040 is 0 bytes inside a block of size 4 free'd\"}");
+    const auto alloc = sarif.find("{\"message\":{\"text\":\"Block was alloc'd at\"}");
+    TEST_ASSERT(own != std::string::npos && freed != std::string::npos && alloc != std::string::npos &&
+                own < freed && freed < alloc, "Own, free and allocation stacks, each with its line");
+    TEST_ASSERT(sarif.find("m.cpp", own) < freed && sarif.find("f.cpp", own) > freed && sarif.find("a.cpp", own) > alloc,
+                "Each stack holds only its own frames");
+    TEST_ASSERT(count(sarif, "\"frames\":[") == 3, "One SARIF stack per stack in the block");
+
+    TEST_PASS("SARIF stack tests completed");
+    return true;
+}
+
+bool test_stream_paths() {
+    std::cout << "\n=== Testing records from stream mode ===" << std::endl;
+
+    Options opt;
+    opt.trim   = false;
+    opt.format = OutputFormat::Ndjson;
+    const std::string in_memory = run_lines(opt, LOG);
+
+    opt.stream_mode = true;
+    const std::string log = joined(LOG);
+    TEST_ASSERT(run_stream(opt, log) == in_memory, "Seekable input: blocks re-read as byte ranges");
+    opt.use_stdin = true;
+    TEST_ASSERT(run_stream(opt, log) == in_memory, "Pipe: blocks held in memory");
+
+    // Enough distinct blocks to pass a 1 MB budget: later records come from the spill file.
+    std::vector<std::string> many;
+    for (int i = 0; i < 12000; ++i) {
+        const std::string n = std::to_string(i);
+        many.emplace_back("==4242== Invalid write of size 8");
+        many.emplace_back("==4242==    at 0x4005D4: function_number_").append(n).append(" (spill_test_source_file.cpp:")
+            .append(n).append(")");
+        many.emplace_back("==4242==    by 0x400600: main (main.cpp:1)");
+    }
+    opt.depth       = 2;
+    opt.use_stdin   = false;
+    opt.stream_mode = false;
+    const std::string expected = run_lines(opt, many);
+    opt.stream_mode   = true;
+    opt.use_stdin     = true;
+    opt.max_memory_mb = 1;
+    const std::string spilled = run_stream(opt, joined(many));
+    TEST_ASSERT(split_lines(spilled).size() == 12000 && spilled == expected, "Spilled blocks keep order and counts");
+
+    TEST_PASS("Stream path tests completed");
+    return true;
+}
+
+int main() {
+    std::cout << "Running JSON writer tests..." << std::endl;
+
+    bool all_passed = true;
+
+    all_passed &= test_string_escaping();
+    all_passed &= test_invalid_utf8();
+    all_passed &= test_record_shape();
+    all_passed &= test_json_array();
+    all_passed &= test_sarif_document();
+    all_passed &= test_sarif_stacks();
+    all_passed &= test_stream_paths();
+
+    if (all_passed) {
+        std::cout << "\n✅ All JSON writer tests passed!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "\n❌ Some JSON writer tests failed!" << std::endl;
+        return 1;
+    }
+}
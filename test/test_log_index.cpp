@@ -0,0 +1,197 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include "test_helpers.h"
+#include <log_index.h>
+#include <log_processor.h>
+
+namespace {
+
+const std::string LOG_FILE   = "test_log_index.log";
+const std::string RULES_FILE = "test_log_index.rules";
+
+// Two interleaved processes, duplicates at every depth, a leak record, a line
+// that scrubbing empties, a block the marker cuts in two and blocks still
+// open at the end.
+const std::string LOG =
+    "==4242== Memcheck, a memory error detector\n"
+    "==4242== Invalid read of size 4\n"
+    "==4242==    at 0x401234: main (a.cpp:10)\n"
+    "==4242==    by 0x401500: run (r.cpp:3)\n"
+    "==5151== Invalid read of size 4\n"
+    "==5151==    at 0x401234: main (a.cpp:10)\n"
+    "==5151==    by 0x401600: walk (w.cpp:8)\n"
+    "==4242== 1,024 bytes in 3 blocks are definitely lost in loss record 2 of 2\n"
+    "==4242==    at 0x4C2AB80: malloc (in /usr/lib/valgrind/vgpreload_memcheck-amd64-linux.so)\n"
+    "==4242==    by 0x401300: make (b.cpp:20)\n"
+    "==4242== Conditional jump or move depends on uninitialised value(s)\n"
+    "==4242==    at 0x401400: check (c.cpp:7)\n"
+    "Successfully downloaded debug info\n"
+    "==4242==    at 0x401401: ???\n"
+    "==4242==    by 0x401402: check (c.cpp:7)\n"
+    "==4242== Invalid read of size 4\n"
+    "==4242==    at 0x401234: main (a.cpp:10)\n"
+    "==4242==    by 0x401500: run (r.cpp:3)\n"
+    "==4242== 16 bytes in 1 blocks are definitely lost in loss record 1 of 2\n"
+    "==4242==    at 0x4C2AB80: malloc (in /usr/lib/valgrind/vgpreload_memcheck-amd64-linux.so)\n"
+    "==4242==    by 0x401300: make (b.cpp:20)\n"
+    "==4242== ERROR SUMMARY: 4 errors from 3 contexts\n"
+    "==5151== Invalid write of size 8\n"
+    "==5151==    at 0x401700: put (p.cpp:1)\n"
+    "==4242== Invalid read of size 4\n"
+    "==4242==    at 0x401234: main (a.cpp:10)\n"
+    "==4242==    by 0x401600: walk (w.cpp:8)\n";
+
+void write_file(const std::string& name, const std::string& text) {
+    std::ofstream out(name, std::ios::binary | std::ios::trunc);
+    out << text;
+}
+
+// Output of `opt` over LOG_FILE: parsed as main() would, or from its index
+// when `indexed`.
+std::string run(const Options& opt, bool indexed) {
+    if (indexed) {
+        bool used = false;
+        std::string output = capture_stdout([&] { used = process_file_indexed(LOG_FILE, opt).has_value(); });
+        return used ? output : "<index not used>";
+    }
+    std::ifstream      in(LOG_FILE, std::ios::binary);
+    std::ostringstream data;
+    data << in.rdbuf();
+    return opt.stream_mode ? run_stream(opt, data.str()) : run_buffer(opt, data.str());
+}
+
+} // namespace
+
+bool test_same_output() {
+    std::cout << "\n=== Testing indexed runs against parsed runs ===" << std::endl;
+
+    write_file(LOG_FILE, LOG);
+    Options opt;
+    TEST_ASSERT(build_log_index(LOG_FILE, opt) == 9, "Every block indexed, duplicates included");
+
+    for (const bool trim : {true, false}) {
+        for (const bool scrub : {true, false}) {
+            for (const int depth : {1, 2, 0}) {
+                opt.trim      = trim;
+                opt.scrub_raw = scrub;
+                opt.depth     = depth;
+                const std::string parsed = run(opt, false);
+                TEST_ASSERT(!parsed.empty(), "The log has output");
+                TEST_ASSERT(run(opt, true) == parsed, "Same text output at depth " + std::to_string(depth) +
+                                                          (trim ? ", trimmed" : "") + (scrub ? ", scrubbed" : ""));
+            }
+        }
+    }
+
+    opt        = Options{};
+    opt.format = OutputFormat::Ndjson;
+    opt.trim   = false;
+    const std::string records = run(opt, true);
+    TEST_ASSERT(records == run(opt, false), "Same records");
+    TEST_ASSERT(records.find("\"count\":4,\"bytes\":16,") != std::string::npos, "Duplicate counts from the index");
+
+    opt.format      = OutputFormat::Text;
+    opt.stream_mode = true;
+    TEST_ASSERT(run(opt, true) == run(opt, false), "Stream mode");
+
+    TEST_PASS("Indexed output tests completed");
+    return true;
+}
+
+bool test_stale_index() {
+    std::cout << "\n=== Testing stale indexes ===" << std::endl;
+
+    write_file(LOG_FILE, LOG);
+    Options opt;
+    (void)build_log_index(LOG_FILE, opt);
+    TEST_ASSERT(run(opt, true) != "<index not used>", "Fresh index used");
+
+    Options marker = opt;
+    marker.marker  = "other marker";
+    TEST_ASSERT(run(marker, true) == "<index not used>", "A trimmed run needs the indexed marker");
+    marker.trim = false;
+    TEST_ASSERT(run(marker, true) != "<index not used>", "... an untrimmed one does not");
+
+    write_file(RULES_FILE, "main => entry\n");
+    Options rules         = opt;
+    rules.canon_rules_file = RULES_FILE;
+    TEST_ASSERT(run(rules, true) == "<index not used>", "Different canonicalization");
+    (void)build_log_index(LOG_FILE, rules);
+    TEST_ASSERT(run(rules, true) == run(rules, false), "Index built with the rules");
+    write_file(RULES_FILE, "main => start\n");
+    TEST_ASSERT(run(rules, true) == "<index not used>", "Rule file edited since");
+
+    write_file(LOG_FILE, LOG + "==4242== Invalid free() / delete / delete[] / realloc()\n");
+    TEST_ASSERT(run(opt, true) == "<index not used>", "Log grew since");
+    TEST_ASSERT(!process_file_indexed(LOG_FILE + ".none", opt).has_value(), "No index");
+
+    std::remove(RULES_FILE.c_str());
+    TEST_PASS("Stale index tests completed");
+    return true;
+}
+
+bool test_rejected_input() {
+    std::cout << "\n=== Testing corrupt indexes and other tools ===" << std::endl;
+
+    write_file(LOG_FILE, LOG);
+    Options opt;
+    (void)build_log_index(LOG_FILE, opt);
+    const auto path = index_path(LOG_FILE);
+    {
+        std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+        f.seekp(sizeof(IndexHeader) + 8);
+        const std::uint32_t huge = 0x7fffffff;
+        f.write(reinterpret_cast<const char*>(&huge), sizeof(huge)); // first line runs past the log
+    }
+    bool corrupt = false;
+    try {
+        (void)process_file_indexed(LOG_FILE, opt);
+    } catch (const std::runtime_error&) {
+        corrupt = true;
+    }
+    TEST_ASSERT(corrupt, "Line outside the log rejected");
+
+    write_file(LOG_FILE, "==4242== Helgrind, a thread error detector\n"
+                         "==4242== Thread #1 is the program's root thread\n");
+    bool refused = false;
+    try {
+        (void)build_log_index(LOG_FILE, opt);
+    } catch (const std::runtime_error&) {
+        refused = true;
+    }
+    TEST_ASSERT(refused, "Only Memcheck logs are indexed");
+
+    std::remove(path.c_str());
+    std::remove(LOG_FILE.c_str());
+    TEST_PASS("Rejected input tests completed");
+    return true;
+}
+
+int main() {
+    std::cout << "Running log index tests..." << std::endl;
+
+    bool all_passed = true;
+
+    all_passed &= test_same_output();
+    all_passed &= test_stale_index();
+    all_passed &= test_rejected_input();
+
+    if (all_passed) {
+        std::cout << "\n✅ All log index tests passed!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "\n❌ Some log index tests failed!" << std::endl;
+        return 1;
+    }
+}
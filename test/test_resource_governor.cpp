@@ -0,0 +1,232 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+#include <vector>
+#include "test_helpers.h"
+#include <log_processor.h>
+#include <resource_governor.h>
+
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr std::size_t MB = 1024u * 1024u;
+
+// Throwaway directory standing in for "/" with just the files the governor reads.
+class FakeRoot {
+public:
+    FakeRoot() : root_(fs::temp_directory_path() / ("vglog_governor_" + std::to_string(::getpid()))) {
+        fs::remove_all(root_);
+        fs::create_directories(root_);
+    }
+    ~FakeRoot() {
+        std::error_code ec;
+        fs::remove_all(root_, ec);
+    }
+    FakeRoot(const FakeRoot&)            = delete;
+    FakeRoot& operator=(const FakeRoot&) = delete;
+
+    void write(const fs::path& rel, std::string_view content) const {
+        const auto p = root_ / rel;
+        fs::create_directories(p.parent_path());
+        std::ofstream(p) << content;
+    }
+    [[nodiscard]] const fs::path& path() const noexcept { return root_; }
+
+private:
+    fs::path root_;
+};
+
+std::vector<std::string> split_lines(const std::string& text) {
+    std::vector<std::string> lines;
+    std::istringstream in(text);
+    for (std::string line; std::getline(in, line);) lines.push_back(line);
+    return lines;
+}
+
+} // namespace
+
+bool test_cgroup_v2_limits() {
+    std::cout << "\n=== Testing cgroup v2 limits ===" << std::endl;
+
+    FakeRoot root;
+    root.write("proc/self/statm", "5000 250 100 10 0 300 0\n");
+    root.write("proc/meminfo", "MemTotal:       16000000 kB\nMemFree:         1000 kB\nMemAvailable:    204800 kB\n");
+    root.write("proc/self/cgroup", "0::/app.slice/job.scope\n");
+    root.write("sys/fs/cgroup/app.slice/job.scope/memory.max", "104857600\n");
+    root.write("sys/fs/cgroup/app.slice/job.scope/memory.current", "73400320\n");
+
+    const auto st = ResourceGovernor{root.path()}.sample();
+    TEST_ASSERT(st.rss_bytes == 250u * static_cast<std::size_t>(::sysconf(_SC_PAGESIZE)), "RSS comes from statm pages");
+    TEST_ASSERT(st.available_bytes == 200 * MB, "MemAvailable is read in kB");
+    TEST_ASSERT(st.cgroup_limit_bytes == 100 * MB && st.cgroup_usage_bytes == 70 * MB, "memory.max and memory.current");
+    TEST_ASSERT(st.headroom() == 30 * MB, "The cgroup is the tighter bound");
+
+    root.write("sys/fs/cgroup/app.slice/job.scope/memory.max", "max\n");
+    const auto unlimited = ResourceGovernor{root.path()}.sample();
+    TEST_ASSERT(unlimited.cgroup_limit_bytes == 0 && unlimited.headroom() == 200 * MB, "\"max\" means no cgroup limit");
+
+    TEST_PASS("cgroup v2 tests completed");
+    return true;
+}
+
+bool test_cgroup_v1_limits() {
+    std::cout << "\n=== Testing cgroup v1 limits ===" << std::endl;
+
+    FakeRoot root;
+    root.write("proc/meminfo", "MemAvailable:    1048576 kB\n");
+    // The container's own path is not visible; the mount root holds its limit
+    root.write("proc/self/cgroup", "5:cpu,cpuacct:/docker/abc\n4:memory:/docker/abc\n0::/\n");
+    root.write("sys/fs/cgroup/memory/memory.limit_in_bytes", "536870912\n");
+    root.write("sys/fs/cgroup/memory/memory.usage_in_bytes", "134217728\n");
+
+    const auto st = ResourceGovernor{root.path()}.sample();
+    TEST_ASSERT(st.cgroup_limit_bytes == 512 * MB && st.cgroup_usage_bytes == 128 * MB, "v1 limit found at the mount root");
+    TEST_ASSERT(st.headroom() == 384 * MB, "Headroom is what the cgroup has left");
+
+    root.write("sys/fs/cgroup/memory/memory.limit_in_bytes", "9223372036854771712\n");
+    TEST_ASSERT(ResourceGovernor{root.path()}.sample().headroom() == 1024 * MB, "The v1 \"unlimited\" value is ignored");
+
+    TEST_PASS("cgroup v1 tests completed");
+    return true;
+}
+
+bool test_unknown_memory() {
+    std::cout << "\n=== Testing missing procfs ===" << std::endl;
+
+    FakeRoot root;
+    const auto st = ResourceGovernor{root.path()}.sample();
+    TEST_ASSERT(st.rss_bytes == 0 && !st.headroom().has_value(), "Nothing readable means unknown");
+    TEST_ASSERT(choose_strategy(MB, st) == InputStrategy::InMemory, "Small files are still read into memory");
+    TEST_ASSERT(choose_strategy(64 * MB, st) == InputStrategy::Stream, "Large files are streamed when memory is unknown");
+
+    TEST_PASS("Missing procfs tests completed");
+    return true;
+}
+
+bool test_strategy_choice() {
+    std::cout << "\n=== Testing strategy choice ===" << std::endl;
+
+    MemoryStatus plenty;
+    plenty.available_bytes = 8192 * MB;
+    TEST_ASSERT(choose_strategy(1 * MB, plenty) == InputStrategy::InMemory, "Small file in memory");
+    TEST_ASSERT(choose_strategy(512 * MB, plenty) == InputStrategy::Mapped, "Large file mapped");
+    TEST_ASSERT(choose_strategy(6000 * MB, plenty) == InputStrategy::Stream, "File beyond half the headroom streamed");
+
+    MemoryStatus tight;
+    tight.available_bytes    = 8192 * MB;
+    tight.cgroup_limit_bytes = 64 * MB;
+    tight.cgroup_usage_bytes = 58 * MB;
+    TEST_ASSERT(choose_strategy(1 * MB, tight) == InputStrategy::Mapped, "Tight cgroup: small file mapped instead");
+    TEST_ASSERT(choose_strategy(4 * MB, tight) == InputStrategy::Stream, "Tight cgroup: larger file streamed");
+    TEST_ASSERT(strategy_name(InputStrategy::Mapped) == "memory-mapped", "Strategy names");
+
+    TEST_PASS("Strategy choice tests completed");
+    return true;
+}
+
+bool test_buffer_matches_lines() {
+    std::cout << "\n=== Testing mapped-buffer processing ===" << std::endl;
+
+    const std::string log =
+        "==4242== Invalid read of size 4\n"
+        "==4242==    at 0x401234: early (a.cpp:1)\n"
+        "==4242== Successfully downloaded debug info\n"
+        "==4242== Invalid write of size 8\n"
+        "==4242==    at 0x401300: helper (b.cpp:20)\n"
+        "==4242== \n"
+        "==4242== Invalid write of size 8\n"
+        "==4242==    at 0x401300: helper (b.cpp:20)\n"
+        "==4242== Conditional jump or move depends on uninitialised value(s)\n"
+        "==4242==    at 0x401400: main (c.cpp:5)";  // no final newline
+    const auto lines = split_lines(log);
+
+    for (const bool trim : {true, false}) {
+        Options opt;
+        opt.trim = trim;
+        const auto expected = run_lines(opt, lines);
+        const auto actual   = run_buffer(opt, log);
+        TEST_ASSERT(!expected.empty() && actual == expected, "Buffer and line vector give the same output");
+    }
+
+    Options opt;
+    opt.marker = "not present";
+    TEST_ASSERT(run_buffer(opt, log).empty(), "No marker, nothing kept");
+    opt.marker = "(c.cpp:5)";
+    TEST_ASSERT(run_buffer(opt, log).empty(), "Marker on the last line keeps nothing");
+
+    TEST_PASS("Mapped-buffer tests completed");
+    return true;
+}
+
+bool test_pending_budget_without_memory_status() {
+    std::cout << "\n=== Testing pending output when memory is unknown ===" << std::endl;
+
+    // More unique blocks than any count limit would allow, all held until EOF.
+    constexpr int BLOCKS = 1500;
+    std::string log;
+    for (int n = 0; n < BLOCKS; ++n) {
+        log += "==4242== Invalid read of size 4\n"
+               "==4242==    at 0x401234: f" + std::to_string(n) + " (a.cpp:10)\n";
+    }
+
+    FakeRoot root;
+    Options opt;
+    opt.trim        = false;
+    opt.stream_mode = true;
+    opt.use_stdin   = true; // not seekable: blocks are kept as text
+    opt.depth       = 0;
+    opt.system_root = root.path().string();
+    std::string output;
+    bool threw = false;
+    try {
+        output = run_stream(opt, log);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    TEST_ASSERT(!threw, "Unknown memory falls back to a byte budget");
+
+    std::size_t blocks = 0;
+    for (auto pos = output.find("Invalid read"); pos != std::string::npos; pos = output.find("Invalid read", pos + 1)) {
+        ++blocks;
+    }
+    TEST_ASSERT(blocks == BLOCKS, "Every block is output");
+    opt.max_memory_mb = 64;
+    TEST_ASSERT(run_stream(opt, log) == output, "Same output as with --max-memory");
+
+    TEST_PASS("Unknown memory budget tests completed");
+    return true;
+}
+
+int main() {
+    std::cout << "Running resource governor tests..." << std::endl;
+
+    bool all_passed = true;
+
+    all_passed &= test_cgroup_v2_limits();
+    all_passed &= test_cgroup_v1_limits();
+    all_passed &= test_unknown_memory();
+    all_passed &= test_strategy_choice();
+    all_passed &= test_buffer_matches_lines();
+    all_passed &= test_pending_budget_without_memory_status();
+
+    if (all_passed) {
+        std::cout << "\n✅ All resource governor tests passed!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "\n❌ Some resource governor tests failed!" << std::endl;
+        return 1;
+    }
+}
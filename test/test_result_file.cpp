@@ -0,0 +1,150 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "test_helpers.h"
+#include <log_processor.h>
+#include <result_file.h>
+
+namespace {
+
+const std::string RESULT_FILE = "test_result_file.bin";
+
+const std::vector<std::string> LOG{
+    "==4242== Invalid read of size 4",
+    "==4242==    at 0x401234: main (a.cpp:10)",
+    "==4242== 1024 bytes in 3 blocks are definitely lost in loss record 2 of 2",
+    "==4242==    at 0x4C2AB80: malloc (in /usr/lib/valgrind/vgpreload_memcheck-amd64-linux.so)",
+    "==4242==    by 0x401300: make (b.cpp:20)",
+    "==4242== Invalid read of size 4",
+    "==4242==    at 0x401999: main (a.cpp:10)",
+    "==4242== Conditional jump or move depends on uninitialised value(s)",
+    "==4242==    at 0x401400: check (c.cpp:7)",
+};
+
+std::string show(std::optional<std::string_view> fp = std::nullopt) {
+    std::ostringstream out;
+    show_result_file(RESULT_FILE, fp, out);
+    return out.str();
+}
+
+} // namespace
+
+bool test_round_trip() {
+    std::cout << "\n=== Testing result file round trip ===" << std::endl;
+
+    Options opt;
+    opt.trim = false;
+    const std::string text = run_lines(opt, LOG);
+
+    opt.result_file = RESULT_FILE;
+    TEST_ASSERT(run_lines(opt, LOG) == text, "Text output is unchanged");
+    TEST_ASSERT(show() == text, "show renders the same text");
+
+    opt.stream_mode = true;
+    TEST_ASSERT(run_stream(opt, LOG) == text && show() == text, "Stream mode writes the same file");
+
+    TEST_PASS("Round trip tests completed");
+    return true;
+}
+
+bool test_lookup() {
+    std::cout << "\n=== Testing result file lookup ===" << std::endl;
+
+    Options opt;
+    opt.trim        = false;
+    opt.result_file = RESULT_FILE;
+    LogProcessor p(opt);
+    (void)capture_stdout([&] { p.process_lines(LOG); });
+
+    const BlockStore& store = p.blocks();
+    const ResultFile file(RESULT_FILE);
+    TEST_ASSERT(file.size() == store.size() && file.size() == 3, "One record per unique block");
+    for (std::size_t i = 0; i < file.size(); ++i) {
+        const ResultRecord r = file.record(i);
+        TEST_ASSERT(r.fingerprint == store.fingerprint(i) && r.occurrences == store.occurrences(i) &&
+                    r.bytes == store.bytes(i) && r.heap_blocks == store.heap_blocks(i) &&
+                    r.kind == static_cast<std::uint8_t>(store.kind(i)), "Record matches the block store");
+        TEST_ASSERT(file.find(r.fingerprint) == i, "Fingerprint index finds the record");
+    }
+    TEST_ASSERT(file.record(0).occurrences == 2 && file.text(file.record(0)) == "Invalid read of size 4\nmain (a.cpp:10)",
+                "Counts and text of a repeated block");
+    TEST_ASSERT(!file.find(store.fingerprint(0) ^ 1), "Unknown fingerprint");
+
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(store.fingerprint(2)));
+    TEST_ASSERT(show(std::string_view{hex}) == "Conditional jump or move depends on uninitialised value(s)\n"
+                                              "check (c.cpp:7)\n\n", "show FINGERPRINT prints one block");
+
+    bool threw = false;
+    try {
+        (void)show(std::string_view{"xyz"});
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    TEST_ASSERT(threw, "Malformed fingerprint is rejected");
+
+    TEST_PASS("Lookup tests completed");
+    return true;
+}
+
+bool test_empty_and_corrupt() {
+    std::cout << "\n=== Testing empty and corrupt result files ===" << std::endl;
+
+    Options opt;
+    opt.result_file = RESULT_FILE; // trimmed, no marker: nothing is output
+    TEST_ASSERT(run_lines(opt, LOG).empty(), "No output");
+    TEST_ASSERT(ResultFile(RESULT_FILE).size() == 0 && show().empty(), "Empty result file");
+
+    opt.trim = false;
+    (void)run_lines(opt, LOG);
+    std::string data;
+    {
+        std::ifstream      in(RESULT_FILE, std::ios::binary);
+        std::ostringstream bytes;
+        bytes << in.rdbuf();
+        data = bytes.str();
+    }
+    {
+        std::ofstream out(RESULT_FILE, std::ios::binary | std::ios::trunc);
+        out.write(data.data(), static_cast<std::streamsize>(data.size() - 8));
+    }
+    bool threw = false;
+    try {
+        const ResultFile truncated(RESULT_FILE);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    TEST_ASSERT(threw, "Truncated file is rejected");
+
+    std::remove(RESULT_FILE.c_str());
+    TEST_PASS("Empty and corrupt file tests completed");
+    return true;
+}
+
+int main() {
+    std::cout << "Running result file tests..." << std::endl;
+
+    bool all_passed = true;
+
+    all_passed &= test_round_trip();
+    all_passed &= test_lookup();
+    all_passed &= test_empty_and_corrupt();
+
+    if (all_passed) {
+        std::cout << "\n✅ All result file tests passed!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "\n❌ Some result file tests failed!" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,77 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "test_helpers.h"
+#include <spill_file.h>
+
+bool test_round_trip() {
+    std::cout << "\n=== Testing spill round trip ===" << std::endl;
+
+    SpillFile spill;
+    TEST_ASSERT(spill.empty(), "New spill file is empty");
+
+    std::ostringstream none;
+    spill.copy_to(none);
+    TEST_ASSERT(none.str().empty(), "Unused spill file copies nothing");
+
+    std::string expected;
+    for (int i = 0; i < 5000; ++i) {
+        const std::string block = "block " + std::to_string(i) + "\n";
+        spill.append(block);
+        expected += block;
+    }
+    // Larger than the write buffer: goes straight to the file
+    const std::string big(200 * 1024, 'x');
+    spill.append(big);
+    expected += big;
+
+    TEST_ASSERT(spill.bytes() == expected.size(), "Byte count tracks appends");
+
+    std::ostringstream out;
+    spill.copy_to(out);
+    TEST_ASSERT(out.str() == expected, "Spilled bytes come back in append order");
+
+    TEST_PASS("Spill round trip tests completed");
+    return true;
+}
+
+bool test_truncate() {
+    std::cout << "\n=== Testing spill truncation ===" << std::endl;
+
+    SpillFile spill;
+    spill.append("old epoch\n");
+    spill.truncate();
+    TEST_ASSERT(spill.empty(), "Truncate empties the spill file");
+
+    spill.append("new epoch\n");
+    std::ostringstream out;
+    spill.copy_to(out);
+    TEST_ASSERT(out.str() == "new epoch\n", "Only data written after truncate remains");
+
+    TEST_PASS("Spill truncation tests completed");
+    return true;
+}
+
+int main() {
+    std::cout << "Running spill file tests..." << std::endl;
+
+    bool all_passed = true;
+
+    all_passed &= test_round_trip();
+    all_passed &= test_truncate();
+
+    if (all_passed) {
+        std::cout << "\n✅ All spill file tests passed!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "\n❌ Some spill file tests failed!" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,369 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "test_helpers.h"
+#include <log_processor.h>
+#include <suppressions.h>
+
+namespace {
+
+const std::string SUPP_FILE = "test_suppressions.supp";
+
+const std::vector<std::string> LOG{
+    "==4242== Invalid read of size 4",
+    "==4242==    at 0x401234: Map<int, Foo>::at(int) (map.h:10)",
+    "==4242==    by 0x401300: main (a.cpp:20)",
+    "==4242==  Address 0x5204044 is 0 bytes after a block of size 4 alloc'd",
+    "==4242==    at 0x4C2AB80: malloc (in /usr/lib/valgrind/vgpreload_memcheck-amd64-linux.so)",
+    "==4242==    by 0x401100: make (b.cpp:5)",
+    "==4242== ",
+    "==4242== 1024 bytes in 3 blocks are definitely lost in loss record 2 of 2",
+    "==4242==    at 0x4C2AB80: malloc (in /usr/lib/valgrind/vgpreload_memcheck-amd64-linux.so)",
+    "==4242==    by 0x401300: ??? (in /usr/lib/libfoo.so)",
+    "==4242== ",
+    // Same functions from another file: a distinct block, but the same suppression
+    "==4242== Invalid read of size 4",
+    "==4242==    at 0x401234: Map<long, Bar>::at(int) (other.h:99)",
+    "==4242==    by 0x401300: main (c.cpp:20)",
+    "==4242== ",
+    "==4242== Syscall param write(buf) points to uninitialised byte(s)",
+    "==4242==    at 0x4F1C2A4: write (write.c:26)",
+    "==4242== ",
+    "==4242== Process terminating with default action of signal 11 (SIGSEGV)",
+    "==4242==    at 0x401500: crash (d.cpp:1)",
+};
+
+std::string generate(Options opt, const std::vector<std::string>& log = LOG) {
+    opt.trim              = false;
+    opt.suppressions_file = SUPP_FILE;
+    (void)run_lines(opt, log);
+
+    std::ifstream      in(SUPP_FILE);
+    std::ostringstream supp;
+    supp << in.rdbuf();
+    std::remove(SUPP_FILE.c_str());
+    return supp.str();
+}
+
+std::size_t count(const std::string& haystack, std::string_view needle) {
+    std::size_t n = 0;
+    for (auto pos = haystack.find(needle); pos != std::string::npos; pos = haystack.find(needle, pos + 1)) ++n;
+    return n;
+}
+
+// Valgrind's own matching: '*' and '?' globs, with fun: compared to the
+// mangled name of the function and obj: to its object.
+bool valgrind_glob(std::string_view pattern, std::string_view text) {
+    if (pattern.empty()) return text.empty();
+    if (pattern[0] == '*') {
+        for (std::size_t i = 0; i <= text.size(); ++i) {
+            if (valgrind_glob(pattern.substr(1), text.substr(i))) return true;
+        }
+        return false;
+    }
+    return !text.empty() && (pattern[0] == '?' || pattern[0] == text[0]) &&
+           valgrind_glob(pattern.substr(1), text.substr(1));
+}
+
+struct MangledFrame {
+    std::string_view mangled;
+    std::string_view object;
+};
+
+// Whether the frame lines of the one entry in `supp` match `stack` as Valgrind
+// would, frame by frame from the top.
+bool valgrind_matches(const std::string& supp, const std::vector<MangledFrame>& stack) {
+    std::istringstream in(supp);
+    std::size_t        pos = 0;
+    for (std::string line; std::getline(in, line);) {
+        const std::string_view pattern = canonicalization::trim_view(line);
+        const bool fun = pattern.starts_with("fun:");
+        if (!fun && !pattern.starts_with("obj:")) continue;
+        if (pos == stack.size()) return false;
+        const MangledFrame& f = stack[pos++];
+        if (!valgrind_glob(pattern.substr(4), fun ? f.mangled : f.object)) return false;
+    }
+    return pos > 0;
+}
+
+} // namespace
+
+bool test_kinds() {
+    std::cout << "\n=== Testing suppression kinds ===" << std::endl;
+
+    const auto mc = [](BlockKind k, std::string_view h) { return suppression_kind(ValgrindTool::Memcheck, k, h); };
+    TEST_ASSERT(mc(BlockKind::InvalidWrite, "Invalid write of size 8") == "Memcheck:Addr8", "Access size");
+    TEST_ASSERT(!mc(BlockKind::InvalidRead, "Invalid read of size 3"), "No kind for odd sizes");
+    TEST_ASSERT(mc(BlockKind::Uninitialised, "Conditional jump or move depends on uninitialised value(s)") ==
+                "Memcheck:Cond" && mc(BlockKind::Uninitialised, "Use of uninitialised value of size 8") ==
+                "Memcheck:Value8", "Uninitialised values");
+    TEST_ASSERT(mc(BlockKind::SyscallParam, "Syscall param ioctl(generic) contains uninitialised byte(s)") ==
+                "Memcheck:Param\nioctl(generic)", "Syscall parameter");
+    TEST_ASSERT(mc(BlockKind::PossiblyLost, "8 bytes in 1 blocks are possibly lost") ==
+                "Memcheck:Leak\nmatch-leak-kinds: possible", "Leak kind");
+    TEST_ASSERT(mc(BlockKind::Other, "Invalid free() / delete / delete[] / realloc()") == "Memcheck:Free" &&
+                !mc(BlockKind::Fatal, "Process terminating with default action of signal 11"), "Other kinds");
+    TEST_ASSERT(suppression_kind(ValgrindTool::Helgrind, BlockKind::DataRace, "Possible data race") == "Helgrind:Race" &&
+                suppression_kind(ValgrindTool::Helgrind, BlockKind::ThreadApi,
+                                 "Thread #1 unlocked a not-locked lock at 0x1") == "Helgrind:UnlockUnlocked" &&
+                suppression_kind(ValgrindTool::Drd, BlockKind::DataRace, "Conflicting load") == "drd:ConflictingAccess",
+                "Thread tools");
+
+    TEST_PASS("Suppression kind tests completed");
+    return true;
+}
+
+bool test_wildcards() {
+    std::cout << "\n=== Testing wildcard patterns ===" << std::endl;
+
+    TEST_ASSERT(wildcard_pattern("main", "main") == "main", "Nothing erased");
+    TEST_ASSERT(wildcard_pattern("Map<int, Foo>::at(int)", "Map<>::at(int)") == "Map<*>::at(int)", "Template arguments");
+    TEST_ASSERT(wildcard_pattern("table[16]", "table[]") == "table[*]", "Array bound");
+    TEST_ASSERT(wildcard_pattern("{lambda(int)#2}", "{lambda}") == "{lambda*}", "Rewritten by a rule");
+    TEST_ASSERT(wildcard_pattern("f  (x)", "f (x)") == "f *(x)", "Collapsed whitespace");
+
+    TEST_PASS("Wildcard pattern tests completed");
+    return true;
+}
+
+bool test_generated_file() {
+    std::cout << "\n=== Testing generated suppressions ===" << std::endl;
+
+    Options opt;
+    opt.depth = 0;
+    const std::string supp = generate(opt);
+    TEST_ASSERT(count(supp, "{\n") == 3 && count(supp, "\n}\n") == 3, "Merged reads, no entry for the signal");
+    TEST_ASSERT(supp.find("   Memcheck:Addr4\n   fun:*\n   fun:main\n}\n") != std::string::npos,
+                "Own stack only, demangled frame wildcarded");
+    TEST_ASSERT(supp.find("   Memcheck:Leak\n   match-leak-kinds: definite\n   fun:malloc\n"
+                          "   obj:/usr/lib/libfoo.so\n}\n") != std::string::npos, "Leak with an object frame");
+    TEST_ASSERT(supp.find("   Memcheck:Param\n   write(buf)\n   fun:write\n}\n") != std::string::npos, "Syscall param");
+    TEST_ASSERT(supp.starts_with("{\n   vglog-filter/invalid-read/"), "Named after kind and fingerprint");
+
+    opt.depth = 1;
+    const std::string shallow = generate(opt);
+    TEST_ASSERT(shallow.find("fun:malloc\n}\n") != std::string::npos &&
+                shallow.find("fun:main") == std::string::npos, "First --depth frames");
+    TEST_ASSERT(shallow.find("Memcheck:Addr4") == std::string::npos, "No entry of fun:* frames alone");
+
+    TEST_PASS("Generated suppression tests completed");
+    return true;
+}
+
+bool test_valgrind_semantics() {
+    std::cout << "\n=== Testing generated fun: lines against Valgrind's matching ===" << std::endl;
+
+    // The same error, logged with valgrind --demangle=no and with demangling.
+    const std::vector<MangledFrame> stack{{"_ZNSt6vectorIiSaIiEE9push_backERKi", "/usr/lib/libapp.so"},
+                                          {"main", "/usr/bin/app"}};
+    const std::vector<std::string> mangled_log{
+        "==4242== Invalid write of size 8",
+        "==4242==    at 0x401234: _ZNSt6vectorIiSaIiEE9push_backERKi (stl_vector.h:1187)",
+        "==4242==    by 0x401300: main (app.cpp:20)",
+    };
+    const std::vector<std::string> demangled_log{
+        "==4242== Invalid write of size 8",
+        "==4242==    at 0x401234: std::vector<int, std::allocator<int> >::push_back(int const&) (in /usr/lib/libapp.so)",
+        "==4242==    by 0x401300: main (app.cpp:20)",
+    };
+
+    Options opt;
+    opt.depth = 0;
+    const std::string exact = generate(opt, mangled_log);
+    TEST_ASSERT(exact.find("   Memcheck:Addr8\n   fun:_ZNSt6vectorIiSaIiEE9push_backERKi\n   fun:main\n}\n") !=
+                std::string::npos, "Mangled name kept as it is");
+    TEST_ASSERT(valgrind_matches(exact, stack), "Entry from a --demangle=no log matches in Valgrind");
+
+    const std::string fallback = generate(opt, demangled_log);
+    TEST_ASSERT(fallback.find("   Memcheck:Addr8\n   obj:/usr/lib/libapp.so\n   fun:main\n}\n") != std::string::npos,
+                "Demangled frame falls back to its object");
+    TEST_ASSERT(valgrind_matches(fallback, stack), "Entry from a demangled log matches in Valgrind");
+
+    // What a demangled fun: line would have been: Valgrind never matches it.
+    TEST_ASSERT(!valgrind_matches("fun:std::vector<*>::push_back(int const&)\nfun:main\n", stack),
+                "Demangled fun: pattern misses the mangled name");
+
+    TEST_PASS("Valgrind matching tests completed");
+    return true;
+}
+
+bool test_matcher() {
+    std::cout << "\n=== Testing suppression matching ===" << std::endl;
+
+    SuppressionSet set;
+    set.parse(R"(# hand-written
+{
+   map-reads
+   Memcheck:Addr4
+   fun:Map<*>::at(int)
+   ...
+   fun:main
+}
+{
+   libfoo-leaks
+   Memcheck:Leak
+   match-leak-kinds: definite,indirect
+   fun:malloc
+   obj:/usr/lib/libfoo.so
+}
+{
+   write-buf
+   Memcheck:Param
+   write(buf)
+   src:write.c:26
+}
+{
+   shared-prefix
+   Memcheck,Helgrind:Addr4
+   fun:Map<int, Foo>::at(int)
+   fun:helper
+}
+)", "test.supp");
+    TEST_ASSERT(set.size() == 4, "Four entries");
+
+    const auto frame = [](std::string_view line) { return *parse_frame(line); };
+    const std::vector<FrameText> read{frame("at 0x1: Map<int, Foo>::at(int) (map.h:10)"), frame("by 0x2: lookup (a.cpp:5)"),
+                                      frame("by 0x3: run (a.cpp:9)"), frame("by 0x4: main (a.cpp:20)")};
+    const auto mc = [&](BlockKind k, std::string_view h, std::span<const FrameText> stack) {
+        return set.matches(ValgrindTool::Memcheck, k, h, stack);
+    };
+    TEST_ASSERT(mc(BlockKind::InvalidRead, "Invalid read of size 4", read), "Glob and '...' across frames");
+    TEST_ASSERT(mc(BlockKind::InvalidRead, "Invalid read of size 4", std::span{read}.first(1)) == false,
+                "Stack shorter than the entry");
+    TEST_ASSERT(!mc(BlockKind::InvalidRead, "Invalid read of size 8", read), "Other access size");
+    TEST_ASSERT(mc(BlockKind::InvalidWrite, "Invalid write of size 4",
+                   std::vector{frame("at 0x1: Map<int, Foo>::at(int) (map.h:10)"), frame("by 0x5: helper (h.cpp:1)")}),
+                "Literal entry sharing a kind");
+    TEST_ASSERT(!set.matches(ValgrindTool::Helgrind, BlockKind::DataRace, "Possible data race", read),
+                "Kinds are per tool");
+
+    const std::vector<FrameText> leak{frame("at 0x1: malloc (in /usr/lib/valgrind/vgpreload_memcheck-amd64-linux.so)"),
+                                      frame("by 0x2: ??? (in /usr/lib/libfoo.so)"), frame("by 0x3: main (a.cpp:3)")};
+    TEST_ASSERT(mc(BlockKind::IndirectlyLost, "8 bytes in 1 blocks are indirectly lost", leak), "Listed leak kind");
+    TEST_ASSERT(!mc(BlockKind::PossiblyLost, "8 bytes in 1 blocks are possibly lost", leak), "Unlisted leak kind");
+
+    const std::vector<FrameText> write{frame("at 0x1: write (write.c:26)")};
+    TEST_ASSERT(mc(BlockKind::SyscallParam, "Syscall param write(buf) points to uninitialised byte(s)", write) &&
+                !mc(BlockKind::SyscallParam, "Syscall param read(buf) points to uninitialised byte(s)", write),
+                "Syscall argument and source location");
+
+    const auto rejects = [](std::string_view text) {
+        try {
+            SuppressionSet bad;
+            bad.parse(text, "bad.supp");
+        } catch (const std::runtime_error&) {
+            return true;
+        }
+        return false;
+    };
+    TEST_ASSERT(rejects("{\n name\n Memcheck:Addr4\n fun:main\n") && rejects("{\n name\n Memcheck:Addr4\n}\n") &&
+                rejects("{\n name\n Memcheck:Addr4\n main\n}\n") && rejects("fun:main\n"), "Malformed entries");
+
+    TEST_PASS("Suppression matching tests completed");
+    return true;
+}
+
+bool test_glob_scaling() {
+    std::cout << "\n=== Testing large globbed suppression files ===" << std::endl;
+
+    constexpr int ENTRIES = 20000;
+    std::string text;
+    for (int i = 0; i < ENTRIES; ++i) {
+        const std::string n = std::to_string(i);
+        text.append("{\n   e").append(n).append("\n   Memcheck:Addr4\n   fun:ns").append(n).append("::*\n   ...\n")
+            .append("   fun:*helper").append(n).append("*\n}\n");
+    }
+    // Each "..." may skip any number of frames: tried naively this is exponential in the stack depth.
+    text.append("{\n   ellipses\n   Memcheck:Addr8\n   fun:dee*\n");
+    for (int i = 0; i < 5; ++i) text.append("   ...\n   fun:f?\n");
+    text.append("   ...\n   fun:never*\n}\n");
+    text.append("{\n   located\n   Memcheck:Addr8\n   src:wri*.c:2?\n}\n");
+
+    SuppressionSet set;
+    set.parse(text, "scaling.supp");
+    TEST_ASSERT(set.size() == ENTRIES + 2, "Every entry loaded");
+
+    const auto frame = [](std::string_view line) { return *parse_frame(line); };
+    const std::vector<FrameText> hit{frame("at 0x1: ns19999::get() (n.cpp:1)"), frame("by 0x2: run (a.cpp:5)"),
+                                     frame("by 0x3: loop (a.cpp:9)"), frame("by 0x4: my_helper19999_x (h.cpp:2)")};
+    std::size_t before = set.glob_checks();
+    TEST_ASSERT(set.matches(ValgrindTool::Memcheck, BlockKind::InvalidRead, "Invalid read of size 4", hit),
+                "Globbed entry deep in the file");
+    TEST_ASSERT(set.glob_checks() - before <= 8, "Only globs with the frame's prefix are tried");
+
+    const std::vector<FrameText> miss{frame("at 0x1: ns7::get() (n.cpp:1)"), frame("by 0x2: main (a.cpp:5)")};
+    before = set.glob_checks();
+    TEST_ASSERT(!set.matches(ValgrindTool::Memcheck, BlockKind::InvalidRead, "Invalid read of size 4", miss),
+                "No helper frame");
+    TEST_ASSERT(set.glob_checks() - before <= 4, "... found without trying the other entries");
+
+    std::vector<FrameText> deep{frame("at 0x1: deep (d.cpp:1)")};
+    for (int i = 0; i < 200; ++i) deep.push_back(frame("by 0x2: f1 (f.cpp:1)"));
+    before = set.glob_checks();
+    TEST_ASSERT(!set.matches(ValgrindTool::Memcheck, BlockKind::InvalidWrite, "Invalid write of size 8", deep),
+                "Ellipses around a frame that is missing");
+    TEST_ASSERT(set.glob_checks() - before <= 6 * deep.size() + 1, "Each '...' tries a frame once");
+
+    TEST_ASSERT(set.matches(ValgrindTool::Memcheck, BlockKind::InvalidWrite, "Invalid write of size 8",
+                            std::vector{frame("at 0x1: write (write.c:26)")}), "Globbed FILE:LINE");
+
+    TEST_PASS("Glob scaling tests completed");
+    return true;
+}
+
+bool test_applied() {
+    std::cout << "\n=== Testing --suppressions ===" << std::endl;
+
+    // Everything the generated file covers is dropped, duplicates included.
+    Options opt;
+    opt.depth = 0;
+    opt.trim  = false;
+    const std::string supp = generate(opt);
+    {
+        std::ofstream out(SUPP_FILE);
+        out << supp;
+    }
+    opt.suppress_files.push_back(SUPP_FILE);
+    LogProcessor p(opt);
+    const std::string output = capture_stdout([&] { p.process_lines(LOG); });
+    std::remove(SUPP_FILE.c_str());
+
+    TEST_ASSERT(p.blocks().size() == 1 && p.blocks().kind(0) == BlockKind::Fatal, "Only the signal block is left");
+    TEST_ASSERT(output.starts_with("Process terminating"), "Suppressed blocks are not output");
+
+    TEST_PASS("--suppressions tests completed");
+    return true;
+}
+
+int main() {
+    std::cout << "Running suppression tests..." << std::endl;
+
+    bool all_passed = true;
+
+    all_passed &= test_kinds();
+    all_passed &= test_wildcards();
+    all_passed &= test_generated_file();
+    all_passed &= test_valgrind_semantics();
+    all_passed &= test_matcher();
+    all_passed &= test_glob_scaling();
+    all_passed &= test_applied();
+
+    if (all_passed) {
+        std::cout << "\n✅ All suppression tests passed!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "\n❌ Some suppression tests failed!" << std::endl;
+        return 1;
+    }
+}
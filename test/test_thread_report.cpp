@@ -0,0 +1,250 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "test_helpers.h"
+#include <checkpoint.h>
+#include <log_processor.h>
+#include <thread_report.h>
+
+namespace {
+
+// Two reports of the same race, seen from either thread, one race elsewhere,
+// and a lock order violation.
+const std::string HELGRIND =
+    "==4242== Helgrind, a thread error detector\n"
+    "==4242== Command: ./race\n"
+    "==4242== \n"
+    "==4242== ---Thread-Announcement------------------------------------------\n"
+    "==4242== \n"
+    "==4242== Thread #1 is the program's root thread\n"
+    "==4242== \n"
+    "==4242== ---Thread-Announcement------------------------------------------\n"
+    "==4242== \n"
+    "==4242== Thread #2 was created\n"
+    "==4242==    at 0x515543E: clone (clone.S:74)\n"
+    "==4242==    by 0x4006C4: main (race.c:20)\n"
+    "==4242== \n"
+    "==4242== ----------------------------------------------------------------\n"
+    "==4242== \n"
+    "==4242== Possible data race during write of size 4 at 0x601038 by thread #1\n"
+    "==4242== Locks held: none\n"
+    "==4242==    at 0x400606: main (race.c:13)\n"
+    "==4242== \n"
+    "==4242== This conflicts with a previous read of size 4 by thread #2\n"
+    "==4242== Locks held: none\n"
+    "==4242==    at 0x4005DC: child_fn (race.c:6)\n"
+    "==4242==    by 0x4C2F735: mythread_wrapper (hg_intercepts.c:389)\n"
+    "==4242== \n"
+    "==4242== Location 0x601038 is 0 bytes inside global var \"var\"\n"
+    "==4242== declared at race.c:3\n"
+    "==4242== \n"
+    "==4242== ----------------------------------------------------------------\n"
+    "==4242== \n"
+    "==4242== Possible data race during read of size 4 at 0x601038 by thread #3\n"
+    "==4242== Locks held: 1, at address 0x601040\n"
+    "==4242==    at 0x4005DC: child_fn (race.c:6)\n"
+    "==4242==    by 0x4C2F735: mythread_wrapper (hg_intercepts.c:389)\n"
+    "==4242== \n"
+    "==4242== This conflicts with a previous write of size 4 by thread #1\n"
+    "==4242== Locks held: none\n"
+    "==4242==    at 0x400606: main (race.c:13)\n"
+    "==4242== \n"
+    "==4242== ----------------------------------------------------------------\n"
+    "==4242== \n"
+    "==4242== Possible data race during read of size 4 at 0x601038 by thread #2\n"
+    "==4242== Locks held: none\n"
+    "==4242==    at 0x400777: other_fn (race.c:40)\n"
+    "==4242== \n"
+    "==4242== This conflicts with a previous write of size 4 by thread #1\n"
+    "==4242== Locks held: none\n"
+    "==4242==    at 0x400606: main (race.c:13)\n"
+    "==4242== \n"
+    "==4242== ----------------------------------------------------------------\n"
+    "==4242== \n"
+    "==4242== Thread #3: lock order \"0x601040 before 0x601080\" violated\n"
+    "==4242== \n"
+    "==4242== Observed (incorrect) order is: acquisition of lock at 0x601080\n"
+    "==4242==    at 0x4C3010C: pthread_mutex_lock (hg_intercepts.c:510)\n"
+    "==4242==    by 0x400700: worker (race.c:30)\n"
+    "==4242== \n"
+    "==4242== ERROR SUMMARY: 4 errors from 4 contexts (suppressed: 0 from 0)\n";
+
+const std::string DRD =
+    "==4242== drd, a thread error detector\n"
+    "==4242== Thread 2:\n"
+    "==4242== Conflicting load by thread 2 at 0x00601044 size 4\n"
+    "==4242==    at 0x400654: thread_func (drd.c:12)\n"
+    "==4242==    by 0x4C2B0A4: vgDrd_thread_wrapper (drd_pthread_intercepts.c:367)\n"
+    "==4242== Allocation context: BSS section of /tmp/a.out\n"
+    "==4242== Other segment start (thread 1)\n"
+    "==4242==    at 0x400700: main (drd.c:20)\n"
+    "==4242== \n"
+    "==4242== Thread 3:\n"
+    "==4242== Conflicting load by thread 3 at 0x00601044 size 4\n"
+    "==4242==    at 0x400654: thread_func (drd.c:12)\n"
+    "==4242==    by 0x4C2B0A4: vgDrd_thread_wrapper (drd_pthread_intercepts.c:367)\n"
+    "==4242== Allocation context: BSS section of /tmp/a.out\n"
+    "==4242== \n"
+    "==4242== Mutex not locked by calling thread: mutex 0x601060, recursion count 0, owner 0.\n"
+    "==4242==    at 0x4C2F6D9: pthread_mutex_unlock (drd_pthread_intercepts.c:703)\n"
+    "==4242==    by 0x400720: main (drd.c:25)\n";
+
+std::string run(LogProcessor& p, const std::string& log, const Checkpoint* cp = nullptr) {
+    std::istringstream in(log);
+    if (cp != nullptr) {
+        p.restore(*cp);
+        in.seekg(static_cast<std::streamoff>(cp->offset));
+    }
+    return capture_stdout([&] { p.process_stream(in); });
+}
+
+std::size_t count(const std::string& haystack, std::string_view needle) {
+    std::size_t n = 0;
+    for (auto pos = haystack.find(needle); pos != std::string::npos; pos = haystack.find(needle, pos + 1)) ++n;
+    return n;
+}
+
+} // namespace
+
+bool test_line_classification() {
+    std::cout << "\n=== Testing thread tool line classification ===" << std::endl;
+
+    TEST_ASSERT(detect_tool("Helgrind, a thread error detector") == ValgrindTool::Helgrind &&
+                detect_tool("DRD, a thread error detector") == ValgrindTool::Drd &&
+                detect_tool("Memcheck, a memory error detector") == ValgrindTool::Memcheck &&
+                !detect_tool("Command: ./a.out"), "Tool banner");
+
+    const auto hg = [](std::string_view l) { return classify_thread_line(ValgrindTool::Helgrind, l); };
+    TEST_ASSERT(hg("Possible data race during read of size 1 at 0x1 by thread #4").kind == BlockKind::DataRace,
+                "Race start");
+    TEST_ASSERT(hg("Thread #12: lock order \"0x1 before 0x2\" violated").kind == BlockKind::LockOrder, "Lock order");
+    TEST_ASSERT(hg("Thread #1 unlocked a not-locked lock at 0x1").kind == BlockKind::ThreadApi &&
+                hg("Thread #2: pthread_cond_wait called with un-held mutex").kind == BlockKind::ThreadApi,
+                "Thread API misuse");
+    TEST_ASSERT(hg("Thread #2 was created").role == LineRole::Start && hg("Thread #2 was created").kind == BlockKind::Other,
+                "Announcements are blocks of their own");
+    TEST_ASSERT(hg("Thread #1's call stack:").role == LineRole::Body && hg("Locks held: none").role == LineRole::Body &&
+                hg("This conflicts with a previous read of size 4 by thread #2").role == LineRole::Body,
+                "Report body");
+    TEST_ASSERT(hg("---Thread-Announcement------").role == LineRole::Separator, "Separator");
+
+    const auto drd = [](std::string_view l) { return classify_thread_line(ValgrindTool::Drd, l); };
+    TEST_ASSERT(drd("Conflicting store by thread 1 at 0x1 size 8").kind == BlockKind::DataRace, "DRD race");
+    TEST_ASSERT(drd("Thread 2:").role == LineRole::Separator && drd("Other segment start (thread 1)").role == LineRole::Body,
+                "DRD thread context line");
+    TEST_ASSERT(drd("Destroying locked mutex: mutex 0x1, recursion count 1, owner 1.").kind == BlockKind::ThreadApi,
+                "DRD API error");
+
+    TEST_PASS("Line classification tests completed");
+    return true;
+}
+
+bool test_race_access_and_ids() {
+    std::cout << "\n=== Testing race sides and thread numbers ===" << std::endl;
+
+    std::string a;
+    TEST_ASSERT(race_access("Possible data race during write of size 4 at 0x601038 by thread #1", a) &&
+                a == "write of size 4", "Reported access");
+    std::string b;
+    TEST_ASSERT(race_access("This conflicts with a previous write of size 4 by thread #9", b) && b == a,
+                "Conflicting access words the same");
+    std::string d;
+    TEST_ASSERT(race_access("Conflicting load by thread 2 at 0x00601044 size 4", d) && d == "load size 4", "DRD access");
+    std::string none;
+    TEST_ASSERT(!race_access("Locks held: none", none) && none.empty(), "Other lines");
+
+    std::string s = "Thread #12: lock order violated by thread #3; Thread 7's stack; start_thread (x.c:1)";
+    s.resize(neutralize_thread_ids(s));
+    TEST_ASSERT(s == "Thread #N: lock order violated by thread #N; Thread N's stack; start_thread (x.c:1)",
+                "Thread numbers neutralized");
+
+    TEST_PASS("Race side tests completed");
+    return true;
+}
+
+bool test_helgrind_dedupe() {
+    std::cout << "\n=== Testing Helgrind race pairs ===" << std::endl;
+
+    Options opt;
+    opt.trim        = false;
+    opt.stream_mode = true;
+    opt.depth       = 3;
+    LogProcessor p(opt);
+    const std::string out = run(p, HELGRIND);
+
+    TEST_ASSERT(count(out, "Possible data race") == 2, "Race seen from either side is one block");
+    TEST_ASSERT(out.find("----") == std::string::npos, "Separators are dropped");
+    TEST_ASSERT(out.find("Thread #2 was created") != std::string::npos &&
+                out.find("Thread #2 was created\nclone") != std::string::npos, "Announcement stands alone");
+
+    const BlockStore& store = p.blocks();
+    std::size_t races = 0;
+    for (std::size_t i = 0; i < store.size(); ++i) {
+        if (store.kind(i) == BlockKind::DataRace) {
+            ++races;
+            if (races == 1) TEST_ASSERT(store.occurrences(i) == 2, "Mirrored report counts as a repeat");
+        }
+        if (store.kind(i) == BlockKind::LockOrder) {
+            TEST_ASSERT(store.header(i).starts_with("Thread #3: lock order"), "Lock order block");
+        }
+    }
+    TEST_ASSERT(races == 2, "Distinct race pairs stay apart");
+
+    // Resuming right after the banner keeps the tool
+    opt.state_file = "test_thread_report_state.bin"; // only enables resumable stops
+    LogProcessor first(opt);
+    const std::size_t cut = HELGRIND.find("==4242== Command");
+    const std::string out1 = run(first, HELGRIND.substr(0, cut));
+    const Checkpoint cp = first.checkpoint();
+    LogProcessor second(opt);
+    TEST_ASSERT(out1 + run(second, HELGRIND, &cp) == out, "Resumed run segments as Helgrind");
+
+    TEST_PASS("Helgrind race pair tests completed");
+    return true;
+}
+
+bool test_drd_dedupe() {
+    std::cout << "\n=== Testing DRD reports ===" << std::endl;
+
+    Options opt;
+    opt.trim        = false;
+    opt.stream_mode = true;
+    opt.depth       = 2;
+    LogProcessor p(opt);
+    const std::string out = run(p, DRD);
+
+    TEST_ASSERT(count(out, "Conflicting load") == 1, "Same race on another thread is a repeat");
+    TEST_ASSERT(out.find("Thread 2:") == std::string::npos, "Thread context lines are dropped");
+    const BlockStore& store = p.blocks();
+    TEST_ASSERT(store.size() == 3 && store.kind(1) == BlockKind::DataRace && store.occurrences(1) == 2 &&
+                store.kind(2) == BlockKind::ThreadApi, "Preamble, race and mutex error records");
+
+    TEST_PASS("DRD report tests completed");
+    return true;
+}
+
+int main() {
+    std::cout << "Running thread report tests..." << std::endl;
+
+    bool all_passed = true;
+
+    all_passed &= test_line_classification();
+    all_passed &= test_race_access_and_ids();
+    all_passed &= test_helgrind_dedupe();
+    all_passed &= test_drd_dedupe();
+
+    if (all_passed) {
+        std::cout << "\n✅ All thread report tests passed!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "\n❌ Some thread report tests failed!" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,185 @@
+// Copyright © 2025 Eser KUBALI <lxldev.contact@gmail.com>
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// This file is part of vglog-filter and is licensed under
+// the GNU General Public License v3.0 or later.
+// See the LICENSE file in the project root for details.
+
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "test_helpers.h"
+#include <log_processor.h>
+#include <xml_reader.h>
+
+namespace {
+
+// Records callbacks as "<name", ">name" and "text" entries, merging adjacent text.
+class Recorder final : public XmlHandler {
+public:
+    void start_element(std::string_view name) override { events.emplace_back("<").append(name); }
+    void end_element(std::string_view name) override { events.emplace_back(">").append(name); }
+    void characters(std::string_view text) override {
+        if (text.find_first_not_of(" \n") == std::string_view::npos) return;
+        if (!events.empty() && events.back()[0] == '"') events.back().insert(events.back().size() - 1, text);
+        else events.emplace_back("\"").append(text).push_back('"');
+    }
+    std::vector<std::string> events;
+};
+
+std::vector<std::string> parse(const std::string& doc, std::size_t chunk) {
+    std::istringstream in(doc);
+    Recorder r;
+    parse_xml(in, r, chunk);
+    return r.events;
+}
+
+const std::string DOCUMENT = R"(<?xml version="1.0"?>
+<!DOCTYPE valgrindoutput>
+<valgrindoutput>
+<protocolversion>4</protocolversion>
+<pid>4242</pid>
+<!-- an <error> in a comment is not an error -->
+<error>
+  <unique>0x0</unique>
+  <tid>1</tid>
+  <kind>InvalidRead</kind>
+  <what>Invalid read of size 4</what>
+  <stack>
+    <frame><ip>0x401234</ip><obj>/tmp/a.out</obj><fn>main</fn><dir>/tmp</dir><file>a.cpp</file><line>10</line></frame>
+    <frame><ip>0x4C2AB80</ip><obj>/usr/lib/libc.so.6</obj></frame>
+  </stack>
+</error>
+<error>
+  <unique>0x1</unique>
+  <tid>1</tid>
+  <kind>Leak_DefinitelyLost</kind>
+  <xwhat>
+    <text>1024 bytes in 3 blocks are definitely lost in loss record 1 of 1</text>
+    <leakedbytes>1024</leakedbytes>
+    <leakedblocks>3</leakedblocks>
+  </xwhat>
+  <stack>
+    <frame><ip>0x4C2AB80</ip><obj>/usr/lib/valgrind/vgpreload_memcheck-amd64-linux.so</obj><fn>malloc</fn></frame>
+    <frame><ip>0x401300</ip><fn>std::vector&lt;int&gt;::push_back(int const&amp;)</fn><file>b.cpp</file><line>20</line></frame>
+  </stack>
+  <suppression><sname>insert_a_suppression_name_here</sname><skind>Memcheck:Leak</skind></suppression>
+</error>
+<error>
+  <unique>0x2</unique>
+  <tid>1</tid>
+  <kind>InvalidRead</kind>
+  <what>Invalid read of size 4</what>
+  <stack>
+    <frame><ip>0x401999</ip><obj>/tmp/a.out</obj><fn>main</fn><file>a.cpp</file><line>10</line></frame>
+  </stack>
+</error>
+</valgrindoutput>
+)";
+
+// The text log Valgrind writes for the same run.
+const std::string TEXT_LOG =
+    "==4242== Invalid read of size 4\n"
+    "==4242==    at 0x401234: main (a.cpp:10)\n"
+    "==4242==    by 0x4C2AB80: ??? (in /usr/lib/libc.so.6)\n"
+    "==4242== \n"
+    "==4242== 1024 bytes in 3 blocks are definitely lost in loss record 1 of 1\n"
+    "==4242==    at 0x4C2AB80: malloc (in /usr/lib/valgrind/vgpreload_memcheck-amd64-linux.so)\n"
+    "==4242==    by 0x401300: std::vector<int>::push_back(int const&) (b.cpp:20)\n"
+    "==4242== \n"
+    "==4242== Invalid read of size 4\n"
+    "==4242==    at 0x401999: main (a.cpp:10)\n";
+
+std::string run(LogProcessor& p, const std::string& input, bool xml) {
+    std::istringstream in(input);
+    return capture_stdout([&] {
+        if (xml) p.process_xml(in);
+        else     p.process_stream(in);
+    });
+}
+
+std::string run(const std::string& input, bool xml, const Options& opt) {
+    LogProcessor p(opt);
+    return run(p, input, xml);
+}
+
+} // namespace
+
+bool test_sax_events() {
+    std::cout << "\n=== Testing SAX events ===" << std::endl;
+
+    const std::string doc = "<?xml version=\"1.0\"?><a x=\"1\"><b/>t &lt;&amp;&gt; &#65;&#x42;<![CDATA[<raw&>]]><!-- <c> --></a>";
+    const std::vector<std::string> expected{"<a", "<b", ">b", "\"t <&> AB<raw&>\"", ">a"};
+    TEST_ASSERT(parse(doc, 4096) == expected, "Elements, entities, CDATA and comments");
+    for (const std::size_t chunk : {1u, 2u, 3u, 7u}) {
+        TEST_ASSERT(parse(doc, chunk) == expected, "Same events when tokens cross chunk boundaries");
+    }
+
+    bool threw = false;
+    try { (void)parse("<a>&bogus;</a>", 4096); } catch (const std::runtime_error&) { threw = true; }
+    TEST_ASSERT(threw, "Unknown entity is rejected");
+    threw = false;
+    try { (void)parse("<a><b", 4096); } catch (const std::runtime_error&) { threw = true; }
+    TEST_ASSERT(threw, "Unterminated tag is rejected");
+
+    TEST_PASS("SAX event tests completed");
+    return true;
+}
+
+bool test_same_output_as_text() {
+    std::cout << "\n=== Testing XML and text give the same blocks ===" << std::endl;
+
+    Options opt;
+    opt.trim        = false;
+    opt.stream_mode = true;
+    const std::string text = run(TEXT_LOG, false, opt);
+    TEST_ASSERT(!text.empty(), "Text log produces output");
+    LogProcessor p(opt);
+    TEST_ASSERT(run(p, DOCUMENT, true) == text, "XML output matches the text log");
+
+    const BlockStore& store = p.blocks();
+    TEST_ASSERT(store.size() == 2, "Duplicate error is folded");
+    TEST_ASSERT(store.kind(0) == BlockKind::InvalidRead && store.occurrences(0) == 2, "Kind from <kind>");
+    TEST_ASSERT(store.kind(1) == BlockKind::DefinitelyLost && store.bytes(1) == 1024 && store.heap_blocks(1) == 3,
+                "Leak figures from <xwhat>");
+
+    opt.scrub_raw = false;
+    TEST_ASSERT(run(DOCUMENT, true, opt) == run(TEXT_LOG, false, opt), "Raw output matches too");
+
+    TEST_PASS("XML/text equivalence tests completed");
+    return true;
+}
+
+bool test_early_stop() {
+    std::cout << "\n=== Testing early stop on XML ===" << std::endl;
+
+    Options opt;
+    opt.trim       = false;
+    opt.max_unique = 1;
+    const std::string out = run(DOCUMENT, true, opt);
+    TEST_ASSERT(out.find("Invalid read") != std::string::npos, "First block written");
+    TEST_ASSERT(out.find("definitely lost") == std::string::npos, "Parse stops after the limit");
+
+    TEST_PASS("Early stop tests completed");
+    return true;
+}
+
+int main() {
+    std::cout << "Running XML reader tests..." << std::endl;
+
+    bool all_passed = true;
+
+    all_passed &= test_sax_events();
+    all_passed &= test_same_output_as_text();
+    all_passed &= test_early_stop();
+
+    if (all_passed) {
+        std::cout << "\n✅ All XML reader tests passed!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "\n❌ Some XML reader tests failed!" << std::endl;
+        return 1;
+    }
+}